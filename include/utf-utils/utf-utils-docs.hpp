@@ -4,3 +4,27 @@
 /// 
 /// This library provides with various utility functions that can help C++ developers with handling of Unicode (UTF-*) strings.
 ///
+/// @section build_sec Build modes
+///
+/// - @b Compiled (default CMake target @c utf-utils::utf-utils): the kernels are built once into a static or shared library
+///   (@c BUILD_SHARED_LIBS), optionally with link-time optimization (@c UTFUTILS_ENABLE_LTO) and tuned for the build machine
+///   (@c UTFUTILS_NATIVE_ARCH). Consumers get @c UTFUTILS_COMPILED defined and their conversions into @c std::basic_string
+///   call the kernels of @c utf::conversion::compiled, the other sinks and compile-time conversions use the templates.
+/// - @b Header-only (CMake target @c utf-utils::header-only, or @c UTFUTILS_HEADER_ONLY=ON to make it the default): define
+///   @c UTFUTILS_HEADER_ONLY and every function is inline, nothing has to be linked.
+/// - @b Single translation unit: define @c IMPLEMENT_UTFUTILS in exactly one translation unit before including the headers
+///   and it will contain everything the compiled library would.
+///
+/// After installation the library is found with @c find_package(utf-utils).
+///
+/// @section test_sec Tests
+///
+/// The tests in @c tests/ are built with the library when it's the top-level project (@c UTFUTILS_BUILD_TESTS) and run with
+/// @c ctest. Each of them is built once per instruction set the compiler can target, once with @c UTFUTILS_NO_SIMD for
+/// the scalar code and once linking the compiled library, and checks the results against plain reference loops.
+///
+/// @section tool_sec Command-line tool
+///
+/// @c utfconv converts between UTF-8, UTF-16 and UTF-32 in either byte order, from a file or standard input to a file or
+/// standard output, and is meant as a drop-in for @c iconv in batch jobs. Run <tt>utfconv --help</tt> for its options.
+///
@@ -0,0 +1,362 @@
+#if !defined(UTFUTILS_BATCH_H)
+#   define UTFUTILS_BATCH_H
+
+#include "utf_utils.hpp"
+
+/**
+ * @file utf_batch.hpp
+ * @brief Conversion of many short strings into one contiguous arena.
+ */
+
+#include <iterator>
+#include <limits>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Many strings stored back to back in one buffer, Arrow-style.
+     * @tparam CharT code unit type.
+     * @tparam OffsetT type of offsets, e.g. @c int32_t for Arrow @c utf8 arrays or @c int64_t for @c large_utf8.
+     * @details
+     * String @c i spans <tt>[offsets[i], offsets[i + 1])</tt> of @c data, so a non-empty arena has one offset more than strings.
+     */
+    template <typename CharT, typename OffsetT = size_t>
+    struct string_arena {
+        std::basic_string<CharT> data;    /**< Code units of all strings. */
+        std::vector<OffsetT>     offsets; /**< Offsets of strings in @c data followed by the size of @c data. */
+
+        /**
+         * @brief Returns number of strings.
+         */
+        size_t size() const {
+            return offsets.empty() ? 0 : offsets.size() - 1;
+        }
+        bool empty() const {
+            return size() == 0;
+        }
+        /**
+         * @brief Returns view of string number @p index.
+         */
+        std::basic_string_view<CharT> operator[](const size_t index) const {
+            const size_t start = static_cast<size_t>(offsets[index]);
+            const size_t end   = static_cast<size_t>(offsets[index + 1]);
+            return std::basic_string_view<CharT>(data.data() + start, end - start);
+        }
+        void clear() {
+            data.clear();
+            offsets.clear();
+        }
+    };
+
+    namespace conversion {
+        /**
+         * @addtogroup batch_funcs Batch Conversion Functions
+         * Functions used to convert many strings at once.
+         *
+         * All strings are validated and measured in the first pass, which also fills the offsets. The second pass converts
+         * them straight into their place in the arena's buffer, so there is one allocation per batch instead of one per string.
+         * On failure the arena is cleared and the index of the offending string can be retrieved.
+         * @{
+         */
+
+        /**
+         * @brief This function converts many UTF-8 strings into one UTF-16 arena.
+         *
+         * @param[in] utf8_svs range (e.g. @c std::vector or @c std::span) of values convertible to @c std::basic_string_view<char8_t>.
+         * @param[out] utf16_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf8_to_utf16 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Range, typename OffsetT>
+        status_e utf8_to_utf16_batch(const Range& utf8_svs, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+        /**
+         * @brief This function converts UTF-8 strings stored Arrow-style (one buffer plus offsets) into one UTF-16 arena.
+         *
+         * @param[in] utf8_data const reference to a string view over all strings stored back to back.
+         * @param[in] utf8_offsets @p count + 1 offsets into @p utf8_data, string @c i spans <tt>[offsets[i], offsets[i + 1])</tt>.
+         * @param[in] count number of strings.
+         * @param[out] utf16_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf8_to_utf16 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename InputOffsetT, typename OffsetT>
+        status_e utf8_to_utf16_batch(const std::basic_string_view<char8_t>& utf8_data, const InputOffsetT* utf8_offsets, size_t count, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+
+        /**
+         * @brief This function converts many UTF-8 strings into one UTF-32 arena.
+         *
+         * @param[in] utf8_svs range (e.g. @c std::vector or @c std::span) of values convertible to @c std::basic_string_view<char8_t>.
+         * @param[out] utf32_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf8_to_utf32 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Range, typename OffsetT>
+        status_e utf8_to_utf32_batch(const Range& utf8_svs, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+        /**
+         * @brief This function converts UTF-8 strings stored Arrow-style (one buffer plus offsets) into one UTF-32 arena.
+         *
+         * @param[in] utf8_data const reference to a string view over all strings stored back to back.
+         * @param[in] utf8_offsets @p count + 1 offsets into @p utf8_data, string @c i spans <tt>[offsets[i], offsets[i + 1])</tt>.
+         * @param[in] count number of strings.
+         * @param[out] utf32_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf8_to_utf32 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename InputOffsetT, typename OffsetT>
+        status_e utf8_to_utf32_batch(const std::basic_string_view<char8_t>& utf8_data, const InputOffsetT* utf8_offsets, size_t count, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+
+        /**
+         * @brief This function converts many UTF-16 strings into one UTF-8 arena.
+         *
+         * @param[in] utf16_svs range (e.g. @c std::vector or @c std::span) of values convertible to @c std::basic_string_view<char16_t>.
+         * @param[out] utf8_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf16_to_utf8 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Range, typename OffsetT>
+        status_e utf16_to_utf8_batch(const Range& utf16_svs, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+        /**
+         * @brief This function converts UTF-16 strings stored Arrow-style (one buffer plus offsets) into one UTF-8 arena.
+         *
+         * @param[in] utf16_data const reference to a string view over all strings stored back to back.
+         * @param[in] utf16_offsets @p count + 1 offsets into @p utf16_data, string @c i spans <tt>[offsets[i], offsets[i + 1])</tt>.
+         * @param[in] count number of strings.
+         * @param[out] utf8_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf16_to_utf8 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename InputOffsetT, typename OffsetT>
+        status_e utf16_to_utf8_batch(const std::basic_string_view<char16_t>& utf16_data, const InputOffsetT* utf16_offsets, size_t count, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+
+        /**
+         * @brief This function converts many UTF-16 strings into one UTF-32 arena.
+         *
+         * @param[in] utf16_svs range (e.g. @c std::vector or @c std::span) of values convertible to @c std::basic_string_view<char16_t>.
+         * @param[out] utf32_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf16_to_utf32 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Range, typename OffsetT>
+        status_e utf16_to_utf32_batch(const Range& utf16_svs, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+        /**
+         * @brief This function converts UTF-16 strings stored Arrow-style (one buffer plus offsets) into one UTF-32 arena.
+         *
+         * @param[in] utf16_data const reference to a string view over all strings stored back to back.
+         * @param[in] utf16_offsets @p count + 1 offsets into @p utf16_data, string @c i spans <tt>[offsets[i], offsets[i + 1])</tt>.
+         * @param[in] count number of strings.
+         * @param[out] utf32_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf16_to_utf32 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename InputOffsetT, typename OffsetT>
+        status_e utf16_to_utf32_batch(const std::basic_string_view<char16_t>& utf16_data, const InputOffsetT* utf16_offsets, size_t count, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+
+        /**
+         * @brief This function converts many UTF-32 strings into one UTF-8 arena.
+         *
+         * @param[in] utf32_svs range (e.g. @c std::vector or @c std::span) of values convertible to @c std::basic_string_view<char32_t>.
+         * @param[out] utf8_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf32_to_utf8 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Range, typename OffsetT>
+        status_e utf32_to_utf8_batch(const Range& utf32_svs, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+        /**
+         * @brief This function converts UTF-32 strings stored Arrow-style (one buffer plus offsets) into one UTF-8 arena.
+         *
+         * @param[in] utf32_data const reference to a string view over all strings stored back to back.
+         * @param[in] utf32_offsets @p count + 1 offsets into @p utf32_data, string @c i spans <tt>[offsets[i], offsets[i + 1])</tt>.
+         * @param[in] count number of strings.
+         * @param[out] utf8_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf32_to_utf8 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename InputOffsetT, typename OffsetT>
+        status_e utf32_to_utf8_batch(const std::basic_string_view<char32_t>& utf32_data, const InputOffsetT* utf32_offsets, size_t count, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+
+        /**
+         * @brief This function converts many UTF-32 strings into one UTF-16 arena.
+         *
+         * @param[in] utf32_svs range (e.g. @c std::vector or @c std::span) of values convertible to @c std::basic_string_view<char32_t>.
+         * @param[out] utf16_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf32_to_utf16 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Range, typename OffsetT>
+        status_e utf32_to_utf16_batch(const Range& utf32_svs, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+        /**
+         * @brief This function converts UTF-32 strings stored Arrow-style (one buffer plus offsets) into one UTF-16 arena.
+         *
+         * @param[in] utf32_data const reference to a string view over all strings stored back to back.
+         * @param[in] utf32_offsets @p count + 1 offsets into @p utf32_data, string @c i spans <tt>[offsets[i], offsets[i + 1])</tt>.
+         * @param[in] count number of strings.
+         * @param[out] utf16_arena arena which will hold converted strings.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf32_to_utf16 for details.
+         * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+         * @return status specified by #status_e enum.
+         */
+        template <typename InputOffsetT, typename OffsetT>
+        status_e utf32_to_utf16_batch(const std::basic_string_view<char32_t>& utf32_data, const InputOffsetT* utf32_offsets, size_t count, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard = false, size_t* failed_index = nullptr);
+
+        /**
+         * @}
+         */
+    } // namespace conversion
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Converts a batch of strings into an arena.
+     * @tparam InputCharT code unit type of the source encoding.
+     * @param for_each_string callable which takes a visitor and calls it with index and string view of every string in order.
+     * The visitor returns @c false to stop the iteration.
+     * @param count number of strings.
+     * @param[out] arena arena which will hold converted strings.
+     * @param[in] comply_with_standard should the conversion comply with Unicode standard.
+     * @param[out] failed_index if not @c nullptr, receives index of the string which failed to convert.
+     * @return status specified by #conversion::status_e enum.
+     */
+    template <typename InputCharT, typename OutputCharT, typename OffsetT, typename ForEachString>
+    conversion::status_e transcode_batch(ForEachString&& for_each_string, const size_t count, string_arena<OutputCharT, OffsetT>& arena, const bool comply_with_standard, size_t* failed_index) {
+        arena.offsets.resize(count + 1);
+        arena.offsets[0] = 0;
+
+        // first pass: validate and compute offsets
+        conversion::status_e status = conversion::status_e::success;
+        size_t               total  = 0;
+        for_each_string([&](const size_t index, const std::basic_string_view<InputCharT>& input) {
+            size_t output_size = 0;
+            status = transcoded_size<InputCharT, OutputCharT>(input, output_size, comply_with_standard);
+            if (status == conversion::status_e::success && total + output_size > static_cast<size_t>(std::numeric_limits<OffsetT>::max())) {
+                // the arena doesn't fit into offset type
+                status = conversion::status_e::undefined_error;
+            }
+            if (status != conversion::status_e::success) {
+                if (failed_index != nullptr) {
+                    *failed_index = index;
+                }
+                return false;
+            }
+            total += output_size;
+            arena.offsets[index + 1] = static_cast<OffsetT>(total);
+            return true;
+        });
+        if (status != conversion::status_e::success) {
+            arena.clear();
+            return status;
+        }
+
+        // second pass: convert every string into its place
+        resize_and_write(arena.data, total, [&for_each_string, &arena](OutputCharT* data) {
+            for_each_string([data, &arena](const size_t index, const std::basic_string_view<InputCharT>& input) {
+                transcode_validated<InputCharT, OutputCharT>(input, data + static_cast<size_t>(arena.offsets[index]));
+                return true;
+            });
+        });
+        return conversion::status_e::success;
+    }
+
+    /**
+     * @internal
+     * @brief Makes the string iteration of #transcode_batch for a range of values convertible to string views.
+     */
+    template <typename InputCharT, typename Range>
+    auto visit_range(const Range& svs) {
+        return [&svs](auto&& visitor) {
+            size_t index = 0;
+            for (const auto& sv : svs) {
+                if (!visitor(index++, std::basic_string_view<InputCharT>(sv))) {
+                    return;
+                }
+            }
+        };
+    }
+    /**
+     * @internal
+     * @brief Makes the string iteration of #transcode_batch for strings stored Arrow-style, string @c i spans
+     * <tt>[offsets[i], offsets[i + 1])</tt> of @p data.
+     */
+    template <typename InputCharT, typename InputOffsetT>
+    auto visit_offsets(const std::basic_string_view<InputCharT>& data, const InputOffsetT* offsets, const size_t count) {
+        return [data, offsets, count](auto&& visitor) {
+            for (size_t index = 0; index < count; index++) {
+                const size_t start = static_cast<size_t>(offsets[index]);
+                const size_t end   = static_cast<size_t>(offsets[index + 1]);
+                if (!visitor(index, data.substr(start, end - start))) {
+                    return;
+                }
+            }
+        };
+    }
+} // namespace utf
+
+template <typename Range, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf8_to_utf16_batch(const Range& utf8_svs, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char8_t>(visit_range<char8_t>(utf8_svs), static_cast<size_t>(std::size(utf8_svs)), utf16_arena, comply_with_standard, failed_index);
+}
+template <typename InputOffsetT, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf8_to_utf16_batch(const std::basic_string_view<char8_t>& utf8_data, const InputOffsetT* utf8_offsets, size_t count, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char8_t>(visit_offsets(utf8_data, utf8_offsets, count), count, utf16_arena, comply_with_standard, failed_index);
+}
+
+template <typename Range, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf8_to_utf32_batch(const Range& utf8_svs, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char8_t>(visit_range<char8_t>(utf8_svs), static_cast<size_t>(std::size(utf8_svs)), utf32_arena, comply_with_standard, failed_index);
+}
+template <typename InputOffsetT, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf8_to_utf32_batch(const std::basic_string_view<char8_t>& utf8_data, const InputOffsetT* utf8_offsets, size_t count, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char8_t>(visit_offsets(utf8_data, utf8_offsets, count), count, utf32_arena, comply_with_standard, failed_index);
+}
+
+template <typename Range, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf16_to_utf8_batch(const Range& utf16_svs, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char16_t>(visit_range<char16_t>(utf16_svs), static_cast<size_t>(std::size(utf16_svs)), utf8_arena, comply_with_standard, failed_index);
+}
+template <typename InputOffsetT, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf16_to_utf8_batch(const std::basic_string_view<char16_t>& utf16_data, const InputOffsetT* utf16_offsets, size_t count, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char16_t>(visit_offsets(utf16_data, utf16_offsets, count), count, utf8_arena, comply_with_standard, failed_index);
+}
+
+template <typename Range, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf16_to_utf32_batch(const Range& utf16_svs, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char16_t>(visit_range<char16_t>(utf16_svs), static_cast<size_t>(std::size(utf16_svs)), utf32_arena, comply_with_standard, failed_index);
+}
+template <typename InputOffsetT, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf16_to_utf32_batch(const std::basic_string_view<char16_t>& utf16_data, const InputOffsetT* utf16_offsets, size_t count, string_arena<char32_t, OffsetT>& utf32_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char16_t>(visit_offsets(utf16_data, utf16_offsets, count), count, utf32_arena, comply_with_standard, failed_index);
+}
+
+template <typename Range, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf32_to_utf8_batch(const Range& utf32_svs, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char32_t>(visit_range<char32_t>(utf32_svs), static_cast<size_t>(std::size(utf32_svs)), utf8_arena, comply_with_standard, failed_index);
+}
+template <typename InputOffsetT, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf32_to_utf8_batch(const std::basic_string_view<char32_t>& utf32_data, const InputOffsetT* utf32_offsets, size_t count, string_arena<char8_t, OffsetT>& utf8_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char32_t>(visit_offsets(utf32_data, utf32_offsets, count), count, utf8_arena, comply_with_standard, failed_index);
+}
+
+template <typename Range, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf32_to_utf16_batch(const Range& utf32_svs, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char32_t>(visit_range<char32_t>(utf32_svs), static_cast<size_t>(std::size(utf32_svs)), utf16_arena, comply_with_standard, failed_index);
+}
+template <typename InputOffsetT, typename OffsetT>
+utf::conversion::status_e utf::conversion::utf32_to_utf16_batch(const std::basic_string_view<char32_t>& utf32_data, const InputOffsetT* utf32_offsets, size_t count, string_arena<char16_t, OffsetT>& utf16_arena, bool comply_with_standard, size_t* failed_index) {
+    return transcode_batch<char32_t>(visit_offsets(utf32_data, utf32_offsets, count), count, utf16_arena, comply_with_standard, failed_index);
+}
+
+#endif // !defined(UTFUTILS_BATCH_H)
@@ -0,0 +1,302 @@
+#if !defined(UTFUTILS_BYTES_H)
+#   define UTFUTILS_BYTES_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_bytes.hpp
+ * @brief Conversion of raw byte buffers with explicit byte order and bulk byte order normalization.
+ */
+
+#include <algorithm>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#   include <span>
+#endif
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    namespace conversion {
+        /**
+         * @addtogroup byte_funcs Byte Buffer Conversion Functions
+         * Functions used to convert raw bytes, e.g. read from network or files, whose byte order is known up front.
+         *
+         * The input doesn't have to be aligned for its code unit type and is read in blocks: every block is loaded and, if
+         * the byte order differs from the host one, byte-swapped with vector shuffles in one go, then run through the two-pass
+         * kernels while it's still in cache. The output is byte-swapped the same way on its way out. No separate swap pass over
+         * the whole buffer is needed and neither buffer is ever touched one code unit at a time.
+         *
+         * The output is a contiguous resizable container (e.g. @c std::vector<std::byte>, @c std::string or, for matching
+         * encodings, @c std::u16string) whose @c value_type isn't wider than the target code unit. Its previous contents are
+         * replaced and it is cleared on failure.
+         * @{
+         */
+
+        /**
+         * @brief This function converts a byte buffer from one encoding into another.
+         *
+         * @param[in] input pointer to the source bytes, alignment isn't required.
+         * @param[in] input_size number of source bytes.
+         * @param[in] input_encoding encoding of the source bytes. Generic UTF-16 and UTF-32 are read in host byte order unless
+         * they start with a swapped BOM.
+         * @param[out] output container which will receive converted bytes.
+         * @param[in] output_encoding encoding of the target bytes. Generic UTF-16 and UTF-32 are written in host byte order.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf8_to_utf16 for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep. Refer to @ref conv_funcs for details.
+         * @return status specified by #status_e enum. A source whose size isn't a multiple of its code unit size is
+         * reported as #status_e::character_cut_off, a container too wide for the target code unit as #status_e::undefined_error.
+         */
+        template <typename ByteContainer>
+        status_e transcode_bytes(const std::byte* input, size_t input_size, encoding_e input_encoding, ByteContainer& output,
+                                 encoding_e output_encoding, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+#if defined(__cpp_lib_span)
+        /**
+         * @brief This function converts a byte buffer from one encoding into another.
+         *
+         * @param[in] input span over the source bytes, alignment isn't required.
+         * @param[in] input_encoding encoding of the source bytes.
+         * @param[out] output container which will receive converted bytes.
+         * @param[in] output_encoding encoding of the target bytes.
+         * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #utf8_to_utf16 for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
+         * @return status specified by #status_e enum.
+         * @remarks
+         * Refer to the pointer overload for details.
+         */
+        template <typename ByteContainer>
+        status_e transcode_bytes(std::span<const std::byte> input, encoding_e input_encoding, ByteContainer& output,
+                                 encoding_e output_encoding, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+#endif
+
+        /**
+         * @}
+         */
+    } // namespace conversion
+
+    /**
+     * @brief Reverses the byte order of every UTF-16 code unit in place.
+     *
+     * @param[in,out] data pointer to the code units.
+     * @param[in] size number of code units.
+     * @param[in] strip_bom remove the BOM (in either byte order) from the start, moving the rest of the string one code unit
+     * to the front in the same pass. Defaults to @c false.
+     * @return New number of code units.
+     * @remarks
+     * A BOM which isn't stripped is swapped like any other code unit, so it keeps describing the string. The swap is
+     * vectorized and doesn't validate anything, use it to normalize big-endian data to host byte order before converting it.
+     */
+    UTFUTILS_DECL size_t swap_endianness_inplace(char16_t* data, size_t size, bool strip_bom = false);
+    /**
+     * @brief Reverses the byte order of every UTF-32 code unit in place.
+     *
+     * @param[in,out] data pointer to the code units.
+     * @param[in] size number of code units.
+     * @param[in] strip_bom remove the BOM (in either byte order) from the start. Defaults to @c false.
+     * @return New number of code units.
+     * @remarks
+     * Refer to the UTF-16 overload for details.
+     */
+    UTFUTILS_DECL size_t swap_endianness_inplace(char32_t* data, size_t size, bool strip_bom = false);
+#if defined(__cpp_lib_span)
+    /**
+     * @brief Reverses the byte order of every UTF-16 code unit in place.
+     * @return The part of @p data holding the result, without the BOM if it was stripped.
+     */
+    inline std::span<char16_t> swap_endianness_inplace(const std::span<char16_t> data, const bool strip_bom = false) {
+        return data.first(swap_endianness_inplace(data.data(), data.size(), strip_bom));
+    }
+    /**
+     * @brief Reverses the byte order of every UTF-32 code unit in place.
+     * @return The part of @p data holding the result, without the BOM if it was stripped.
+     */
+    inline std::span<char32_t> swap_endianness_inplace(const std::span<char32_t> data, const bool strip_bom = false) {
+        return data.first(swap_endianness_inplace(data.data(), data.size(), strip_bom));
+    }
+#endif
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Number of source code units loaded into a block at once.
+     */
+    constexpr size_t bytes_block_size = 1024;
+    /**
+     * @internal
+     * @brief Maximal number of target code units a block can turn into, one source code unit makes at most four.
+     */
+    constexpr size_t bytes_converted_block_size = bytes_block_size * 4;
+
+    /**
+     * @internal
+     * @brief Loads the next block of source code units in host byte order.
+     * @param block where to load code units to.
+     * @param input source bytes.
+     * @param input_count total number of source code units.
+     * @param offset index of the first code unit of the block.
+     * @param reverse the source has the opposite byte order.
+     * @return View of the block, cut so that it doesn't end in the middle of a character unless it's the last one.
+     */
+    template <typename InputCharT>
+    inline std::basic_string_view<InputCharT> load_bytes_block(InputCharT* block, const std::byte* input, const size_t input_count,
+                                                               const size_t offset, const bool reverse) {
+        const size_t count = std::min(bytes_block_size, input_count - offset);
+        copy_code_units<InputCharT>(reinterpret_cast<std::byte*>(block), input + offset * sizeof(InputCharT), count, reverse);
+        const std::basic_string_view<InputCharT> block_sv(block, count);
+        return offset + count == input_count ? block_sv : block_sv.substr(0, complete_prefix_size(block_sv, false));
+    }
+
+    /**
+     * @internal
+     * @brief Validates source bytes and computes the length of their representation in another encoding.
+     * @param input source bytes.
+     * @param input_count number of source code units.
+     * @param input_reverse the source has the opposite byte order.
+     * @param[out] output_size number of target code units. Only set on success.
+     * @param comply_with_standard should the conversion comply with Unicode standard.
+     * @return status specified by #conversion::status_e enum.
+     */
+    template <typename InputCharT, typename OutputCharT>
+    conversion::status_e transcoded_bytes_size(const std::byte* input, const size_t input_count, const bool input_reverse,
+                                               size_t& output_size, const bool comply_with_standard) {
+        InputCharT block[bytes_block_size];
+        size_t     result = 0;
+        for (size_t offset = 0; offset < input_count;) {
+            const std::basic_string_view<InputCharT> block_sv = load_bytes_block(block, input, input_count, offset, input_reverse);
+            size_t                                   block_output_size = 0;
+            const conversion::status_e status = transcoded_size<InputCharT, OutputCharT>(block_sv, block_output_size, comply_with_standard, false);
+            if (status != conversion::status_e::success) {
+                return status;
+            }
+            result += block_output_size;
+            offset += block_sv.size();
+        }
+        output_size = result;
+        return conversion::status_e::success;
+    }
+
+    /**
+     * @internal
+     * @brief Converts source bytes which were already validated by #transcoded_bytes_size.
+     * @param input source bytes.
+     * @param input_count number of source code units.
+     * @param input_reverse the source has the opposite byte order.
+     * @param output where to write target bytes, alignment isn't required.
+     * @param output_reverse the target is written in the opposite byte order.
+     */
+    template <typename InputCharT, typename OutputCharT>
+    void transcode_bytes_validated(const std::byte* input, const size_t input_count, const bool input_reverse, std::byte* output, const bool output_reverse) {
+        InputCharT  block[bytes_block_size];
+        OutputCharT converted[bytes_converted_block_size];
+        for (size_t offset = 0; offset < input_count;) {
+            const std::basic_string_view<InputCharT> block_sv = load_bytes_block(block, input, input_count, offset, input_reverse);
+            const size_t converted_count = static_cast<size_t>(transcode_validated<InputCharT, OutputCharT>(block_sv, converted, false, false) - converted);
+            copy_code_units<OutputCharT>(output, reinterpret_cast<const std::byte*>(converted), converted_count, output_reverse);
+            output += converted_count * sizeof(OutputCharT);
+            offset += block_sv.size();
+        }
+    }
+
+    /**
+     * @internal
+     * @brief Writes the BOM in the given encoding and byte order.
+     * @param output where to write, alignment isn't required.
+     * @param reverse the BOM is written in the opposite byte order.
+     * @return Number of code units written.
+     */
+    template <typename OutputCharT>
+    inline size_t write_bom(std::byte* output, const bool reverse) {
+        OutputCharT  code_units[4] {};
+        const size_t count = static_cast<size_t>(encoding_traits<OutputCharT>::encode(constants::byte_order_mark, code_units) - code_units);
+        copy_code_units<OutputCharT>(output, reinterpret_cast<const std::byte*>(code_units), count, reverse);
+        return count;
+    }
+} // namespace utf
+
+template <typename ByteContainer>
+utf::conversion::status_e utf::conversion::transcode_bytes(const std::byte* input, const size_t input_size, const encoding_e input_encoding, ByteContainer& output,
+                                                           const encoding_e output_encoding, const bool comply_with_standard, const bom_e bom_policy) {
+    static_assert(is_resizable_container<ByteContainer>::value, "The output must be a contiguous resizable container");
+    using value_type = typename ByteContainer::value_type;
+
+    const status_e status = with_code_unit_type(input_encoding, [&](auto input_code_unit) {
+        using input_char_t = decltype(input_code_unit);
+        if (input_size % sizeof(input_char_t) != 0) {
+            return status_e::character_cut_off;
+        }
+        size_t input_count = input_size / sizeof(input_char_t);
+        // the head is enough to find the BOM
+        input_char_t head[3] {};
+        const size_t head_size = std::min<size_t>(input_count, 3);
+        if (head_size != 0) {
+            std::memcpy(head, input, head_size * sizeof(input_char_t));
+        }
+        const std::basic_string_view<input_char_t> head_sv(head, head_size);
+        const bool                                 input_reverse = needs_byte_swap(input_encoding, head_sv);
+
+        bool                                       add_bom = false;
+        const std::basic_string_view<input_char_t> head_body = apply_bom_policy(head_sv, bom_policy, input_reverse, add_bom);
+        const std::byte*                           body      = input + (head_size - head_body.size()) * sizeof(input_char_t);
+        input_count -= head_size - head_body.size();
+
+        return with_code_unit_type(output_encoding, [&](auto output_code_unit) {
+            using output_char_t = decltype(output_code_unit);
+            if constexpr (sizeof(output_char_t) % sizeof(value_type) != 0) {
+                return status_e::undefined_error;
+            }
+            else {
+                size_t output_size = 0;
+                const status_e size_status = transcoded_bytes_size<input_char_t, output_char_t>(body, input_count, input_reverse, output_size, comply_with_standard);
+                if (size_status != status_e::success) {
+                    return size_status;
+                }
+                if (add_bom) {
+                    output_size += encoding_traits<output_char_t>::code_unit_count(constants::byte_order_mark);
+                }
+                const bool output_reverse = needs_byte_swap(output_encoding, std::basic_string_view<output_char_t>());
+                resize_and_write(output, output_size * (sizeof(output_char_t) / sizeof(value_type)), [&](value_type* data) {
+                    std::byte* bytes = reinterpret_cast<std::byte*>(data);
+                    if (add_bom) {
+                        bytes += write_bom<output_char_t>(bytes, output_reverse) * sizeof(output_char_t);
+                    }
+                    transcode_bytes_validated<input_char_t, output_char_t>(body, input_count, input_reverse, bytes, output_reverse);
+                });
+                return status_e::success;
+            }
+        });
+    });
+    if (status != status_e::success) {
+        output.clear();
+    }
+    return status;
+}
+
+#if defined(__cpp_lib_span)
+template <typename ByteContainer>
+utf::conversion::status_e utf::conversion::transcode_bytes(const std::span<const std::byte> input, const encoding_e input_encoding, ByteContainer& output,
+                                                           const encoding_e output_encoding, const bool comply_with_standard, const bom_e bom_policy) {
+    return transcode_bytes(input.data(), input.size(), input_encoding, output, output_encoding, comply_with_standard, bom_policy);
+}
+#endif
+
+//--------------------------------------------------IMPLEMENTATION--------------------------------------------------//
+#if defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+
+UTFUTILS_DECL size_t utf::swap_endianness_inplace(char16_t* data, const size_t size, const bool strip_bom) {
+    // the copy runs forwards, so the destination may lag one code unit behind the source
+    const size_t skipped = strip_bom && size != 0 && utf16_bom(data[0]) != endianness_e::unspecified ? 1 : 0;
+    copy_swapped<char16_t>(reinterpret_cast<std::byte*>(data), reinterpret_cast<const std::byte*>(data + skipped), size - skipped);
+    return size - skipped;
+}
+
+UTFUTILS_DECL size_t utf::swap_endianness_inplace(char32_t* data, const size_t size, const bool strip_bom) {
+    const size_t skipped = strip_bom && size != 0 && utf32_bom(data[0]) != endianness_e::unspecified ? 1 : 0;
+    copy_swapped<char32_t>(reinterpret_cast<std::byte*>(data), reinterpret_cast<const std::byte*>(data + skipped), size - skipped);
+    return size - skipped;
+}
+
+#endif // defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+#endif // !defined(UTFUTILS_BYTES_H)
@@ -0,0 +1,354 @@
+#if !defined(UTFUTILS_COMPACT_H)
+#   define UTFUTILS_COMPACT_H
+
+#include "utf_latin1.hpp"
+
+/**
+ * @file utf_compact.hpp
+ * @brief String with the narrowest fixed-width representation of its code points.
+ */
+
+#include <variant>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief String of code points stored with one, two or four bytes per code point, like Python's PEP 393 strings.
+     * @details
+     * The width is picked per string from its largest code point: Latin-1 text takes one byte per code point, the rest of
+     * the Basic Multilingual Plane two (UCS-2) and anything else four (UTF-32). Every code point is therefore at a fixed
+     * offset and indexing is O(1), while mostly ASCII text takes a quarter of the memory of UTF-32.
+     *
+     * Code points can't be modified in place, the contents are only replaced as a whole by the @c assign_* functions and
+     * #clear. The @c assign_* functions validate the source like @ref conv_funcs do and leave the string empty on failure.
+     * A BOM at the start of the source isn't part of the text and is dropped. It is converted back by the @c to_* functions
+     * into any sink of @ref conv_funcs, Latin-1 strings with the vectorized kernels of @ref latin1_funcs.
+     *
+     * UCS-2 storage is UTF-16 without surrogate pairs, so it's copied to UTF-16 as is. Lenient UTF-8 and UTF-32 sources may
+     * hold a high surrogate code point directly followed by a low one, which UTF-16 would read as a single character; such
+     * strings are stored as UTF-32 instead.
+     */
+    class compact_string {
+    public:
+        compact_string() = default;
+
+        /**
+         * @brief Replaces the contents with a UTF-8 string.
+         * @param[in] utf8_sv UTF-8 string.
+         * @param[in] comply_with_standard reject surrogates and overlong sequences. Defaults to @c false.
+         * @return status specified by #conversion::status_e enum.
+         */
+        inline conversion::status_e assign_utf8(const std::basic_string_view<char8_t>& utf8_sv, bool comply_with_standard = false);
+        /**
+         * @brief Replaces the contents with a UTF-16 string.
+         * @param[in] utf16_sv UTF-16 string, its byte order is guessed from the BOM.
+         * @param[in] comply_with_standard reject unpaired surrogates. Defaults to @c false.
+         * @return status specified by #conversion::status_e enum.
+         */
+        inline conversion::status_e assign_utf16(const std::basic_string_view<char16_t>& utf16_sv, bool comply_with_standard = false);
+        /**
+         * @brief Replaces the contents with a UTF-32 string.
+         * @param[in] utf32_sv UTF-32 string, its byte order is guessed from the BOM.
+         * @param[in] comply_with_standard reject surrogate code points. Defaults to @c false.
+         * @return status specified by #conversion::status_e enum.
+         */
+        inline conversion::status_e assign_utf32(const std::basic_string_view<char32_t>& utf32_sv, bool comply_with_standard = false);
+        /**
+         * @brief Replaces the contents with a Latin-1 string.
+         * @param[in] latin1_sv Latin-1 string.
+         */
+        void assign_latin1(const std::string_view& latin1_sv) {
+            data_ = std::string(latin1_sv);
+        }
+
+        /**
+         * @brief Returns number of code points.
+         */
+        size_t size() const {
+            return std::visit([](const auto& code_points) { return code_points.size(); }, data_);
+        }
+        bool empty() const {
+            return size() == 0;
+        }
+        /**
+         * @brief Returns number of bytes per code point: @c 1, @c 2 or @c 4.
+         */
+        size_t char_width() const {
+            static constexpr size_t widths[] = {1, 2, 4};
+            return widths[data_.index()];
+        }
+        /**
+         * @brief Returns code point number @p index.
+         */
+        char32_t operator[](const size_t index) const {
+            switch (data_.index()) {
+                case 0:
+                    return static_cast<uint8_t>(std::get<0>(data_)[index]);
+                case 1:
+                    return std::get<1>(data_)[index];
+                default:
+                    return std::get<2>(data_)[index];
+            }
+        }
+        bool operator==(const compact_string& other) const {
+            // the width is decided by the contents, so equal strings have equal representations
+            return data_ == other.data_;
+        }
+        bool operator!=(const compact_string& other) const {
+            return !(*this == other);
+        }
+        void clear() {
+            data_ = std::string();
+        }
+
+        /**
+         * @brief Converts the string to UTF-8.
+         * @param[out] utf8_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return #conversion::status_e::success, the string is always valid.
+         */
+        template <typename Sink>
+        conversion::status_e to_utf8(Sink&& utf8_sink) const {
+            return convert<char8_t>(std::forward<Sink>(utf8_sink));
+        }
+        /**
+         * @brief Converts the string to UTF-16.
+         * @param[out] utf16_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return #conversion::status_e::success, the string is always valid.
+         */
+        template <typename Sink>
+        conversion::status_e to_utf16(Sink&& utf16_sink) const {
+            return convert<char16_t>(std::forward<Sink>(utf16_sink));
+        }
+        /**
+         * @brief Converts the string to UTF-32.
+         * @param[out] utf32_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return #conversion::status_e::success, the string is always valid.
+         */
+        template <typename Sink>
+        conversion::status_e to_utf32(Sink&& utf32_sink) const {
+            return convert<char32_t>(std::forward<Sink>(utf32_sink));
+        }
+
+    private:
+        template <typename OutputCharT, typename Sink>
+        conversion::status_e convert(Sink&& sink) const;
+
+        std::variant<std::string, std::u16string, std::u32string> data_; /**< Latin-1, UCS-2 or UTF-32 code points. */
+    };
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Computes the length of fixed-width code points in an encoding.
+     * @tparam OutputCharT code unit type of the target encoding.
+     * @param code_points code points, one per element.
+     * @return Number of target code units.
+     */
+    template <typename OutputCharT, typename CharT>
+    size_t encoded_size(const std::basic_string_view<CharT>& code_points) {
+        size_t result = 0;
+        for (const CharT code_point : code_points) {
+            result += encoding_traits<OutputCharT>::code_unit_count(code_point);
+        }
+        return result;
+    }
+    /**
+     * @internal
+     * @brief Encodes fixed-width code points one by one, surrogate code points are encoded on their own.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename OutputCharT, typename CharT, typename OutputIt>
+    OutputIt encode_code_points(const std::basic_string_view<CharT>& code_points, OutputIt out) {
+        for (const CharT code_point : code_points) {
+            out = encoding_traits<OutputCharT>::encode(code_point, out);
+        }
+        return out;
+    }
+    /**
+     * @internal
+     * @brief Copies fixed-width code points which are single code units of the target encoding, with a plain copy into
+     * container sinks.
+     */
+    template <typename OutputCharT, typename CharT, typename OutputIt>
+    void copy_code_points(const std::basic_string_view<CharT>& code_points, OutputIt out) {
+        if constexpr (sizeof(OutputCharT) == sizeof(CharT) && std::is_pointer_v<OutputIt>) {
+            copy_code_units<CharT>(reinterpret_cast<std::byte*>(out), reinterpret_cast<const std::byte*>(code_points.data()), code_points.size(), false);
+        } else {
+            std::copy(code_points.begin(), code_points.end(), out);
+        }
+    }
+
+    /**
+     * @internal
+     * @brief Checks if two code points would read as one character once stored as UTF-16 code units.
+     */
+    constexpr bool forms_surrogate_pair(const char32_t first, const char32_t second) {
+        return first <= 0xFFFF && second <= 0xFFFF && is_high_surrogate(static_cast<char16_t>(first)) && is_low_surrogate(static_cast<char16_t>(second));
+    }
+
+    /**
+     * @internal
+     * @brief Fills the string of the narrowest width for validated code points.
+     * @param[out] data where to store the code points.
+     * @param max_code_point the largest code point.
+     * @param size number of code points.
+     * @param latin1_writer, ucs2_writer, utf32_writer callables receiving pointer to the data of the respective width.
+     */
+    template <typename Latin1Writer, typename UCS2Writer, typename UTF32Writer>
+    void fill_compact(std::variant<std::string, std::u16string, std::u32string>& data, const char32_t max_code_point, const size_t size,
+                      Latin1Writer&& latin1_writer, UCS2Writer&& ucs2_writer, UTF32Writer&& utf32_writer) {
+        if (max_code_point <= 0xFF) {
+            resize_and_write(data.emplace<std::string>(), size, latin1_writer);
+        } else if (max_code_point <= 0xFFFF) {
+            resize_and_write(data.emplace<std::u16string>(), size, ucs2_writer);
+        } else {
+            resize_and_write(data.emplace<std::u32string>(), size, utf32_writer);
+        }
+    }
+} // namespace utf
+
+inline utf::conversion::status_e utf::compact_string::assign_utf8(const std::basic_string_view<char8_t>& utf8_sv, const bool comply_with_standard) {
+    const std::basic_string_view<char8_t> body = utf8_sv.substr(bom_size(utf8_sv, false));
+
+    // validate, count code points and find the largest one, skipping ASCII runs with vector compares
+    const char8_t* it             = body.data();
+    const char8_t* end            = it + body.size();
+    size_t         size           = 0;
+    char32_t       max_code_point = 0;
+    char32_t       previous       = 0;
+    while (it != end) {
+        const size_t ascii_size = ascii_prefix_size(reinterpret_cast<const std::byte*>(it), static_cast<size_t>(end - it));
+        if (ascii_size != 0) {
+            it   += ascii_size;
+            size += ascii_size;
+            max_code_point = std::max<char32_t>(max_code_point, 0x7F);
+            previous       = 0;
+            continue;
+        }
+        char32_t code_point = 0;
+        const conversion::status_e status = utf8_decode(it, end, code_point, comply_with_standard);
+        if (status != conversion::status_e::success) {
+            clear();
+            return status;
+        }
+        // surrogates encoded one by one (CESU-8) must not become a pair in UCS-2
+        max_code_point = std::max(max_code_point, forms_surrogate_pair(previous, code_point) ? char32_t(0x10000) : code_point);
+        previous       = code_point;
+        ++size;
+    }
+
+    // below U+10000 every code point, surrogates included, is encoded as a single UTF-16 code unit
+    fill_compact(data_, max_code_point, size, [&body](char* data) { utf8_to_latin1_validated(body, data); },
+                 [&body](char16_t* data) { transcode_validated<char8_t, char16_t>(body, data, false, false); },
+                 [&body](char32_t* data) { transcode_validated<char8_t, char32_t>(body, data, false, false); });
+    return conversion::status_e::success;
+}
+
+inline utf::conversion::status_e utf::compact_string::assign_utf16(const std::basic_string_view<char16_t>& utf16_sv, const bool comply_with_standard) {
+    const bool                             reverse = encoding_traits<char16_t>::is_reversed(utf16_sv);
+    const std::basic_string_view<char16_t> body    = utf16_sv.substr(bom_size(utf16_sv, reverse));
+    const std::byte*                       bytes   = reinterpret_cast<const std::byte*>(body.data());
+
+    // Latin-1 and surrogate-free text, the common cases, are recognized with vector compares
+    if (latin1_prefix_size<char16_t>(bytes, body.size(), reverse) == body.size()) {
+        resize_and_write(data_.emplace<std::string>(), body.size(), [bytes, &body, reverse](char* data) {
+            narrow_to_latin1<char16_t>(bytes, body.size(), reverse, data);
+        });
+        return conversion::status_e::success;
+    }
+    size_t size = body.size();
+    if (surrogate_free_prefix_size(bytes, body.size(), reverse) != body.size()) {
+        const conversion::status_e status = transcoded_size<char16_t, char32_t>(body, size, comply_with_standard, reverse);
+        if (status != conversion::status_e::success) {
+            clear();
+            return status;
+        }
+    }
+    // without surrogate pairs every code unit is a code point
+    if (size == body.size()) {
+        resize_and_write(data_.emplace<std::u16string>(), size, [bytes, &body, reverse](char16_t* data) {
+            copy_code_units<char16_t>(reinterpret_cast<std::byte*>(data), bytes, body.size(), reverse);
+        });
+    } else {
+        resize_and_write(data_.emplace<std::u32string>(), size, [&body, reverse](char32_t* data) {
+            transcode_validated<char16_t, char32_t>(body, data, reverse, false);
+        });
+    }
+    return conversion::status_e::success;
+}
+
+inline utf::conversion::status_e utf::compact_string::assign_utf32(const std::basic_string_view<char32_t>& utf32_sv, const bool comply_with_standard) {
+    const bool                             reverse = encoding_traits<char32_t>::is_reversed(utf32_sv);
+    const std::basic_string_view<char32_t> body    = utf32_sv.substr(bom_size(utf32_sv, reverse));
+    const std::byte*                       bytes   = reinterpret_cast<const std::byte*>(body.data());
+
+    char32_t max_code_point = 0;
+    if (latin1_prefix_size<char32_t>(bytes, body.size(), reverse) != body.size()) {
+        size_t ignored = 0;
+        const conversion::status_e status = transcoded_size<char32_t, char32_t>(body, ignored, comply_with_standard, reverse);
+        if (status != conversion::status_e::success) {
+            clear();
+            return status;
+        }
+        char32_t previous = 0;
+        for (const char32_t code_unit : body) {
+            const char32_t code_point = reverse ? utf32_reverse_endianness(code_unit) : code_unit;
+            max_code_point = std::max(max_code_point, forms_surrogate_pair(previous, code_point) ? char32_t(0x10000) : code_point);
+            previous       = code_point;
+        }
+    }
+
+    fill_compact(data_, max_code_point, body.size(), [bytes, &body, reverse](char* data) { narrow_to_latin1<char32_t>(bytes, body.size(), reverse, data); },
+                 [&body, reverse](char16_t* data) {
+                     for (const char32_t code_unit : body) {
+                         *data++ = static_cast<char16_t>(reverse ? utf32_reverse_endianness(code_unit) : code_unit);
+                     }
+                 },
+                 [bytes, &body, reverse](char32_t* data) { copy_code_units<char32_t>(reinterpret_cast<std::byte*>(data), bytes, body.size(), reverse); });
+    return conversion::status_e::success;
+}
+
+template <typename OutputCharT, typename Sink>
+utf::conversion::status_e utf::compact_string::convert(Sink&& sink) const {
+    switch (data_.index()) {
+        case 0: {
+            const std::string_view latin1_sv = std::get<0>(data_);
+            if constexpr (sizeof(OutputCharT) == 1) {
+                return conversion::latin1_to_utf8(latin1_sv, std::forward<Sink>(sink));
+            } else if constexpr (sizeof(OutputCharT) == 2) {
+                return conversion::latin1_to_utf16(latin1_sv, std::forward<Sink>(sink));
+            } else {
+                return conversion::latin1_to_utf32(latin1_sv, std::forward<Sink>(sink));
+            }
+        }
+        case 1: {
+            const std::u16string_view ucs2_sv = std::get<1>(data_);
+            if constexpr (sizeof(OutputCharT) == 1) {
+                write_to_sink<OutputCharT>(std::forward<Sink>(sink), encoded_size<OutputCharT>(ucs2_sv), [&ucs2_sv](auto out) {
+                    encode_code_points<OutputCharT>(ucs2_sv, out);
+                });
+            } else {
+                // every UCS-2 code point is a single UTF-16 or UTF-32 code unit
+                write_to_sink<OutputCharT>(std::forward<Sink>(sink), ucs2_sv.size(), [&ucs2_sv](auto out) { copy_code_points<OutputCharT>(ucs2_sv, out); });
+            }
+            return conversion::status_e::success;
+        }
+        default: {
+            const std::u32string_view utf32_sv = std::get<2>(data_);
+            if constexpr (sizeof(OutputCharT) == 4) {
+                write_to_sink<OutputCharT>(std::forward<Sink>(sink), utf32_sv.size(), [&utf32_sv](auto out) { copy_code_points<OutputCharT>(utf32_sv, out); });
+            } else {
+                write_to_sink<OutputCharT>(std::forward<Sink>(sink), encoded_size<OutputCharT>(utf32_sv), [&utf32_sv](auto out) {
+                    encode_code_points<OutputCharT>(utf32_sv, out);
+                });
+            }
+            return conversion::status_e::success;
+        }
+    }
+}
+
+#endif // !defined(UTFUTILS_COMPACT_H)
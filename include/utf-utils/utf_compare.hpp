@@ -0,0 +1,158 @@
+#if !defined(UTFUTILS_COMPARE_H)
+#   define UTFUTILS_COMPARE_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_compare.hpp
+ * @brief Comparison of strings in different encodings without converting them.
+ */
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @addtogroup compare_funcs Comparison Functions
+     * Functions used to compare UTF-8, UTF-16 and UTF-32 strings with each other by their code points.
+     *
+     * Both strings are decoded lazily in lockstep, so nothing is allocated and the comparison stops at the first difference.
+     * Runs of ASCII characters are compared 16 at a time, and for strings of the same encoding the identical prefix is
+     * skipped at once. UTF-16 and UTF-32 strings with a BOM are read in its byte order. A leading BOM of either string is
+     * skipped, it marks the encoding rather than belonging to the text. Code units which cannot be decoded compare as
+     * @c U+FFFD, like in @ref utf_views.hpp.
+     *
+     * #code_point_hash skips a leading BOM the same way, so valid strings which are #equal hash the same. Invalid strings are
+     * rejected by the hash rather than hashed with @c U+FFFD, so this doesn't hold for them.
+     * @{
+     */
+
+    /**
+     * @brief Compares two strings in code point order.
+     *
+     * @param[in] left the first string: a view of @c char8_t, @c char16_t or @c char32_t code units.
+     * @param[in] right the second string: a view of @c char8_t, @c char16_t or @c char32_t code units.
+     * @return Negative value if @p left orders before @p right, zero if they have the same code points, positive value otherwise.
+     * @details
+     * Code point order is the binary order of UTF-8 and UTF-32 but not of UTF-16, where characters above @c U+FFFF are stored
+     * as surrogates that order before @c U+E000-U+FFFF. This function orders them by code point in every encoding.
+     */
+    template <typename LeftCharT, typename RightCharT>
+    int compare(const std::basic_string_view<LeftCharT>& left, const std::basic_string_view<RightCharT>& right);
+    /**
+     * @brief Checks if two strings have the same code points.
+     * @details Refer to #compare for details on parameters.
+     */
+    template <typename LeftCharT, typename RightCharT>
+    bool equal(const std::basic_string_view<LeftCharT>& left, const std::basic_string_view<RightCharT>& right) {
+        return compare(left, right) == 0;
+    }
+
+    /**
+     * @}
+     */
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Decodes one character, a code unit which cannot be decoded is @c U+FFFD.
+     * @param[in,out] it pointer to the first code unit, moved past the character.
+     * @param[in] end pointer past the last code unit of the string.
+     * @param[in] reverse the string has the opposite byte order.
+     * @return The code point.
+     */
+    template <typename CharT>
+    constexpr char32_t decode_or_replace(const CharT*& it, const CharT* end, const bool reverse) {
+        char32_t code_point = 0;
+        if (encoding_traits<CharT>::decode(it, end, code_point, false, reverse) != conversion::status_e::success) {
+            ++it;
+            return constants::replacement_character;
+        }
+        return code_point;
+    }
+
+    /**
+     * @internal
+     * @brief Moves an offset at which two strings of the same encoding start to differ to the start of its character.
+     * @param sv one of the strings.
+     * @param offset number of code units the strings have in common.
+     * @param reverse the strings have the opposite byte order.
+     * @return Offset of the first character which may differ.
+     */
+    template <typename CharT>
+    size_t common_character_prefix_size(const std::basic_string_view<CharT>& sv, size_t offset, const bool reverse) {
+        if (offset == 0) {
+            return 0;
+        }
+        if constexpr (sizeof(CharT) == 1) {
+            // the units before the offset are shared, so back up over trailing bytes to a leading one
+            size_t step = 0;
+            for (; step < 3 && offset != 0 && static_cast<uint8_t>(sv[offset - 1]) >> 6 == constants::trailing_byte_marker; ++step) {
+                --offset;
+            }
+            if (offset != 0 && static_cast<uint8_t>(sv[offset - 1]) >= 0xC0) {
+                --offset;
+            }
+        }
+        else if constexpr (sizeof(CharT) == 2) {
+            const char16_t last = reverse ? encoding_traits<char16_t>::reverse_endianness(sv[offset - 1]) : sv[offset - 1];
+            if (is_high_surrogate(last)) {
+                --offset;
+            }
+        }
+        return offset;
+    }
+} // namespace utf
+
+template <typename LeftCharT, typename RightCharT>
+int utf::compare(const std::basic_string_view<LeftCharT>& left, const std::basic_string_view<RightCharT>& right) {
+    const bool left_reverse  = encoding_traits<LeftCharT>::is_reversed(left);
+    const bool right_reverse = encoding_traits<RightCharT>::is_reversed(right);
+
+    const std::basic_string_view<LeftCharT>  left_body  = left.substr(bom_size(left, left_reverse));
+    const std::basic_string_view<RightCharT> right_body = right.substr(bom_size(right, right_reverse));
+
+    const LeftCharT*  left_it   = left_body.data();
+    const LeftCharT*  left_end  = left_it + left_body.size();
+    const RightCharT* right_it  = right_body.data();
+    const RightCharT* right_end = right_it + right_body.size();
+
+    if constexpr (std::is_same_v<LeftCharT, RightCharT>) {
+        if (left_reverse == right_reverse) {
+            const size_t common = common_prefix_size(reinterpret_cast<const std::byte*>(left_it), reinterpret_cast<const std::byte*>(right_it),
+                                                     std::min(left_body.size(), right_body.size()) * sizeof(LeftCharT)) / sizeof(LeftCharT);
+            const size_t skipped = common_character_prefix_size(left_body, common, left_reverse);
+            left_it  += skipped;
+            right_it += skipped;
+        }
+    }
+
+    const bool ascii_fast_path = !left_reverse && !right_reverse;
+    bool       last_was_ascii  = true;
+    while (left_it != left_end && right_it != right_end) {
+        // keep looking for ASCII runs while the text is ASCII
+        if (ascii_fast_path && last_was_ascii) {
+            const size_t ascii = equal_ascii_prefix_size<LeftCharT, RightCharT>(reinterpret_cast<const std::byte*>(left_it), reinterpret_cast<const std::byte*>(right_it),
+                                                                               std::min<size_t>(left_end - left_it, right_end - right_it));
+            left_it  += ascii;
+            right_it += ascii;
+            if (left_it == left_end || right_it == right_end) {
+                break;
+            }
+        }
+        const char32_t left_code_point  = decode_or_replace(left_it, left_end, left_reverse);
+        const char32_t right_code_point = decode_or_replace(right_it, right_end, right_reverse);
+        if (left_code_point != right_code_point) {
+            return left_code_point < right_code_point ? -1 : 1;
+        }
+        last_was_ascii = left_code_point < 0x80;
+    }
+    if (left_it != left_end) {
+        return 1;
+    }
+    return right_it != right_end ? -1 : 0;
+}
+
+#endif // !defined(UTFUTILS_COMPARE_H)
@@ -0,0 +1,208 @@
+#if !defined(UTFUTILS_DECODE_H)
+#   define UTFUTILS_DECODE_H
+
+#include "utf_utils.hpp"
+
+/**
+ * @file utf_decode.hpp
+ * @brief Decoding in both directions from any position, e.g. to read the tail of a large text.
+ * @details
+ * Code units which cannot be decoded are presented as @c U+FFFD, one per code unit.
+ */
+
+#include <iterator>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Bidirectional iterator decoding code points from code units on the fly.
+     * @tparam CharT code unit type: @c char8_t, @c char16_t or @c char32_t.
+     * @details
+     * Stepping backwards relies on UTF-8 and UTF-16 being self-synchronizing, so it costs the same as stepping forwards
+     * and never looks further back than the start of the previous character. Use #decoder_at to start anywhere.
+     */
+    template <typename CharT>
+    class decode_iterator {
+    public:
+        using iterator_concept  = std::bidirectional_iterator_tag;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = char32_t;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = char32_t;
+
+        constexpr decode_iterator() = default;
+        /**
+         * @brief Creates an iterator pointing at the character starting at @p current.
+         * @param begin pointer to the first code unit of the string, used to step backwards.
+         * @param current pointer to the first code unit of the character.
+         * @param end pointer past the last code unit of the string.
+         * @param reverse the string has the opposite byte order.
+         */
+        constexpr decode_iterator(const CharT* begin, const CharT* current, const CharT* end, const bool reverse)
+            : begin_(begin), current_(current), next_(current), end_(end), reverse_(reverse) {
+            decode_current();
+        }
+
+        constexpr char32_t operator*() const {
+            return code_point_;
+        }
+        constexpr decode_iterator& operator++() {
+            current_ = next_;
+            decode_current();
+            return *this;
+        }
+        constexpr decode_iterator operator++(int) {
+            decode_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        constexpr decode_iterator& operator--() {
+            const CharT* start = current_;
+            if (encoding_traits<CharT>::decode_backward(begin_, start, code_point_, false, reverse_) != conversion::status_e::success) {
+                start       = current_ - 1;
+                code_point_ = constants::replacement_character;
+            }
+            next_    = current_;
+            current_ = start;
+            return *this;
+        }
+        constexpr decode_iterator operator--(int) {
+            decode_iterator previous = *this;
+            --*this;
+            return previous;
+        }
+
+        /**
+         * @brief Returns pointer to the first code unit of the current character.
+         */
+        constexpr const CharT* base() const {
+            return current_;
+        }
+
+        friend constexpr bool operator==(const decode_iterator& lhs, const decode_iterator& rhs) {
+            return lhs.current_ == rhs.current_;
+        }
+        friend constexpr bool operator!=(const decode_iterator& lhs, const decode_iterator& rhs) {
+            return lhs.current_ != rhs.current_;
+        }
+
+    private:
+        constexpr void decode_current() {
+            if (current_ == end_) {
+                next_ = end_;
+                return;
+            }
+            next_ = current_;
+            if (encoding_traits<CharT>::decode(next_, end_, code_point_, false, reverse_) != conversion::status_e::success) {
+                next_       = current_ + 1;
+                code_point_ = constants::replacement_character;
+            }
+        }
+
+        const CharT* begin_      = nullptr;
+        const CharT* current_    = nullptr;
+        const CharT* next_       = nullptr;
+        const CharT* end_        = nullptr;
+        char32_t     code_point_ = 0;
+        bool         reverse_    = false;
+    };
+
+    /**
+     * @brief Moves an offset to the start of the character it is in.
+     *
+     * @param[in] sv UTF-8, UTF-16 or UTF-32 string. UTF-16 byte order is guessed from the BOM.
+     * @param[in] offset offset of any code unit, offsets past the end mean the end.
+     * @return Offset of the first code unit of the character, found by looking at most three code units back.
+     */
+    template <typename CharT>
+    constexpr size_t character_start(const std::basic_string_view<CharT>& sv, size_t offset);
+
+    /**
+     * @brief Creates a decoder positioned at the character an offset is in.
+     *
+     * @param[in] sv UTF-8, UTF-16 or UTF-32 string. UTF-16 and UTF-32 byte order is guessed from the BOM.
+     * @param[in] offset offset of any code unit, the size of @p sv gives the end iterator to step backwards from.
+     * @return Iterator which can step both ways through the whole string.
+     */
+    template <typename CharT>
+    constexpr decode_iterator<CharT> decoder_at(const std::basic_string_view<CharT>& sv, const size_t offset) {
+        const bool reverse = encoding_traits<CharT>::is_reversed(sv);
+        return decode_iterator<CharT>(sv.data(), sv.data() + character_start(sv, offset), sv.data() + sv.size(), reverse);
+    }
+
+    /**
+     * @brief Finds the last @p count characters of a string by stepping backwards from its end.
+     *
+     * @param[in] sv UTF-8, UTF-16 or UTF-32 string.
+     * @param[in] count number of characters.
+     * @return View of the last @p count characters, the whole string if it has fewer. Only those are looked at.
+     */
+    template <typename CharT>
+    constexpr std::basic_string_view<CharT> last_code_points(const std::basic_string_view<CharT>& sv, size_t count);
+
+    /**
+     * @brief Decodes the last @p count characters of a string, e.g. the tail of a log file.
+     *
+     * @param[in] sv UTF-8, UTF-16 or UTF-32 string.
+     * @param[in] count number of characters.
+     * @param[out] utf32_sink container or output iterator to write the code points to, in the order of the string.
+     * Refer to @ref conv_funcs for details on sinks.
+     * @return Number of decoded code points, less than @p count if the string is shorter.
+     * @details The work depends on @p count only, not on the size of the string.
+     */
+    template <typename CharT, typename Sink>
+    size_t decode_last_n(const std::basic_string_view<CharT>& sv, size_t count, Sink&& utf32_sink);
+} // namespace utf
+
+template <typename CharT>
+constexpr size_t utf::character_start(const std::basic_string_view<CharT>& sv, size_t offset) {
+    if (offset >= sv.size()) {
+        return sv.size();
+    }
+    if constexpr (sizeof(CharT) == 1) {
+        for (size_t step = 0; step < 3 && offset != 0 && static_cast<uint8_t>(sv[offset]) >> 6 == constants::trailing_byte_marker; ++step) {
+            --offset;
+        }
+    }
+    else if constexpr (sizeof(CharT) == 2) {
+        const bool reverse = encoding_traits<CharT>::is_reversed(sv);
+        auto       value   = [&sv, reverse](const size_t index) {
+            return reverse ? encoding_traits<CharT>::reverse_endianness(sv[index]) : sv[index];
+        };
+        if (offset != 0 && is_low_surrogate(value(offset)) && is_high_surrogate(value(offset - 1))) {
+            --offset;
+        }
+    }
+    return offset;
+}
+
+template <typename CharT>
+constexpr std::basic_string_view<CharT> utf::last_code_points(const std::basic_string_view<CharT>& sv, const size_t count) {
+    decode_iterator<CharT> it = decoder_at(sv, sv.size());
+    for (size_t step = 0; step < count && it.base() != sv.data(); ++step) {
+        --it;
+    }
+    return sv.substr(static_cast<size_t>(it.base() - sv.data()));
+}
+
+template <typename CharT, typename Sink>
+size_t utf::decode_last_n(const std::basic_string_view<CharT>& sv, const size_t count, Sink&& utf32_sink) {
+    // step back once, remembering how many characters there are
+    decode_iterator<CharT> first = decoder_at(sv, sv.size());
+    size_t                 size  = 0;
+    for (; size < count && first.base() != sv.data(); ++size) {
+        --first;
+    }
+    const decode_iterator<CharT> last = decoder_at(sv, sv.size());
+
+    write_to_sink<char32_t>(std::forward<Sink>(utf32_sink), size, [first, &last](auto output) {
+        for (decode_iterator<CharT> it = first; it != last; ++it, ++output) {
+            *output = *it;
+        }
+    });
+    return size;
+}
+
+#endif // !defined(UTFUTILS_DECODE_H)
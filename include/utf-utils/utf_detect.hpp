@@ -0,0 +1,194 @@
+#if !defined(UTFUTILS_DETECT_H)
+#   define UTFUTILS_DETECT_H
+
+#include "utf_bytes.hpp"
+
+/**
+ * @file utf_detect.hpp
+ * @brief Detection of the encoding of raw bytes.
+ */
+
+#include <initializer_list>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Result of #detect_encoding.
+     */
+    struct detected_encoding {
+        encoding_e encoding   = encoding_e::utf8; /**< The most likely encoding, UTF-16 and UTF-32 always with explicit byte order. */
+        double     confidence = 0;                /**< From @c 0 (no encoding fits) to @c 1 (there is a BOM). */
+        size_t     bom_size   = 0;                /**< Size of the BOM in bytes, @c 0 if there is none. */
+    };
+
+    /**
+     * @brief Default number of bytes #detect_encoding looks at.
+     */
+    constexpr size_t detection_sample_size = 1 << 16;
+
+    /**
+     * @brief Guesses the encoding of a byte buffer.
+     *
+     * @param[in] data pointer to the bytes, alignment isn't required.
+     * @param[in] size number of bytes.
+     * @param[in] sample_size maximal number of leading bytes to look at. Defaults to #detection_sample_size.
+     * @return The most likely encoding, confidence of the guess and size of the BOM.
+     * @remarks
+     * A BOM decides the encoding on its own. Without one the zero bytes of the sample are counted by their position within
+     * four-byte groups with vector compares: text in UTF-32 has a zero in the high byte of every code unit and text in UTF-16
+     * has zeros in the high bytes of ASCII characters, while UTF-8 text has none at all. Every encoding the distribution
+     * points at is then validated on the sample (the ASCII part of UTF-8 is skipped with vector compares too), and the
+     * first valid one is returned. Confidence is high when the distribution is clear-cut or the sample has multi-byte UTF-8
+     * sequences, lower for UTF-16 without any zero bytes (e.g. CJK text) whose byte order has to be guessed. Empty or pure
+     * ASCII input is reported as UTF-8.
+     */
+    UTFUTILS_DECL detected_encoding detect_encoding(const std::byte* data, size_t size, size_t sample_size = detection_sample_size);
+#if defined(__cpp_lib_span)
+    /**
+     * @brief Guesses the encoding of a byte buffer.
+     * @remarks
+     * Refer to the pointer overload for details.
+     */
+    inline detected_encoding detect_encoding(const std::span<const std::byte> data, const size_t sample_size = detection_sample_size) {
+        return detect_encoding(data.data(), data.size(), sample_size);
+    }
+#endif
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Checks if the bytes are valid in the given encoding.
+     * @param data the bytes, cut off at an arbitrary place.
+     * @param size number of bytes.
+     * @param reverse the bytes are in the opposite byte order.
+     * @return @c true if every complete character is valid and standard-compliant.
+     */
+    template <typename CharT>
+    inline bool is_valid_sample(const std::byte* data, const size_t size, const bool reverse) {
+        const size_t count   = size / sizeof(CharT);
+        size_t       ignored = 0;
+        // the incomplete character at the end of the sample is ignored
+        if (reinterpret_cast<uintptr_t>(data) % alignof(CharT) == 0) {
+            const std::basic_string_view<CharT> sample(reinterpret_cast<const CharT*>(data), count);
+            return transcoded_size<CharT, char32_t>(sample.substr(0, complete_prefix_size(sample, reverse)), ignored, true, reverse) == conversion::status_e::success;
+        }
+        // misaligned code units are loaded a block at a time into host byte order on the stack
+        CharT block[bytes_block_size];
+        for (size_t offset = 0; offset < count;) {
+            std::basic_string_view<CharT> block_sv = load_bytes_block(block, data, count, offset, reverse);
+            const bool                    last     = offset + block_sv.size() == count;
+            if (last) {
+                block_sv = block_sv.substr(0, complete_prefix_size(block_sv, false));
+            }
+            if (transcoded_size<CharT, char32_t>(block_sv, ignored, true, false) != conversion::status_e::success) {
+                return false;
+            }
+            if (last) {
+                break;
+            }
+            offset += block_sv.size();
+        }
+        return true;
+    }
+} // namespace utf
+
+//--------------------------------------------------IMPLEMENTATION--------------------------------------------------//
+#if defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+
+UTFUTILS_DECL utf::detected_encoding utf::detect_encoding(const std::byte* data, const size_t size, const size_t sample_size) {
+    auto starts_with = [data, size](const std::initializer_list<uint8_t> bytes) {
+        size_t index = 0;
+        for (const uint8_t byte : bytes) {
+            if (index >= size || static_cast<uint8_t>(data[index++]) != byte) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto result = [](const encoding_e encoding, const double confidence, const size_t bom_size = 0) {
+        detected_encoding detected;
+        detected.encoding   = encoding;
+        detected.confidence = confidence;
+        detected.bom_size   = bom_size;
+        return detected;
+    };
+
+    // UTF-32LE BOM starts with UTF-16LE one, so it goes first
+    if (starts_with({0xFF, 0xFE, 0x00, 0x00}) && size % 4 == 0) {
+        return result(encoding_e::utf32_le, 1, 4);
+    }
+    if (starts_with({0x00, 0x00, 0xFE, 0xFF})) {
+        return result(encoding_e::utf32_be, 1, 4);
+    }
+    if (starts_with({0xEF, 0xBB, 0xBF})) {
+        return result(encoding_e::utf8, 1, 3);
+    }
+    if (starts_with({0xFF, 0xFE})) {
+        return result(encoding_e::utf16_le, 1, 2);
+    }
+    if (starts_with({0xFE, 0xFF})) {
+        return result(encoding_e::utf16_be, 1, 2);
+    }
+
+    const size_t sample = std::min(size, sample_size);
+    if (sample == 0) {
+        return result(encoding_e::utf8, 1);
+    }
+    const size_t ascii_size = ascii_prefix_size(data, sample);
+    if (ascii_size == sample && std::find(data, data + sample, std::byte{0}) == data + sample) {
+        return result(encoding_e::utf8, 1);
+    }
+
+    size_t zeros[4];
+    count_zero_bytes(data, sample, zeros);
+    const double code_units32 = static_cast<double>(sample / 4);
+    const double code_units16 = static_cast<double>(sample / 2);
+    const size_t even_zeros   = zeros[0] + zeros[2];
+    const size_t odd_zeros    = zeros[1] + zeros[3];
+    const bool   little_endian_host = !host_is_big_endian;
+
+    // UTF-32: the high byte of every code unit is zero
+    if (sample >= 4 && size % 4 == 0) {
+        if (zeros[3] == sample / 4 && is_valid_sample<char32_t>(data, sample, !little_endian_host)) {
+            return result(encoding_e::utf32_le, 0.5 + 0.49 * static_cast<double>(zeros[2]) / code_units32);
+        }
+        if (zeros[0] == sample / 4 && is_valid_sample<char32_t>(data, sample, little_endian_host)) {
+            return result(encoding_e::utf32_be, 0.5 + 0.49 * static_cast<double>(zeros[1]) / code_units32);
+        }
+    }
+
+    // UTF-16: zeros gather in high bytes of ASCII characters
+    if (sample >= 2 && size % 2 == 0 && even_zeros != odd_zeros) {
+        const bool   little_endian = odd_zeros > even_zeros;
+        const double skew          = static_cast<double>(little_endian ? odd_zeros - even_zeros : even_zeros - odd_zeros) / code_units16;
+        if (is_valid_sample<char16_t>(data, sample, little_endian != little_endian_host)) {
+            return result(little_endian ? encoding_e::utf16_le : encoding_e::utf16_be, 0.6 + 0.39 * std::min(skew * 2, 1.0));
+        }
+    }
+
+    // UTF-8: no zeros except for U+0000, multi-byte sequences are unlikely to be valid by chance
+    if (is_valid_sample<char8_t>(data + ascii_size, sample - ascii_size, false)) {
+        const bool has_zeros = even_zeros + odd_zeros != 0;
+        return result(encoding_e::utf8, has_zeros ? 0.6 : 0.99);
+    }
+
+    // UTF-16 without zero bytes, e.g. CJK text: the byte order which validates wins, little-endian if both do
+    if (sample >= 2 && size % 2 == 0) {
+        const bool little_endian_valid = is_valid_sample<char16_t>(data, sample, !little_endian_host);
+        const bool big_endian_valid    = is_valid_sample<char16_t>(data, sample, little_endian_host);
+        if (little_endian_valid != big_endian_valid) {
+            return result(little_endian_valid ? encoding_e::utf16_le : encoding_e::utf16_be, 0.5);
+        }
+        if (little_endian_valid) {
+            return result(encoding_e::utf16_le, 0.3);
+        }
+    }
+    return result(encoding_e::utf8, 0);
+}
+
+#endif // defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+#endif // !defined(UTFUTILS_DETECT_H)
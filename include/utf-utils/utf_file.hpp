@@ -0,0 +1,339 @@
+#if !defined(UTFUTILS_FILE_H)
+#   define UTFUTILS_FILE_H
+
+#include "utf_parallel.hpp"
+
+/**
+ * @file utf_file.hpp
+ * @brief File-to-file conversion through memory mappings.
+ */
+
+#include <filesystem>
+#include <system_error>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Read-only or writable memory mapping of a whole file.
+     * @details
+     * Empty files are never mapped, #data returns @c nullptr for them.
+     */
+    class file_mapping {
+    public:
+        file_mapping() = default;
+        file_mapping(const file_mapping&) = delete;
+        file_mapping& operator=(const file_mapping&) = delete;
+        UTFUTILS_DECL ~file_mapping();
+
+        /**
+         * @brief Maps an existing file for reading.
+         * @param[in] path path to the file.
+         * @param[out] error receives the OS error on failure.
+         * @return @c true on success.
+         */
+        UTFUTILS_DECL bool open_read(const std::filesystem::path& path, std::error_code& error);
+        /**
+         * @brief Creates (or truncates) a file of exactly @p size bytes and maps it for writing.
+         * @details A file which was opened but can't be sized or mapped is removed again, one which can't be opened is left alone.
+         * @param[in] path path to the file.
+         * @param[in] size size of the file in bytes.
+         * @param[out] error receives the OS error on failure.
+         * @return @c true on success.
+         */
+        UTFUTILS_DECL bool create_write(const std::filesystem::path& path, size_t size, std::error_code& error);
+        /**
+         * @brief Unmaps and closes the file. Written pages are left to the OS to flush.
+         * @param[out] error receives the OS error on failure.
+         * @return @c true on success.
+         */
+        UTFUTILS_DECL bool close(std::error_code& error);
+
+        std::byte* data() const {
+            return data_;
+        }
+        size_t size() const {
+            return size_;
+        }
+
+    private:
+#if defined(_WIN32)
+        void* file_    = reinterpret_cast<void*>(static_cast<intptr_t>(-1));
+        void* mapping_ = nullptr;
+#else
+        int   file_    = -1;
+#endif
+        std::byte* data_ = nullptr;
+        size_t     size_ = 0;
+    };
+
+    /**
+     * @brief This function converts a file into another file using memory mappings.
+     *
+     * @param[in] input_path path to the source file.
+     * @param[in] input_encoding encoding of the source file. Generic UTF-16 and UTF-32 are read in host byte order unless
+     * the file starts with a swapped BOM.
+     * @param[in] output_path path to the target file. It is created or truncated.
+     * @param[in] output_encoding encoding of the target file. Generic UTF-16 and UTF-32 are written in host byte order.
+     * @param[out] error receives the OS error if #conversion::status_e::undefined_error is returned because of I/O, cleared otherwise.
+     * @param[in] options conversion options. Large files are converted by #transcode_options::thread_count threads, the BOM
+     * is handled according to #transcode_options::bom_policy.
+     * @return status specified by #conversion::status_e enum.
+     * @remarks
+     * The source file is mapped and validated first, while the exact output length is computed. Only then the target file
+     * is created with that length, mapped, and written directly, so nothing is copied into intermediate buffers and peak
+     * memory is bounded by the page cache rather than by the file sizes. The target file isn't touched if the source
+     * is invalid or if it can't be opened, e.g. because it's a directory, and is removed if writing it fails once it was
+     * opened. Converting a file into itself is rejected with @c std::errc::invalid_argument. A source whose size isn't a multiple of its code unit size is reported as
+     * #conversion::status_e::character_cut_off.
+     */
+    UTFUTILS_DECL conversion::status_e convert_file(const std::filesystem::path& input_path, encoding_e input_encoding,
+                                                    const std::filesystem::path& output_path, encoding_e output_encoding,
+                                                    std::error_code& error, const transcode_options& options);
+    /**
+     * @brief This function converts a file into another file using memory mappings on one thread.
+     * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false. Refer to #conversion::utf8_to_utf16 for details.
+     * @remarks
+     * Refer to the overload taking #transcode_options for details.
+     */
+    UTFUTILS_DECL conversion::status_e convert_file(const std::filesystem::path& input_path, encoding_e input_encoding,
+                                                    const std::filesystem::path& output_path, encoding_e output_encoding,
+                                                    std::error_code& error, bool comply_with_standard = false);
+} // namespace utf
+
+//--------------------------------------------------IMPLEMENTATION--------------------------------------------------//
+#if defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+
+#if defined(_WIN32)
+#   if !defined(NOMINMAX)
+#       define NOMINMAX
+#   endif
+#   if !defined(WIN32_LEAN_AND_MEAN)
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   include <windows.h>
+#else
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+UTFUTILS_DECL utf::file_mapping::~file_mapping() {
+    std::error_code ignored;
+    close(ignored);
+}
+
+#if defined(_WIN32)
+
+UTFUTILS_DECL bool utf::file_mapping::open_read(const std::filesystem::path& path, std::error_code& error) {
+    close(error);
+    file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        error.assign(static_cast<int>(GetLastError()), std::system_category());
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_, &file_size)) {
+        const DWORD last_error = GetLastError();
+        close(error);
+        error.assign(static_cast<int>(last_error), std::system_category());
+        return false;
+    }
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ == 0) {
+        return true;
+    }
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    data_    = mapping_ != nullptr ? static_cast<std::byte*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (data_ == nullptr) {
+        const DWORD last_error = GetLastError();
+        close(error);
+        error.assign(static_cast<int>(last_error), std::system_category());
+        return false;
+    }
+    return true;
+}
+
+UTFUTILS_DECL bool utf::file_mapping::create_write(const std::filesystem::path& path, const size_t size, std::error_code& error) {
+    close(error);
+    file_ = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        error.assign(static_cast<int>(GetLastError()), std::system_category());
+        return false;
+    }
+    size_ = size;
+    if (size_ == 0) {
+        return true;
+    }
+    // mapping a file with a size larger than the file's size extends the file
+    const uint64_t mapping_size = size_;
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, static_cast<DWORD>(mapping_size >> 32), static_cast<DWORD>(mapping_size), nullptr);
+    data_    = mapping_ != nullptr ? static_cast<std::byte*>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0)) : nullptr;
+    if (data_ == nullptr) {
+        const DWORD last_error = GetLastError();
+        close(error);
+        std::filesystem::remove(path, error);
+        error.assign(static_cast<int>(last_error), std::system_category());
+        return false;
+    }
+    return true;
+}
+
+UTFUTILS_DECL bool utf::file_mapping::close(std::error_code& error) {
+    error.clear();
+    if (data_ != nullptr && !UnmapViewOfFile(data_)) {
+        error.assign(static_cast<int>(GetLastError()), std::system_category());
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+    if (file_ != INVALID_HANDLE_VALUE && !CloseHandle(file_) && !error) {
+        error.assign(static_cast<int>(GetLastError()), std::system_category());
+    }
+    file_    = INVALID_HANDLE_VALUE;
+    mapping_ = nullptr;
+    data_    = nullptr;
+    size_    = 0;
+    return !error;
+}
+
+#else // POSIX
+
+UTFUTILS_DECL bool utf::file_mapping::open_read(const std::filesystem::path& path, std::error_code& error) {
+    close(error);
+    file_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_ == -1) {
+        error.assign(errno, std::generic_category());
+        return false;
+    }
+    struct stat file_stat;
+    if (::fstat(file_, &file_stat) == -1) {
+        const int last_error = errno;
+        close(error);
+        error.assign(last_error, std::generic_category());
+        return false;
+    }
+    if (static_cast<uintmax_t>(file_stat.st_size) > SIZE_MAX) {
+        close(error);
+        error = std::make_error_code(std::errc::file_too_large);
+        return false;
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ == 0) {
+        return true;
+    }
+    void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_, 0);
+    if (mapped == MAP_FAILED) {
+        const int last_error = errno;
+        close(error);
+        error.assign(last_error, std::generic_category());
+        return false;
+    }
+    data_ = static_cast<std::byte*>(mapped);
+    ::posix_madvise(mapped, size_, POSIX_MADV_SEQUENTIAL);
+    return true;
+}
+
+UTFUTILS_DECL bool utf::file_mapping::create_write(const std::filesystem::path& path, const size_t size, std::error_code& error) {
+    close(error);
+    file_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (file_ == -1) {
+        error.assign(errno, std::generic_category());
+        return false;
+    }
+    size_ = size;
+    if (size_ == 0) {
+        return true;
+    }
+    void* mapped = MAP_FAILED;
+    if (::ftruncate(file_, static_cast<off_t>(size_)) == 0) {
+        mapped = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, file_, 0);
+    }
+    if (mapped == MAP_FAILED) {
+        const int last_error = errno;
+        close(error);
+        std::filesystem::remove(path, error);
+        error.assign(last_error, std::generic_category());
+        return false;
+    }
+    data_ = static_cast<std::byte*>(mapped);
+    ::posix_madvise(mapped, size_, POSIX_MADV_SEQUENTIAL);
+    return true;
+}
+
+UTFUTILS_DECL bool utf::file_mapping::close(std::error_code& error) {
+    error.clear();
+    if (data_ != nullptr && ::munmap(data_, size_) == -1) {
+        error.assign(errno, std::generic_category());
+    }
+    if (file_ != -1 && ::close(file_) == -1 && !error) {
+        error.assign(errno, std::generic_category());
+    }
+    file_ = -1;
+    data_ = nullptr;
+    size_ = 0;
+    return !error;
+}
+
+#endif // defined(_WIN32)
+
+UTFUTILS_DECL utf::conversion::status_e utf::convert_file(const std::filesystem::path& input_path, const encoding_e input_encoding,
+                                                          const std::filesystem::path& output_path, const encoding_e output_encoding,
+                                                          std::error_code& error, const transcode_options& options) {
+    // the output is truncated while the input is still mapped
+    std::error_code not_found;
+    if (std::filesystem::equivalent(input_path, output_path, not_found)) {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return conversion::status_e::undefined_error;
+    }
+
+    file_mapping input;
+    if (!input.open_read(input_path, error)) {
+        return conversion::status_e::undefined_error;
+    }
+
+    return with_code_unit_type(input_encoding, [&](auto input_code_unit) {
+        using input_char_t = decltype(input_code_unit);
+        if (input.size() % sizeof(input_char_t) != 0) {
+            return conversion::status_e::character_cut_off;
+        }
+        const std::basic_string_view<input_char_t> input_sv(reinterpret_cast<const input_char_t*>(input.data()), input.size() / sizeof(input_char_t));
+        const bool                                 input_reverse = needs_byte_swap(input_encoding, input_sv);
+
+        return with_code_unit_type(output_encoding, [&](auto output_code_unit) {
+            using output_char_t = decltype(output_code_unit);
+            const bool output_reverse = needs_byte_swap(output_encoding, std::basic_string_view<output_char_t>());
+
+            // first pass validates and computes the exact size of the output file, second pass converts straight into its mapping
+            file_mapping               output;
+            const conversion::status_e status = transcode_parallel<input_char_t, output_char_t>(
+                input_sv, input_reverse, output_reverse, options, [&](const size_t output_size) {
+                    return output.create_write(output_path, output_size * sizeof(output_char_t), error) ? reinterpret_cast<output_char_t*>(output.data())
+                                                                                                       : nullptr;
+                });
+            // a target which couldn't be created was removed by create_write or never existed
+            if (status != conversion::status_e::success) {
+                return status;
+            }
+            if (!output.close(error)) {
+                std::error_code ignored;
+                std::filesystem::remove(output_path, ignored);
+                return conversion::status_e::undefined_error;
+            }
+            return conversion::status_e::success;
+        });
+    });
+}
+
+UTFUTILS_DECL utf::conversion::status_e utf::convert_file(const std::filesystem::path& input_path, const encoding_e input_encoding,
+                                                          const std::filesystem::path& output_path, const encoding_e output_encoding,
+                                                          std::error_code& error, const bool comply_with_standard) {
+    transcode_options options;
+    options.comply_with_standard = comply_with_standard;
+    return convert_file(input_path, input_encoding, output_path, output_encoding, error, options);
+}
+
+#endif // defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+#endif // !defined(UTFUTILS_FILE_H)
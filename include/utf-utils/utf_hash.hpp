@@ -0,0 +1,283 @@
+#if !defined(UTFUTILS_HASH_H)
+#   define UTFUTILS_HASH_H
+
+#include "utf_utils.hpp"
+
+/**
+ * @file utf_hash.hpp
+ * @brief Conversions which hash the converted string while writing it, and hashes of text independent of its encoding.
+ */
+
+#include <algorithm>
+#include <type_traits>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Checks if @p Hasher can be fed blocks of code units of type @p CharT.
+     * @details
+     * A hasher is any callable accepting a pointer to a block and its size in code units, e.g. a lambda updating an xxHash
+     * or CRC32C state. It is called with consecutive blocks of the whole string and keeps its state between the calls.
+     */
+    template <typename Hasher, typename CharT>
+    struct is_block_hasher : std::is_invocable<std::remove_reference_t<Hasher>&, const CharT*, size_t> {};
+
+    /**
+     * @brief 64-bit FNV-1a hasher which hashes code units by their values.
+     * @details
+     * Blocks of bytes are hashed exactly like FNV-1a does. Wider code units are hashed one per step as well, so the hash
+     * doesn't depend on the byte order of the host.
+     */
+    struct fnv1a_64 {
+        static constexpr uint64_t offset_basis = 0xCBF29CE484222325; /**< Initial value. */
+        static constexpr uint64_t prime        = 0x00000100000001B3; /**< Multiplier of every step. */
+
+        uint64_t value = offset_basis; /**< Hash of everything fed so far. */
+
+        /**
+         * @brief Feeds a block of code units.
+         */
+        template <typename CharT>
+        constexpr void operator()(const CharT* data, const size_t size) {
+            for (size_t index = 0; index < size; ++index) {
+                value = (value ^ static_cast<std::make_unsigned_t<CharT>>(data[index])) * prime;
+            }
+        }
+    };
+
+    /**
+     * @brief Hashes the code points of a UTF-8 string, so that all encodings of the same text hash the same.
+     *
+     * @param[in] utf8_sv string view that contains the UTF-8 string.
+     * @param[in,out] hasher callable fed with blocks of host order UTF-32 code units, refer to #is_block_hasher.
+     * @param[in] comply_with_standard should decoding comply with Unicode standard. Defaults to @c false.
+     * @return status specified by #conversion::status_e enum. The state of @p hasher is unspecified on failure.
+     * @details
+     * A leading BOM isn't hashed, like it isn't compared by @ref compare_funcs. Nothing is converted into memory, code
+     * points are decoded into a small block on the stack, so the hash of a UTF-8 copy can be compared with the hash of a
+     * UTF-16 copy of the same text without converting either.
+     */
+    template <typename Hasher>
+    conversion::status_e code_point_hash(const std::basic_string_view<char8_t>& utf8_sv, Hasher&& hasher, bool comply_with_standard = false);
+    /**
+     * @brief Hashes the code points of a UTF-16 string in either byte order.
+     * @details Refer to the UTF-8 overload for details.
+     */
+    template <typename Hasher>
+    conversion::status_e code_point_hash(const std::basic_string_view<char16_t>& utf16_sv, Hasher&& hasher, bool comply_with_standard = false);
+    /**
+     * @brief Hashes the code points of a UTF-32 string in either byte order.
+     * @details Refer to the UTF-8 overload for details.
+     */
+    template <typename Hasher>
+    conversion::status_e code_point_hash(const std::basic_string_view<char32_t>& utf32_sv, Hasher&& hasher, bool comply_with_standard = false);
+
+    namespace conversion {
+        /**
+         * @addtogroup hash_funcs Hashing Conversion Functions
+         * Functions used to convert strings and hash the result in the same pass.
+         *
+         * They behave like @ref conv_funcs, but code units are encoded into a small block on the stack first, which is fed
+         * to the hasher and then copied to the sink while it is still in cache. The hasher sees exactly the code units the
+         * sink receives, including a BOM, and isn't called if the source string is invalid.
+         * @{
+         */
+
+        /**
+         * @brief This function converts UTF-8 string to UTF-16 and hashes the result.
+         *
+         * @param[in] utf8_sv string view that contains the UTF-8 string.
+         * @param[out] utf16_sink container or output iterator to write UTF-16 code units to.
+         * @param[in,out] hasher callable fed with blocks of the UTF-16 code units, refer to #is_block_hasher.
+         * @param[in] comply_with_standard should the conversion comply with Unicode standard. Defaults to @c false.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Sink, typename Hasher, typename = std::enable_if_t<is_block_hasher<Hasher, char16_t>::value>>
+        status_e utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf16_sink, Hasher&& hasher,
+                               bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-8 string to UTF-32 and hashes the result.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink, typename Hasher, typename = std::enable_if_t<is_block_hasher<Hasher, char32_t>::value>>
+        status_e utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf32_sink, Hasher&& hasher,
+                               bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-16 string to UTF-8 and hashes the result.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink, typename Hasher, typename = std::enable_if_t<is_block_hasher<Hasher, char8_t>::value>>
+        status_e utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf8_sink, Hasher&& hasher,
+                               bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-16 string to UTF-32 and hashes the result.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink, typename Hasher, typename = std::enable_if_t<is_block_hasher<Hasher, char32_t>::value>>
+        status_e utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf32_sink, Hasher&& hasher,
+                                bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-32 string to UTF-8 and hashes the result.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink, typename Hasher, typename = std::enable_if_t<is_block_hasher<Hasher, char8_t>::value>>
+        status_e utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf8_sink, Hasher&& hasher,
+                               bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-32 string to UTF-16 and hashes the result.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink, typename Hasher, typename = std::enable_if_t<is_block_hasher<Hasher, char16_t>::value>>
+        status_e utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf16_sink, Hasher&& hasher,
+                                bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+
+        /**
+         * @}
+         */
+    } // namespace conversion
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Number of code units hashed at once, small enough for the block to stay in L1 cache.
+     */
+    constexpr size_t hash_block_size = 1024;
+
+    /**
+     * @internal
+     * @brief Converts a string which was already validated by #transcoded_size, feeding every block to the hasher before copying it out.
+     * @param input source string, after the BOM policy was applied.
+     * @param out output iterator to write target code units to.
+     * @param reverse the source string has the opposite byte order.
+     * @param add_bom should a BOM be written first.
+     * @param hasher the hasher.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename InputCharT, typename OutputCharT, typename OutputIt, typename Hasher>
+    OutputIt transcode_validated_hashed(const std::basic_string_view<InputCharT>& input, OutputIt out, const bool reverse, const bool add_bom, Hasher& hasher) {
+        const InputCharT* it  = input.data();
+        const InputCharT* end = it + input.size();
+
+        OutputCharT  block[hash_block_size];
+        OutputCharT* block_end = block;
+        if (add_bom) {
+            block_end = encoding_traits<OutputCharT>::encode(constants::byte_order_mark, block_end);
+        }
+        while (it != end) {
+            // room for the longest encoding of a code point
+            if (block + hash_block_size - block_end < 4) {
+                hasher(static_cast<const OutputCharT*>(block), static_cast<size_t>(block_end - block));
+                out       = std::copy(block, block_end, out);
+                block_end = block;
+            }
+            char32_t code_point = 0;
+            encoding_traits<InputCharT>::decode(it, end, code_point, false, reverse);
+            block_end = encoding_traits<OutputCharT>::encode(code_point, block_end);
+        }
+        if (block_end != block) {
+            hasher(static_cast<const OutputCharT*>(block), static_cast<size_t>(block_end - block));
+            out = std::copy(block, block_end, out);
+        }
+        return out;
+    }
+
+    /**
+     * @internal
+     * @brief Converts a string, writes the result into a sink and hashes it. Refer to #transcode for details.
+     */
+    template <typename InputCharT, typename OutputCharT, typename Sink, typename Hasher>
+    conversion::status_e transcode_hashed(const std::basic_string_view<InputCharT>& input, Sink&& sink, Hasher& hasher,
+                                          const bool comply_with_standard, const bom_e bom_policy) {
+        return transcode<InputCharT, OutputCharT>(
+            input, std::forward<Sink>(sink), comply_with_standard, bom_policy,
+            [&hasher](const std::basic_string_view<InputCharT>& body, auto output, const bool reverse, const bool add_bom) {
+                transcode_validated_hashed<InputCharT, OutputCharT>(body, output, reverse, add_bom, hasher);
+            });
+    }
+
+    /**
+     * @internal
+     * @brief Decodes a string and feeds its code points to the hasher in blocks. Refer to #code_point_hash for details.
+     */
+    template <typename InputCharT, typename Hasher>
+    conversion::status_e hash_code_points(const std::basic_string_view<InputCharT>& input, Hasher& hasher, const bool comply_with_standard) {
+        const bool        reverse = encoding_traits<InputCharT>::is_reversed(input);
+        const InputCharT* it      = input.data() + bom_size(input, reverse);
+        const InputCharT* end     = input.data() + input.size();
+
+        char32_t block[hash_block_size];
+        size_t   block_size = 0;
+        while (it != end) {
+            const conversion::status_e status = encoding_traits<InputCharT>::decode(it, end, block[block_size], comply_with_standard, reverse);
+            if (status != conversion::status_e::success) {
+                return status;
+            }
+            if (++block_size == hash_block_size) {
+                hasher(static_cast<const char32_t*>(block), block_size);
+                block_size = 0;
+            }
+        }
+        if (block_size != 0) {
+            hasher(static_cast<const char32_t*>(block), block_size);
+        }
+        return conversion::status_e::success;
+    }
+} // namespace utf
+
+template <typename Hasher>
+utf::conversion::status_e utf::code_point_hash(const std::basic_string_view<char8_t>& utf8_sv, Hasher&& hasher, bool comply_with_standard) {
+    return hash_code_points(utf8_sv, hasher, comply_with_standard);
+}
+
+template <typename Hasher>
+utf::conversion::status_e utf::code_point_hash(const std::basic_string_view<char16_t>& utf16_sv, Hasher&& hasher, bool comply_with_standard) {
+    return hash_code_points(utf16_sv, hasher, comply_with_standard);
+}
+
+template <typename Hasher>
+utf::conversion::status_e utf::code_point_hash(const std::basic_string_view<char32_t>& utf32_sv, Hasher&& hasher, bool comply_with_standard) {
+    return hash_code_points(utf32_sv, hasher, comply_with_standard);
+}
+
+template <typename Sink, typename Hasher, typename>
+utf::conversion::status_e utf::conversion::utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf16_sink, Hasher&& hasher,
+                                                         bool comply_with_standard, bom_e bom_policy) {
+    return transcode_hashed<char8_t, char16_t>(utf8_sv, std::forward<Sink>(utf16_sink), hasher, comply_with_standard, bom_policy);
+}
+
+template <typename Sink, typename Hasher, typename>
+utf::conversion::status_e utf::conversion::utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf32_sink, Hasher&& hasher,
+                                                         bool comply_with_standard, bom_e bom_policy) {
+    return transcode_hashed<char8_t, char32_t>(utf8_sv, std::forward<Sink>(utf32_sink), hasher, comply_with_standard, bom_policy);
+}
+
+template <typename Sink, typename Hasher, typename>
+utf::conversion::status_e utf::conversion::utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf8_sink, Hasher&& hasher,
+                                                         bool comply_with_standard, bom_e bom_policy) {
+    return transcode_hashed<char16_t, char8_t>(utf16_sv, std::forward<Sink>(utf8_sink), hasher, comply_with_standard, bom_policy);
+}
+
+template <typename Sink, typename Hasher, typename>
+utf::conversion::status_e utf::conversion::utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf32_sink, Hasher&& hasher,
+                                                          bool comply_with_standard, bom_e bom_policy) {
+    return transcode_hashed<char16_t, char32_t>(utf16_sv, std::forward<Sink>(utf32_sink), hasher, comply_with_standard, bom_policy);
+}
+
+template <typename Sink, typename Hasher, typename>
+utf::conversion::status_e utf::conversion::utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf8_sink, Hasher&& hasher,
+                                                         bool comply_with_standard, bom_e bom_policy) {
+    return transcode_hashed<char32_t, char8_t>(utf32_sv, std::forward<Sink>(utf8_sink), hasher, comply_with_standard, bom_policy);
+}
+
+template <typename Sink, typename Hasher, typename>
+utf::conversion::status_e utf::conversion::utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf16_sink, Hasher&& hasher,
+                                                          bool comply_with_standard, bom_e bom_policy) {
+    return transcode_hashed<char32_t, char16_t>(utf32_sv, std::forward<Sink>(utf16_sink), hasher, comply_with_standard, bom_policy);
+}
+
+#endif // !defined(UTFUTILS_HASH_H)
@@ -0,0 +1,277 @@
+#if !defined(UTFUTILS_INCREMENTAL_H)
+#   define UTFUTILS_INCREMENTAL_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_incremental.hpp
+ * @brief Incremental conversion of edits of a UTF-8 document into edits of its UTF-16 copy.
+ */
+
+#include <algorithm>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Edit of a UTF-16 string: @c removed_size code units at @c offset are replaced by @c inserted.
+     */
+    struct utf16_edit {
+        size_t         offset       = 0; /**< Offset of the first replaced code unit. */
+        size_t         removed_size = 0; /**< Number of replaced code units. */
+        std::u16string inserted;         /**< Code units replacing them. */
+    };
+
+    /**
+     * @brief Sparse map between byte offsets of a UTF-8 document and offsets of its UTF-16 copy, kept up to date across edits.
+     * @details
+     * Stores pairs of offsets of the same character about every @c stride bytes. An offset is translated by a vectorized
+     * scan from the nearest pair, i.e. of at most @c stride bytes of the document. Edits keep the spacing: the span between
+     * the pairs around an edit is split again once it grows past @c stride, so a long series of small edits at one place
+     * doesn't make the scans longer. The map doesn't keep the document, it is passed to every call instead and must be
+     * the one the map was built for or last updated to.
+     */
+    class utf16_offset_map {
+    public:
+        /**
+         * @brief Default number of bytes between stored pairs of offsets.
+         */
+        static constexpr size_t default_stride = 4096;
+
+        utf16_offset_map() = default;
+        /**
+         * @brief Builds the map.
+         * @param[in] utf8_sv the document, valid UTF-8.
+         * @param[in] stride number of bytes between stored pairs, treated as @c 16 if smaller. Defaults to #default_stride.
+         */
+        inline explicit utf16_offset_map(const std::basic_string_view<char8_t>& utf8_sv, size_t stride = default_stride);
+
+        /**
+         * @brief Returns number of bytes between stored pairs.
+         */
+        size_t stride() const {
+            return stride_;
+        }
+        /**
+         * @brief Returns size of the document in bytes.
+         */
+        size_t utf8_size() const {
+            return utf8_size_;
+        }
+        /**
+         * @brief Returns size of the UTF-16 copy in code units.
+         */
+        size_t utf16_size() const {
+            return utf16_size_;
+        }
+        /**
+         * @brief Translates a byte offset of a character into the offset of the character in the UTF-16 copy.
+         * @param[in] utf8_sv the document.
+         * @param[in] byte_offset offset of a leading byte or the size of the document.
+         */
+        inline size_t utf16_offset_of(const std::basic_string_view<char8_t>& utf8_sv, size_t byte_offset) const;
+        /**
+         * @brief Translates an offset in the UTF-16 copy into the byte offset of the character.
+         * @param[in] utf8_sv the document.
+         * @param[in] utf16_offset offset of a code unit, the low surrogate of a pair means the start of the pair.
+         */
+        inline size_t byte_offset_of(const std::basic_string_view<char8_t>& utf8_sv, size_t utf16_offset) const;
+
+        /**
+         * @internal
+         * @brief Pair of offsets of the same character.
+         */
+        struct checkpoint {
+            size_t utf8;
+            size_t utf16;
+        };
+
+        /**
+         * @internal
+         * @brief Returns the stored pairs, ordered by offset, the first one at the start of the document.
+         */
+        const std::vector<checkpoint>& checkpoints() const {
+            return checkpoints_;
+        }
+
+        /**
+         * @internal
+         * @brief Updates the map after whole characters were replaced.
+         * @param utf8_sv the document before the edit.
+         * @param edit_start offset of the first replaced byte.
+         * @param removed_size number of replaced bytes.
+         * @param removed_utf16_size number of UTF-16 code units they take.
+         * @param inserted bytes replacing them.
+         * @param inserted_utf16_size number of UTF-16 code units those take.
+         * @details
+         * Pairs before the edit stay and pairs after it are shifted. Pairs within it, or at its start, are dropped, and the span
+         * from the last pair before the edit to the first one after it is split again, from the edited text, if it is longer
+         * than a stride.
+         */
+        inline void update(const std::basic_string_view<char8_t>& utf8_sv, size_t edit_start, size_t removed_size, size_t removed_utf16_size,
+                           const std::basic_string_view<char8_t>& inserted, size_t inserted_utf16_size);
+
+    private:
+        size_t                  stride_     = default_stride;
+        size_t                  utf8_size_  = 0;
+        size_t                  utf16_size_ = 0;
+        std::vector<checkpoint> checkpoints_ = {checkpoint{0, 0}};
+    };
+
+    namespace conversion {
+        /**
+         * @brief This function converts an edit of a UTF-8 document into the edit of its UTF-16 copy.
+         *
+         * @param[in] utf8_sv the document before the edit, valid UTF-8.
+         * @param[in,out] offset_map map built for the document, updated to the edited document on success.
+         * @param[in] byte_offset offset of the first replaced byte.
+         * @param[in] removed_size number of replaced bytes.
+         * @param[in] inserted UTF-8 bytes replacing them.
+         * @param[out] utf16_edit receives the edit of the UTF-16 copy.
+         * @param[in] comply_with_standard should the conversion comply with Unicode standard. Defaults to @c false. Refer to #utf8_to_utf16 for details.
+         * @return status specified by #status_e enum, #status_e::undefined_error if the replaced range is out of the document.
+         * @details
+         * Only the edited characters are converted: an edit which starts or ends inside a character is widened to whole
+         * characters, and the widened span is validated and converted. Finding the UTF-16 offset of the edit and splitting the
+         * span around it again scan at most a few strides, so the latency grows with the size of the edit, not of the document
+         * or the number of earlier edits; only shifting the stored offsets after the edit touches one pair per stride bytes.
+         * The document, the map and the UTF-16 copy are left unchanged on failure. Apply the UTF-8 edit to the document and
+         * @p utf16_edit to the copy afterwards.
+         */
+        inline status_e utf8_edit_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, utf16_offset_map& offset_map, size_t byte_offset, size_t removed_size,
+                                           const std::basic_string_view<char8_t>& inserted, utf16_edit& utf16_edit, bool comply_with_standard = false);
+    } // namespace conversion
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Checks if the byte is a UTF-8 trailing byte.
+     */
+    constexpr bool is_trailing_byte(const char8_t code_unit) {
+        return static_cast<uint8_t>(code_unit) >> 6 == constants::trailing_byte_marker;
+    }
+
+    /**
+     * @internal
+     * @brief Appends pairs of offsets about every @p stride bytes of a UTF-8 text.
+     * @param text the text.
+     * @param start offsets of the start of the text.
+     * @param stride number of bytes between pairs.
+     * @param[out] checkpoints receives the pairs, none for the start of the text.
+     */
+    inline void append_checkpoints(const std::basic_string_view<char8_t>& text, const utf16_offset_map::checkpoint start, const size_t stride,
+                                   std::vector<utf16_offset_map::checkpoint>& checkpoints) {
+        const std::byte*             bytes    = reinterpret_cast<const std::byte*>(text.data());
+        utf16_offset_map::checkpoint current  = start;
+        size_t                       position = 0;
+        for (size_t next = stride; next < text.size(); next = position + stride) {
+            // pairs are at leading bytes
+            while (next < text.size() && is_trailing_byte(text[next])) {
+                ++next;
+            }
+            if (next == text.size()) {
+                break;
+            }
+            current.utf8  += next - position;
+            current.utf16 += count_utf16_code_units(bytes + position, next - position);
+            position = next;
+            checkpoints.push_back(current);
+        }
+    }
+} // namespace utf
+
+inline utf::utf16_offset_map::utf16_offset_map(const std::basic_string_view<char8_t>& utf8_sv, const size_t stride)
+    : stride_(std::max<size_t>(stride, 16)), utf8_size_(utf8_sv.size()),
+      utf16_size_(count_utf16_code_units(reinterpret_cast<const std::byte*>(utf8_sv.data()), utf8_sv.size())) {
+    append_checkpoints(utf8_sv, checkpoint{0, 0}, stride_, checkpoints_);
+}
+
+inline size_t utf::utf16_offset_map::utf16_offset_of(const std::basic_string_view<char8_t>& utf8_sv, const size_t byte_offset) const {
+    const checkpoint& nearest = *(std::upper_bound(checkpoints_.begin(), checkpoints_.end(), byte_offset,
+                                                   [](const size_t offset, const checkpoint& pair) { return offset < pair.utf8; }) - 1);
+    return nearest.utf16 + count_utf16_code_units(reinterpret_cast<const std::byte*>(utf8_sv.data()) + nearest.utf8, byte_offset - nearest.utf8);
+}
+
+inline size_t utf::utf16_offset_map::byte_offset_of(const std::basic_string_view<char8_t>& utf8_sv, const size_t utf16_offset) const {
+    const checkpoint& nearest = *(std::upper_bound(checkpoints_.begin(), checkpoints_.end(), utf16_offset,
+                                                   [](const size_t offset, const checkpoint& pair) { return offset < pair.utf16; }) - 1);
+    return nearest.utf8 + skip_utf16_code_units(reinterpret_cast<const std::byte*>(utf8_sv.data()) + nearest.utf8, utf8_sv.size() - nearest.utf8,
+                                                utf16_offset - nearest.utf16);
+}
+
+inline void utf::utf16_offset_map::update(const std::basic_string_view<char8_t>& utf8_sv, const size_t edit_start, const size_t removed_size,
+                                          const size_t removed_utf16_size, const std::basic_string_view<char8_t>& inserted, const size_t inserted_utf16_size) {
+    // pairs within the replaced range are dropped, also one at its start as it may end up at the end of the document;
+    // only the pair at the start of the document always stays
+    const size_t     edit_end = edit_start + removed_size;
+    const auto       first    = std::lower_bound(checkpoints_.begin() + 1, checkpoints_.end(), edit_start,
+                                                 [](const checkpoint& pair, const size_t offset) { return pair.utf8 < offset; });
+    const checkpoint previous = *(first - 1);
+    auto             last     = std::lower_bound(first, checkpoints_.end(), edit_end,
+                                                 [](const checkpoint& pair, const size_t offset) { return pair.utf8 < offset; });
+    // removing the start of the document would shift the next pair onto the first one
+    if (edit_start == 0 && inserted.empty() && last != checkpoints_.end() && last->utf8 == edit_end) {
+        ++last;
+    }
+    const size_t next  = last != checkpoints_.end() ? last->utf8 : utf8_sv.size();
+    const auto   index = first - checkpoints_.begin();
+    checkpoints_.erase(first, last);
+    for (auto pair = checkpoints_.begin() + index; pair != checkpoints_.end(); ++pair) {
+        pair->utf8  = pair->utf8 - removed_size + inserted.size();
+        pair->utf16 = pair->utf16 - removed_utf16_size + inserted_utf16_size;
+    }
+
+    // the span between the pairs around the edit is split like a fresh map would be, or small edits would widen it forever
+    if (next - previous.utf8 - removed_size + inserted.size() > stride_) {
+        std::basic_string<char8_t> span;
+        span.reserve(next - previous.utf8 - removed_size + inserted.size());
+        span.append(utf8_sv.substr(previous.utf8, edit_start - previous.utf8)).append(inserted).append(utf8_sv.substr(edit_end, next - edit_end));
+        std::vector<checkpoint> replacement;
+        append_checkpoints(span, previous, stride_, replacement);
+        checkpoints_.insert(checkpoints_.begin() + index, replacement.begin(), replacement.end());
+    }
+
+    utf8_size_  = utf8_size_ - removed_size + inserted.size();
+    utf16_size_ = utf16_size_ - removed_utf16_size + inserted_utf16_size;
+}
+
+inline utf::conversion::status_e utf::conversion::utf8_edit_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, utf16_offset_map& offset_map,
+                                                                    const size_t byte_offset, const size_t removed_size,
+                                                                    const std::basic_string_view<char8_t>& inserted, utf16_edit& utf16_edit,
+                                                                    const bool comply_with_standard) {
+    if (byte_offset > utf8_sv.size() || removed_size > utf8_sv.size() - byte_offset) {
+        utf16_edit = {};
+        return status_e::undefined_error;
+    }
+    // widen the edit to whole characters, at most three trailing bytes on each side
+    size_t start = byte_offset;
+    for (size_t step = 0; step < 3 && start != 0 && start != utf8_sv.size() && is_trailing_byte(utf8_sv[start]); ++step) {
+        --start;
+    }
+    size_t end = byte_offset + removed_size;
+    for (size_t step = 0; step < 3 && end != utf8_sv.size() && is_trailing_byte(utf8_sv[end]); ++step) {
+        ++end;
+    }
+    std::basic_string<char8_t>      widened;
+    std::basic_string_view<char8_t> span = inserted;
+    if (start != byte_offset || end != byte_offset + removed_size) {
+        widened.reserve(byte_offset - start + inserted.size() + end - byte_offset - removed_size);
+        widened.append(utf8_sv.substr(start, byte_offset - start)).append(inserted).append(utf8_sv.substr(byte_offset + removed_size, end - byte_offset - removed_size));
+        span = widened;
+    }
+
+    const status_e status = utf8_to_utf16(span, utf16_edit.inserted, comply_with_standard);
+    if (status != status_e::success) {
+        utf16_edit = {};
+        return status;
+    }
+    utf16_edit.offset       = offset_map.utf16_offset_of(utf8_sv, start);
+    utf16_edit.removed_size = count_utf16_code_units(reinterpret_cast<const std::byte*>(utf8_sv.data()) + start, end - start);
+    offset_map.update(utf8_sv, start, end - start, utf16_edit.removed_size, span, utf16_edit.inserted.size());
+    return status_e::success;
+}
+
+#endif // !defined(UTFUTILS_INCREMENTAL_H)
@@ -0,0 +1,114 @@
+#if !defined(UTFUTILS_INDEX_H)
+#   define UTFUTILS_INDEX_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_index.hpp
+ * @brief Random access to code points of UTF-8 text.
+ */
+
+#include <algorithm>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Sparse table of byte offsets of every K-th code point of a UTF-8 text.
+     * @details
+     * The index refers to the text it was built for, which must outlive it and stay unchanged. It is built with one vectorized
+     * counting pass, takes one offset per @c stride code points, and answers both queries by scanning at most @c stride code
+     * points from the nearest checkpoint, whole vectors at a time.
+     *
+     * Code points are counted as bytes which aren't trailing ones (@c 0x80-0xBF), which is exact for valid UTF-8, so validate
+     * the text first if it comes from an untrusted source.
+     */
+    class utf8_index {
+    public:
+        /**
+         * @brief Default number of code points between checkpoints.
+         */
+        static constexpr size_t default_stride = 1024;
+
+        utf8_index() = default;
+        /**
+         * @brief Builds the index.
+         * @param[in] utf8_sv the text.
+         * @param[in] stride number of code points between checkpoints, treated as @c 1 if zero. Defaults to #default_stride.
+         */
+        inline explicit utf8_index(const std::basic_string_view<char8_t>& utf8_sv, size_t stride = default_stride);
+
+        /**
+         * @brief Returns number of code points of the text.
+         */
+        size_t size() const {
+            return size_;
+        }
+        /**
+         * @brief Returns number of code points between checkpoints.
+         */
+        size_t stride() const {
+            return stride_;
+        }
+        /**
+         * @brief Returns the text the index was built for.
+         */
+        std::basic_string_view<char8_t> text() const {
+            return text_;
+        }
+
+        /**
+         * @brief Finds the byte offset of a code point.
+         * @param[in] code_point_index index of the code point.
+         * @return Offset of its leading byte, the size of the text if @p code_point_index isn't less than #size.
+         */
+        inline size_t byte_offset_of(size_t code_point_index) const;
+        /**
+         * @brief Finds the code point a byte belongs to.
+         * @param[in] byte_offset offset of any byte of the code point.
+         * @return Index of the code point, #size if @p byte_offset isn't less than the size of the text.
+         */
+        inline size_t code_point_index_of(size_t byte_offset) const;
+
+    private:
+        std::basic_string_view<char8_t> text_;
+        size_t                          stride_ = default_stride;
+        size_t                          size_   = 0;
+        std::vector<size_t>             checkpoints_; /**< Byte offsets of code points @c 0, @c stride, @c 2*stride... */
+    };
+} // namespace utf
+
+inline utf::utf8_index::utf8_index(const std::basic_string_view<char8_t>& utf8_sv, const size_t stride)
+    : text_(utf8_sv), stride_(std::max<size_t>(stride, 1)) {
+    const std::byte* bytes = reinterpret_cast<const std::byte*>(text_.data());
+    size_   = count_leading_bytes(bytes, text_.size());
+    checkpoints_.reserve(size_ / stride_ + 1);
+
+    size_t offset = 0;
+    for (size_t code_point = 0; code_point < size_; code_point += stride_) {
+        checkpoints_.push_back(offset);
+        offset += skip_code_points(bytes + offset, text_.size() - offset, stride_);
+    }
+}
+
+inline size_t utf::utf8_index::byte_offset_of(const size_t code_point_index) const {
+    if (code_point_index >= size_) {
+        return text_.size();
+    }
+    const size_t start = checkpoints_[code_point_index / stride_];
+    return start + skip_code_points(reinterpret_cast<const std::byte*>(text_.data()) + start, text_.size() - start, code_point_index % stride_);
+}
+
+inline size_t utf::utf8_index::code_point_index_of(const size_t byte_offset) const {
+    if (byte_offset >= text_.size() || size_ == 0) {
+        return size_;
+    }
+    // the last checkpoint at or before the byte
+    const size_t checkpoint = static_cast<size_t>(std::upper_bound(checkpoints_.begin(), checkpoints_.end(), byte_offset) - checkpoints_.begin()) - 1;
+    const size_t start      = checkpoints_[checkpoint];
+    const size_t leading    = count_leading_bytes(reinterpret_cast<const std::byte*>(text_.data()) + start, byte_offset + 1 - start);
+    // stray trailing bytes at the start of invalid text belong to the first code point
+    return checkpoint * stride_ + (leading != 0 ? leading - 1 : 0);
+}
+
+#endif // !defined(UTFUTILS_INDEX_H)
@@ -0,0 +1,572 @@
+#if !defined(UTFUTILS_LATIN1_H)
+#   define UTFUTILS_LATIN1_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_latin1.hpp
+ * @brief Conversions between Latin-1 (ISO-8859-1) and Unicode encodings.
+ */
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    namespace conversion {
+        /**
+         * @addtogroup latin1_funcs Latin-1 Conversion Functions
+         * Functions used to convert between Latin-1 and Unicode encodings.
+         *
+         * Latin-1 code units are @c char and are equal to the first 256 code points, so every Latin-1 string converts to
+         * Unicode, while Unicode strings convert to Latin-1 only if all their code points are below @c U+0100; otherwise
+         * #status_e::unrepresentable_character is returned. Latin-1 has no BOM: none is written, and one at the start of a
+         * Unicode source is dropped. UTF-16 and UTF-32 are written in host byte order, their byte order as a source is guessed
+         * from the BOM.
+         *
+         * Sinks are the same as for @ref conv_funcs. With a container or a raw pointer the kernels are vectorized: Latin-1 is
+         * widened to UTF-16 and UTF-32 and narrowed back with unpacks and packs, and expanded to UTF-8 eight characters at
+         * a time with a shuffle table (SSSE3). ASCII runs of UTF-8 are copied as they are. Other output iterators get the same
+         * result one code unit at a time.
+         * @{
+         */
+
+        /**
+         * @brief This function converts Latin-1 string to UTF-8 string.
+         *
+         * @param[in] latin1_sv Latin-1 string.
+         * @param[out] utf8_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return #status_e::success, every Latin-1 string is valid.
+         */
+        template <typename Sink>
+        status_e latin1_to_utf8(const std::string_view& latin1_sv, Sink&& utf8_sink);
+        /**
+         * @brief This function converts Latin-1 string to UTF-16 string.
+         *
+         * @param[in] latin1_sv Latin-1 string.
+         * @param[out] utf16_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return #status_e::success, every Latin-1 string is valid.
+         */
+        template <typename Sink>
+        status_e latin1_to_utf16(const std::string_view& latin1_sv, Sink&& utf16_sink);
+        /**
+         * @brief This function converts Latin-1 string to UTF-32 string.
+         *
+         * @param[in] latin1_sv Latin-1 string.
+         * @param[out] utf32_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return #status_e::success, every Latin-1 string is valid.
+         */
+        template <typename Sink>
+        status_e latin1_to_utf32(const std::string_view& latin1_sv, Sink&& utf32_sink);
+        /**
+         * @brief This function converts UTF-8 string to Latin-1 string.
+         *
+         * @param[in] utf8_sv UTF-8 string.
+         * @param[out] latin1_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @param[in] comply_with_standard reject overlong sequences. Defaults to @c false.
+         * @return status specified by #status_e enum, #status_e::unrepresentable_character for code points above @c U+00FF.
+         */
+        template <typename Sink>
+        status_e utf8_to_latin1(const std::basic_string_view<char8_t>& utf8_sv, Sink&& latin1_sink, bool comply_with_standard = false);
+        /**
+         * @brief This function converts UTF-16 string to Latin-1 string.
+         *
+         * @param[in] utf16_sv UTF-16 string.
+         * @param[out] latin1_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return #status_e::success or #status_e::unrepresentable_character for code points above @c U+00FF, surrogates included.
+         */
+        template <typename Sink>
+        status_e utf16_to_latin1(const std::basic_string_view<char16_t>& utf16_sv, Sink&& latin1_sink);
+        /**
+         * @brief This function converts UTF-32 string to Latin-1 string.
+         *
+         * @param[in] utf32_sv UTF-32 string.
+         * @param[out] latin1_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
+         * @return status specified by #status_e enum, #status_e::unrepresentable_character for code points above @c U+00FF.
+         */
+        template <typename Sink>
+        status_e utf32_to_latin1(const std::basic_string_view<char32_t>& utf32_sv, Sink&& latin1_sink);
+
+        /**
+         * @}
+         */
+    } // namespace conversion
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+#if defined(UTFUTILS_SSSE3)
+    /**
+     * @internal
+     * @brief Shuffles compacting eight two-byte UTF-8 slots into the encoded characters.
+     * @details
+     * Indexed by the mask of non-ASCII characters: an ASCII character keeps the first byte of its slot, any other keeps both.
+     */
+    struct latin1_expansion_table {
+        uint8_t shuffle[256][16];
+        uint8_t size[256];
+    };
+
+    constexpr latin1_expansion_table make_latin1_expansion_table() {
+        latin1_expansion_table table {};
+        for (unsigned mask = 0; mask < 256; ++mask) {
+            unsigned size = 0;
+            for (unsigned lane = 0; lane < 8; ++lane) {
+                table.shuffle[mask][size++] = static_cast<uint8_t>(lane * 2);
+                if ((mask >> lane & 1) != 0) {
+                    table.shuffle[mask][size++] = static_cast<uint8_t>(lane * 2 + 1);
+                }
+            }
+            table.size[mask] = static_cast<uint8_t>(size);
+            for (; size < 16; ++size) {
+                table.shuffle[mask][size] = 0x80;
+            }
+        }
+        return table;
+    }
+
+    /**
+     * @internal
+     * @brief The table of #latin1_expansion_table shuffles.
+     */
+    inline constexpr latin1_expansion_table latin1_expansion = make_latin1_expansion_table();
+#endif
+
+    /**
+     * @internal
+     * @brief Counts bytes with the high bit set, i.e. Latin-1 characters which take two UTF-8 code units.
+     */
+    inline size_t count_non_ascii(const char* data, const size_t size) {
+        size_t result = 0;
+        size_t index  = 0;
+#if defined(UTFUTILS_SSE2)
+        // byte-sized counters are summed before they overflow
+        while (index + 16 <= size) {
+            const size_t blocks      = std::min<size_t>((size - index) / 16, 255);
+            __m128i      accumulator = _mm_setzero_si128();
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+                accumulator = _mm_sub_epi8(accumulator, _mm_cmplt_epi8(bytes, _mm_setzero_si128()));
+            }
+            const __m128i sums = _mm_sad_epu8(accumulator, _mm_setzero_si128());
+            result += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+        }
+#elif defined(UTFUTILS_NEON)
+        while (index + 16 <= size) {
+            const size_t blocks      = std::min<size_t>((size - index) / 16, 255);
+            uint8x16_t   accumulator = vdupq_n_u8(0);
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                accumulator = vaddq_u8(accumulator, vshrq_n_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + index)), 7));
+            }
+            result += vaddlvq_u8(accumulator);
+        }
+#endif
+        for (; index < size; ++index) {
+            result += static_cast<uint8_t>(data[index]) >> 7;
+        }
+        return result;
+    }
+
+    /**
+     * @internal
+     * @brief Converts Latin-1 to UTF-16 or UTF-32 by zero-extending every byte.
+     * @tparam OutputCharT target code unit type, @c char16_t or @c char32_t.
+     * @param input Latin-1 string.
+     * @param size number of characters.
+     * @param out output iterator, pointers get the vectorized kernel.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename OutputCharT, typename OutputIt>
+    OutputIt widen_latin1(const char* input, const size_t size, OutputIt out) {
+        size_t index = 0;
+        if constexpr (std::is_pointer_v<OutputIt>) {
+            static_assert(sizeof(*out) == sizeof(OutputCharT), "Output must have the size of the target code unit");
+#if defined(UTFUTILS_AVX2)
+            for (; index + 16 <= size; index += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + index));
+                if constexpr (sizeof(OutputCharT) == 2) {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtepu8_epi16(bytes));
+                } else {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtepu8_epi32(bytes));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+                }
+                out += 16;
+            }
+#elif defined(UTFUTILS_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            for (; index + 16 <= size; index += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + index));
+                const __m128i low   = _mm_unpacklo_epi8(bytes, zero);
+                const __m128i high  = _mm_unpackhi_epi8(bytes, zero);
+                if constexpr (sizeof(OutputCharT) == 2) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), low);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), high);
+                } else {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(high, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(high, zero));
+                }
+                out += 16;
+            }
+#elif defined(UTFUTILS_NEON)
+            for (; index + 16 <= size; index += 16) {
+                const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(input + index));
+                const uint16x8_t low   = vmovl_u8(vget_low_u8(bytes));
+                const uint16x8_t high  = vmovl_u8(vget_high_u8(bytes));
+                if constexpr (sizeof(OutputCharT) == 2) {
+                    vst1q_u16(reinterpret_cast<uint16_t*>(out), low);
+                    vst1q_u16(reinterpret_cast<uint16_t*>(out + 8), high);
+                } else {
+                    vst1q_u32(reinterpret_cast<uint32_t*>(out), vmovl_u16(vget_low_u16(low)));
+                    vst1q_u32(reinterpret_cast<uint32_t*>(out + 4), vmovl_u16(vget_high_u16(low)));
+                    vst1q_u32(reinterpret_cast<uint32_t*>(out + 8), vmovl_u16(vget_low_u16(high)));
+                    vst1q_u32(reinterpret_cast<uint32_t*>(out + 12), vmovl_u16(vget_high_u16(high)));
+                }
+                out += 16;
+            }
+#endif
+        }
+        for (; index < size; ++index) {
+            *out = static_cast<OutputCharT>(static_cast<uint8_t>(input[index]));
+            ++out;
+        }
+        return out;
+    }
+
+    /**
+     * @internal
+     * @brief Converts Latin-1 to UTF-8.
+     * @param input Latin-1 string.
+     * @param size number of characters.
+     * @param out output iterator, pointers get the vectorized kernel.
+     * @param output_size number of UTF-8 code units the string takes, the vectorized kernel never writes past them.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename OutputIt>
+    OutputIt expand_latin1(const char* input, const size_t size, OutputIt out, const size_t output_size) {
+        size_t index = 0;
+        if constexpr (std::is_pointer_v<OutputIt>) {
+            static_assert(sizeof(*out) == 1, "Output must have the size of the target code unit");
+            const auto output_end = out + output_size;
+#if defined(UTFUTILS_SSSE3)
+            // a block expands to at most 32 bytes, every half is stored as a whole 16-byte vector
+            const __m128i zero = _mm_setzero_si128();
+            for (; index + 16 <= size && output_end - out >= 32; index += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + index));
+                const int     mask  = _mm_movemask_epi8(bytes);
+                if (mask == 0) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+                    out += 16;
+                    continue;
+                }
+                for (int half = 0; half < 2; ++half) {
+                    // every character gets a slot of two bytes: itself if ASCII, the leading and the trailing byte otherwise
+                    const __m128i characters = half == 0 ? _mm_unpacklo_epi8(bytes, zero) : _mm_unpackhi_epi8(bytes, zero);
+                    const __m128i ascii      = _mm_cmplt_epi16(characters, _mm_set1_epi16(0x80));
+                    const __m128i leading    = _mm_or_si128(_mm_srli_epi16(characters, 6), _mm_set1_epi16(0xC0));
+                    const __m128i trailing   = _mm_or_si128(_mm_and_si128(characters, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+                    const __m128i first      = _mm_or_si128(_mm_and_si128(ascii, characters), _mm_andnot_si128(ascii, leading));
+                    const __m128i slots      = _mm_or_si128(first, _mm_slli_epi16(trailing, 8));
+
+                    const unsigned lanes = static_cast<unsigned>(mask >> (half * 8)) & 0xFF;
+                    const __m128i  shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(latin1_expansion.shuffle[lanes]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(slots, shuffle));
+                    out += latin1_expansion.size[lanes];
+                }
+            }
+#elif defined(UTFUTILS_SSE2) || defined(UTFUTILS_NEON)
+            // ASCII blocks are copied, the others are expanded one character at a time
+            for (; index + 16 <= size && output_end - out >= 16; ) {
+#   if defined(UTFUTILS_SSE2)
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + index));
+                if (_mm_movemask_epi8(bytes) == 0) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+#   else
+                const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(input + index));
+                if (vmaxvq_u8(bytes) < 0x80) {
+                    vst1q_u8(reinterpret_cast<uint8_t*>(out), bytes);
+#   endif
+                    out   += 16;
+                    index += 16;
+                    continue;
+                }
+                for (const size_t block_end = index + 16; index < block_end; ++index) {
+                    out = utf8_encode(static_cast<uint8_t>(input[index]), out);
+                }
+            }
+#endif
+            static_cast<void>(output_end);
+        }
+        static_cast<void>(output_size);
+        for (; index < size; ++index) {
+            out = utf8_encode(static_cast<uint8_t>(input[index]), out);
+        }
+        return out;
+    }
+
+    /**
+     * @internal
+     * @brief Finds the first UTF-16 or UTF-32 code unit above @c 0xFF.
+     * @param data the code units, may be unaligned.
+     * @param size number of code units.
+     * @param reverse the code units are in the opposite byte order.
+     * @return Number of leading code units which are Latin-1 characters.
+     */
+    template <typename CharT>
+    size_t latin1_prefix_size(const std::byte* data, const size_t size, const bool reverse) {
+        using unit_t = std::conditional_t<sizeof(CharT) == 2, uint16_t, uint32_t>;
+        // all bits but the lowest byte of the value, which is the highest byte in the opposite order
+        const unit_t all_bits  = static_cast<unit_t>(~unit_t{0});
+        const unit_t high_mask = reverse ? static_cast<unit_t>(all_bits >> 8) : static_cast<unit_t>(all_bits & ~unit_t{0xFF});
+        size_t index = 0;
+#if defined(UTFUTILS_SSE2)
+        const __m128i mask = sizeof(CharT) == 2 ? _mm_set1_epi16(static_cast<short>(high_mask)) : _mm_set1_epi32(static_cast<int>(high_mask));
+        for (; index + 32 / sizeof(CharT) <= size; index += 32 / sizeof(CharT)) {
+            const __m128i first  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index * sizeof(CharT)));
+            const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index * sizeof(CharT) + 16));
+            const __m128i high   = _mm_and_si128(_mm_or_si128(first, second), mask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF) {
+                break;
+            }
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 / sizeof(CharT) <= size; index += 16 / sizeof(CharT)) {
+            uint8x16_t high;
+            if constexpr (sizeof(CharT) == 2) {
+                high = vreinterpretq_u8_u16(vandq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(data + index * 2)), vdupq_n_u16(high_mask)));
+            } else {
+                high = vreinterpretq_u8_u32(vandq_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(data + index * 4)), vdupq_n_u32(high_mask)));
+            }
+            if (vmaxvq_u8(high) != 0) {
+                break;
+            }
+        }
+#endif
+        for (; index < size; ++index) {
+            unit_t code_unit;
+            std::memcpy(&code_unit, data + index * sizeof(CharT), sizeof(CharT));
+            if ((code_unit & high_mask) != 0) {
+                break;
+            }
+        }
+        return index;
+    }
+
+    /**
+     * @internal
+     * @brief Converts UTF-16 or UTF-32 code units which were checked by #latin1_prefix_size to Latin-1.
+     * @param data the code units, may be unaligned.
+     * @param size number of code units.
+     * @param reverse the code units are in the opposite byte order.
+     * @param out output iterator, pointers get the vectorized kernel.
+     * @return Iterator past the last written character.
+     */
+    template <typename CharT, typename OutputIt>
+    OutputIt narrow_to_latin1(const std::byte* data, const size_t size, const bool reverse, OutputIt out) {
+        size_t index = 0;
+        if constexpr (std::is_pointer_v<OutputIt>) {
+            static_assert(sizeof(*out) == 1, "Output must have the size of a Latin-1 character");
+#if defined(UTFUTILS_SSE2)
+            auto load = [data, reverse](const size_t at) {
+                const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + at * sizeof(CharT)));
+                if constexpr (sizeof(CharT) == 2) {
+                    return reverse ? _mm_srli_epi16(units, 8) : units;
+                } else {
+                    return reverse ? _mm_srli_epi32(units, 24) : units;
+                }
+            };
+            for (; index + 16 <= size; index += 16) {
+                __m128i characters;
+                if constexpr (sizeof(CharT) == 2) {
+                    characters = _mm_packus_epi16(load(index), load(index + 8));
+                } else {
+                    // the values are below 0x100, so the signed saturation of the first pack never kicks in
+                    characters = _mm_packus_epi16(_mm_packs_epi32(load(index), load(index + 4)), _mm_packs_epi32(load(index + 8), load(index + 12)));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), characters);
+                out += 16;
+            }
+#elif defined(UTFUTILS_NEON)
+            for (; index + 8 <= size; index += 8) {
+                uint8x8_t characters;
+                if constexpr (sizeof(CharT) == 2) {
+                    const uint16x8_t units = vld1q_u16(reinterpret_cast<const uint16_t*>(data + index * 2));
+                    characters = reverse ? vshrn_n_u16(units, 8) : vmovn_u16(units);
+                } else {
+                    const uint32x4_t low  = vld1q_u32(reinterpret_cast<const uint32_t*>(data + index * 4));
+                    const uint32x4_t high = vld1q_u32(reinterpret_cast<const uint32_t*>(data + index * 4 + 16));
+                    const uint16x8_t units = reverse ? vcombine_u16(vshrn_n_u32(low, 16), vshrn_n_u32(high, 16))
+                                                     : vcombine_u16(vmovn_u32(low), vmovn_u32(high));
+                    characters = reverse ? vshrn_n_u16(units, 8) : vmovn_u16(units);
+                }
+                vst1_u8(reinterpret_cast<uint8_t*>(out), characters);
+                out += 8;
+            }
+#endif
+        }
+        for (; index < size; ++index) {
+            CharT code_unit;
+            std::memcpy(&code_unit, data + index * sizeof(CharT), sizeof(CharT));
+            *out = static_cast<char>(reverse ? encoding_traits<CharT>::reverse_endianness(code_unit) : code_unit);
+            ++out;
+        }
+        return out;
+    }
+
+    /**
+     * @internal
+     * @brief Validates UTF-8 and counts the Latin-1 characters it converts to.
+     * @param input UTF-8 string.
+     * @param[out] output_size number of characters. Only set on success.
+     * @param comply_with_standard reject overlong sequences.
+     * @return status specified by #conversion::status_e enum.
+     */
+    inline conversion::status_e utf8_latin1_size(const std::basic_string_view<char8_t>& input, size_t& output_size, const bool comply_with_standard) {
+        const char8_t* it     = input.data();
+        const char8_t* end    = it + input.size();
+        size_t         result = 0;
+        while (it != end) {
+            // ASCII runs are skipped with vector compares
+            const size_t ascii_size = ascii_prefix_size(reinterpret_cast<const std::byte*>(it), static_cast<size_t>(end - it));
+            it     += ascii_size;
+            result += ascii_size;
+            if (it == end) {
+                break;
+            }
+            char32_t code_point = 0;
+            const conversion::status_e status = utf8_decode(it, end, code_point, comply_with_standard);
+            if (status != conversion::status_e::success) {
+                return status;
+            }
+            if (code_point > 0xFF) {
+                return conversion::status_e::unrepresentable_character;
+            }
+            ++result;
+        }
+        output_size = result;
+        return conversion::status_e::success;
+    }
+
+    /**
+     * @internal
+     * @brief Converts UTF-8 which was already validated by #utf8_latin1_size to Latin-1.
+     * @return Iterator past the last written character.
+     */
+    template <typename OutputIt>
+    OutputIt utf8_to_latin1_validated(const std::basic_string_view<char8_t>& input, OutputIt out) {
+        const char8_t* it  = input.data();
+        const char8_t* end = it + input.size();
+        while (it != end) {
+            const size_t ascii_size = ascii_prefix_size(reinterpret_cast<const std::byte*>(it), static_cast<size_t>(end - it));
+            if constexpr (std::is_pointer_v<OutputIt>) {
+                if (ascii_size != 0) {
+                    std::memcpy(out, it, ascii_size);
+                }
+                out += ascii_size;
+            } else {
+                out = std::transform(it, it + ascii_size, out, [](const char8_t code_unit) { return static_cast<char>(code_unit); });
+            }
+            it += ascii_size;
+            if (it == end) {
+                break;
+            }
+            char32_t code_point = 0;
+            utf8_decode(it, end, code_point, false);
+            *out = static_cast<char>(static_cast<uint8_t>(code_point));
+            ++out;
+        }
+        return out;
+    }
+
+    /**
+     * @internal
+     * @brief Checks if a UTF-16 or UTF-32 string converts to Latin-1.
+     * @param input the string without a BOM.
+     * @param reverse the string has the opposite byte order.
+     * @return status specified by #conversion::status_e enum.
+     */
+    template <typename CharT>
+    conversion::status_e latin1_status(const std::basic_string_view<CharT>& input, const bool reverse) {
+        const size_t valid_size = latin1_prefix_size<CharT>(reinterpret_cast<const std::byte*>(input.data()), input.size(), reverse);
+        if (valid_size == input.size()) {
+            return conversion::status_e::success;
+        }
+        // the first character which doesn't fit may be invalid altogether
+        const CharT* it         = input.data() + valid_size;
+        char32_t     code_point = 0;
+        const conversion::status_e status = encoding_traits<CharT>::decode(it, input.data() + input.size(), code_point, false, reverse);
+        return status != conversion::status_e::success ? status : conversion::status_e::unrepresentable_character;
+    }
+} // namespace utf
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::latin1_to_utf8(const std::string_view& latin1_sv, Sink&& utf8_sink) {
+    const size_t output_size = latin1_sv.size() + count_non_ascii(latin1_sv.data(), latin1_sv.size());
+    write_to_sink<char8_t>(std::forward<Sink>(utf8_sink), output_size, [&latin1_sv, output_size](auto out) {
+        expand_latin1(latin1_sv.data(), latin1_sv.size(), out, output_size);
+    });
+    return status_e::success;
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::latin1_to_utf16(const std::string_view& latin1_sv, Sink&& utf16_sink) {
+    write_to_sink<char16_t>(std::forward<Sink>(utf16_sink), latin1_sv.size(), [&latin1_sv](auto out) {
+        widen_latin1<char16_t>(latin1_sv.data(), latin1_sv.size(), out);
+    });
+    return status_e::success;
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::latin1_to_utf32(const std::string_view& latin1_sv, Sink&& utf32_sink) {
+    write_to_sink<char32_t>(std::forward<Sink>(utf32_sink), latin1_sv.size(), [&latin1_sv](auto out) {
+        widen_latin1<char32_t>(latin1_sv.data(), latin1_sv.size(), out);
+    });
+    return status_e::success;
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf8_to_latin1(const std::basic_string_view<char8_t>& utf8_sv, Sink&& latin1_sink, const bool comply_with_standard) {
+    const std::basic_string_view<char8_t> body = utf8_sv.substr(bom_size(utf8_sv, false));
+    size_t output_size = 0;
+    const status_e status = utf8_latin1_size(body, output_size, comply_with_standard);
+    if (status != status_e::success) {
+        clear_sink(std::forward<Sink>(latin1_sink));
+        return status;
+    }
+    write_to_sink<char>(std::forward<Sink>(latin1_sink), output_size, [&body](auto out) {
+        utf8_to_latin1_validated(body, out);
+    });
+    return status_e::success;
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf16_to_latin1(const std::basic_string_view<char16_t>& utf16_sv, Sink&& latin1_sink) {
+    const bool                             reverse = encoding_traits<char16_t>::is_reversed(utf16_sv);
+    const std::basic_string_view<char16_t> body    = utf16_sv.substr(bom_size(utf16_sv, reverse));
+    const status_e status = latin1_status(body, reverse);
+    if (status != status_e::success) {
+        clear_sink(std::forward<Sink>(latin1_sink));
+        return status;
+    }
+    write_to_sink<char>(std::forward<Sink>(latin1_sink), body.size(), [&body, reverse](auto out) {
+        narrow_to_latin1<char16_t>(reinterpret_cast<const std::byte*>(body.data()), body.size(), reverse, out);
+    });
+    return status_e::success;
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf32_to_latin1(const std::basic_string_view<char32_t>& utf32_sv, Sink&& latin1_sink) {
+    const bool                             reverse = encoding_traits<char32_t>::is_reversed(utf32_sv);
+    const std::basic_string_view<char32_t> body    = utf32_sv.substr(bom_size(utf32_sv, reverse));
+    const status_e status = latin1_status(body, reverse);
+    if (status != status_e::success) {
+        clear_sink(std::forward<Sink>(latin1_sink));
+        return status;
+    }
+    write_to_sink<char>(std::forward<Sink>(latin1_sink), body.size(), [&body, reverse](auto out) {
+        narrow_to_latin1<char32_t>(reinterpret_cast<const std::byte*>(body.data()), body.size(), reverse, out);
+    });
+    return status_e::success;
+}
+
+#endif // !defined(UTFUTILS_LATIN1_H)
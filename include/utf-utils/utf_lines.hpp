@@ -0,0 +1,210 @@
+#if !defined(UTFUTILS_LINES_H)
+#   define UTFUTILS_LINES_H
+
+#include "utf_utils.hpp"
+
+/**
+ * @file utf_lines.hpp
+ * @brief Conversions which also record where lines start, in both the source and the converted string.
+ */
+
+#include <vector>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Characters which end a line.
+     */
+    enum class line_breaks_e : uint8_t {
+        ascii   = 0, /**< LF, CR LF and a lone CR. */
+        unicode = 1  /**< Those and LINE SEPARATOR (U+2028) and PARAGRAPH SEPARATOR (U+2029). */
+    };
+
+    /**
+     * @brief Offsets of line starts in the source and the converted string, counted in their code units.
+     * @details
+     * Both vectors have one entry per line, the first line starts at @c 0 in both. A line break at the end of the string
+     * starts an empty line. Offsets in the source string count its BOM, offsets in the converted string count the BOM
+     * written to it.
+     */
+    struct line_starts {
+        std::vector<size_t> input;  /**< Line starts in the source string. */
+        std::vector<size_t> output; /**< Line starts in the converted string. */
+    };
+
+    namespace conversion {
+        /**
+         * @addtogroup lines_funcs Line Indexing Conversion Functions
+         * Functions used to convert strings and record line starts in the same pass.
+         *
+         * They behave like @ref conv_funcs, and every code point checked for a line break is the one just decoded for
+         * the conversion, so no second pass over the source or the converted string is needed to build a line table.
+         * On failure @p lines is cleared along with a container sink.
+         * @{
+         */
+
+        /**
+         * @brief This function converts UTF-8 string to UTF-16 and records line starts.
+         *
+         * @param[in] utf8_sv string view that contains the UTF-8 string.
+         * @param[out] utf16_sink container or output iterator to write UTF-16 code units to.
+         * @param[out] lines receives the line starts.
+         * @param[in] line_breaks characters which end a line. Defaults to #line_breaks_e::ascii.
+         * @param[in] comply_with_standard should the conversion comply with Unicode standard. Defaults to @c false.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
+         * @return status specified by #status_e enum.
+         */
+        template <typename Sink>
+        status_e utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf16_sink, line_starts& lines,
+                               line_breaks_e line_breaks = line_breaks_e::ascii, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-8 string to UTF-32 and records line starts.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink>
+        status_e utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf32_sink, line_starts& lines,
+                               line_breaks_e line_breaks = line_breaks_e::ascii, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-16 string to UTF-8 and records line starts.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink>
+        status_e utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf8_sink, line_starts& lines,
+                               line_breaks_e line_breaks = line_breaks_e::ascii, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-16 string to UTF-32 and records line starts.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink>
+        status_e utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf32_sink, line_starts& lines,
+                                line_breaks_e line_breaks = line_breaks_e::ascii, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-32 string to UTF-8 and records line starts.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink>
+        status_e utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf8_sink, line_starts& lines,
+                               line_breaks_e line_breaks = line_breaks_e::ascii, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function converts UTF-32 string to UTF-16 and records line starts.
+         * @details Refer to #utf8_to_utf16 for details on parameters.
+         */
+        template <typename Sink>
+        status_e utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf16_sink, line_starts& lines,
+                                line_breaks_e line_breaks = line_breaks_e::ascii, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+
+        /**
+         * @}
+         */
+    } // namespace conversion
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Converts a string which was already validated by #transcoded_size and records line starts.
+     * @param input source string, after the BOM policy was applied.
+     * @param out output iterator to write target code units to.
+     * @param input_start offset of @p input in the whole source string.
+     * @param output_start number of code units already written to the target.
+     * @param reverse the source string has the opposite byte order.
+     * @param line_breaks characters which end a line.
+     * @param lines receives line starts after the first one.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename InputCharT, typename OutputCharT, typename OutputIt>
+    OutputIt transcode_validated_lines(const std::basic_string_view<InputCharT>& input, OutputIt out, const size_t input_start, const size_t output_start,
+                                       const bool reverse, const line_breaks_e line_breaks, line_starts& lines) {
+        const InputCharT* begin = input.data();
+        const InputCharT* it    = begin;
+        const InputCharT* end   = begin + input.size();
+
+        size_t   output_offset = output_start;
+        char32_t previous      = 0;
+        while (it != end) {
+            char32_t code_point = 0;
+            encoding_traits<InputCharT>::decode(it, end, code_point, false, reverse);
+            out            = encoding_traits<OutputCharT>::encode(code_point, out);
+            output_offset += encoding_traits<OutputCharT>::code_unit_count(code_point);
+
+            if (code_point == U'\n' && previous == U'\r') {
+                // CR LF is a single line break, the line started after CR moves past LF
+                lines.input.back()  = input_start + static_cast<size_t>(it - begin);
+                lines.output.back() = output_offset;
+            }
+            else if (code_point == U'\n' || code_point == U'\r' ||
+                     (line_breaks == line_breaks_e::unicode && (code_point == U'\u2028' || code_point == U'\u2029'))) {
+                lines.input.push_back(input_start + static_cast<size_t>(it - begin));
+                lines.output.push_back(output_offset);
+            }
+            previous = code_point;
+        }
+        return out;
+    }
+
+    /**
+     * @internal
+     * @brief Converts a string, writes the result into a sink and records line starts. Refer to #transcode for details.
+     */
+    template <typename InputCharT, typename OutputCharT, typename Sink>
+    conversion::status_e transcode_lines(const std::basic_string_view<InputCharT>& input, Sink&& sink, line_starts& lines, const line_breaks_e line_breaks,
+                                         const bool comply_with_standard, const bom_e bom_policy) {
+        lines.input.assign(1, 0);
+        lines.output.assign(1, 0);
+        const conversion::status_e status = transcode<InputCharT, OutputCharT>(
+            input, std::forward<Sink>(sink), comply_with_standard, bom_policy,
+            [&input, &lines, line_breaks](const std::basic_string_view<InputCharT>& body, auto output, const bool reverse, const bool add_bom) {
+                const size_t bom_units = add_bom ? encoding_traits<OutputCharT>::code_unit_count(constants::byte_order_mark) : 0;
+                if (add_bom) {
+                    output = encoding_traits<OutputCharT>::encode(constants::byte_order_mark, output);
+                }
+                transcode_validated_lines<InputCharT, OutputCharT>(body, output, input.size() - body.size(), bom_units, reverse, line_breaks, lines);
+            });
+        if (status != conversion::status_e::success) {
+            lines.input.clear();
+            lines.output.clear();
+        }
+        return status;
+    }
+} // namespace utf
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf16_sink, line_starts& lines,
+                                                         line_breaks_e line_breaks, bool comply_with_standard, bom_e bom_policy) {
+    return transcode_lines<char8_t, char16_t>(utf8_sv, std::forward<Sink>(utf16_sink), lines, line_breaks, comply_with_standard, bom_policy);
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf32_sink, line_starts& lines,
+                                                         line_breaks_e line_breaks, bool comply_with_standard, bom_e bom_policy) {
+    return transcode_lines<char8_t, char32_t>(utf8_sv, std::forward<Sink>(utf32_sink), lines, line_breaks, comply_with_standard, bom_policy);
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf8_sink, line_starts& lines,
+                                                         line_breaks_e line_breaks, bool comply_with_standard, bom_e bom_policy) {
+    return transcode_lines<char16_t, char8_t>(utf16_sv, std::forward<Sink>(utf8_sink), lines, line_breaks, comply_with_standard, bom_policy);
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf32_sink, line_starts& lines,
+                                                          line_breaks_e line_breaks, bool comply_with_standard, bom_e bom_policy) {
+    return transcode_lines<char16_t, char32_t>(utf16_sv, std::forward<Sink>(utf32_sink), lines, line_breaks, comply_with_standard, bom_policy);
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf8_sink, line_starts& lines,
+                                                         line_breaks_e line_breaks, bool comply_with_standard, bom_e bom_policy) {
+    return transcode_lines<char32_t, char8_t>(utf32_sv, std::forward<Sink>(utf8_sink), lines, line_breaks, comply_with_standard, bom_policy);
+}
+
+template <typename Sink>
+utf::conversion::status_e utf::conversion::utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf16_sink, line_starts& lines,
+                                                          line_breaks_e line_breaks, bool comply_with_standard, bom_e bom_policy) {
+    return transcode_lines<char32_t, char16_t>(utf32_sv, std::forward<Sink>(utf16_sink), lines, line_breaks, comply_with_standard, bom_policy);
+}
+
+#endif // !defined(UTFUTILS_LINES_H)
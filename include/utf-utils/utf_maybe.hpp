@@ -0,0 +1,254 @@
+#if !defined(UTFUTILS_MAYBE_H)
+#   define UTFUTILS_MAYBE_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_maybe.hpp
+ * @brief Conversions which return a view of the input instead of a copy when nothing has to be transcoded.
+ */
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Result of a conversion which either borrows the input or owns the converted string.
+     * @tparam CharT code unit type.
+     * @details
+     * A borrowed result is a view of the input and is valid only as long as the input is. Copying an owning result copies
+     * the string, so views obtained from it are invalidated by moves like those of @c std::basic_string.
+     */
+    template <typename CharT>
+    class maybe_converted {
+    public:
+        using value_type = CharT;
+
+        maybe_converted() = default;
+        /**
+         * @brief Borrows @p borrowed.
+         */
+        explicit maybe_converted(const std::basic_string_view<CharT> borrowed) : borrowed_(borrowed) {}
+        /**
+         * @brief Takes ownership of @p owned.
+         */
+        explicit maybe_converted(std::basic_string<CharT> owned) : owned_(std::move(owned)), owns_memory_(true) {}
+
+        /**
+         * @brief Checks if the result had to be converted and owns its memory.
+         */
+        bool owns_memory() const {
+            return owns_memory_;
+        }
+        /**
+         * @brief Returns view of the result, either the borrowed input or the owned string.
+         */
+        std::basic_string_view<CharT> view() const {
+            return owns_memory_ ? std::basic_string_view<CharT>(owned_) : borrowed_;
+        }
+        operator std::basic_string_view<CharT>() const {
+            return view();
+        }
+        const CharT* data() const {
+            return view().data();
+        }
+        size_t size() const {
+            return view().size();
+        }
+        bool empty() const {
+            return size() == 0;
+        }
+        /**
+         * @brief Returns the result as a string, moving the owned one out or copying the borrowed one.
+         */
+        std::basic_string<CharT> to_string() && {
+            return owns_memory_ ? std::move(owned_) : std::basic_string<CharT>(borrowed_);
+        }
+        std::basic_string<CharT> to_string() const& {
+            return std::basic_string<CharT>(view());
+        }
+
+        /**
+         * @brief Makes the result a view of @p borrowed, releasing the owned string.
+         */
+        void borrow(const std::basic_string_view<CharT> borrowed) {
+            owned_.clear();
+            borrowed_    = borrowed;
+            owns_memory_ = false;
+        }
+        /**
+         * @brief Makes the result own a string and returns it to be filled.
+         */
+        std::basic_string<CharT>& own() {
+            borrowed_    = {};
+            owns_memory_ = true;
+            return owned_;
+        }
+        void clear() {
+            borrow({});
+        }
+
+    private:
+        std::basic_string_view<CharT> borrowed_;
+        std::basic_string<CharT>      owned_;
+        bool                          owns_memory_ = false;
+    };
+
+    namespace conversion {
+        /**
+         * @addtogroup maybe_funcs Zero-Copy Conversion Functions
+         * Functions used to validate a string and bring it into the canonical form of its encoding without copying it if it's already there.
+         *
+         * The result borrows the input if the conversion would reproduce it: the string is valid, in host byte order, and
+         * neither a BOM has to be added nor a non-standard overlong UTF-8 sequence shortened. Stripping the BOM only narrows
+         * the view. Otherwise the converted string is owned by the result. On failure the result is cleared.
+         *
+         * Validation skips the ASCII prefix of UTF-8 and the surrogate-free prefix of UTF-16 with vector compares, so mostly
+         * ASCII or BMP text is checked at memory speed.
+         * @{
+         */
+
+        /**
+         * @brief This function validates a UTF-8 string and borrows it if it needs no conversion.
+         *
+         * @param[in] utf8_sv UTF-8 string.
+         * @param[out] utf8_result view of @p utf8_sv or converted string, refer to @ref maybe_funcs.
+         * @param[in] comply_with_standard reject surrogates and overlong sequences. Defaults to @c false, then overlong sequences are shortened.
+         * @param[in] bom_policy what to do with the BOM. Defaults to @c bom_e::keep.
+         * @return status specified by #status_e enum.
+         */
+        inline status_e utf8_to_utf8(const std::basic_string_view<char8_t>& utf8_sv, maybe_converted<char8_t>& utf8_result, bool comply_with_standard = false,
+                                     bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function validates a UTF-16 string and borrows it if it needs no conversion.
+         *
+         * @param[in] utf16_sv UTF-16 string, its byte order is guessed from the BOM.
+         * @param[out] utf16_result view of @p utf16_sv or converted string in host byte order, refer to @ref maybe_funcs.
+         * @param[in] comply_with_standard reject unpaired surrogates. Defaults to @c false, then every string is valid.
+         * @param[in] bom_policy what to do with the BOM. Defaults to @c bom_e::keep.
+         * @return status specified by #status_e enum.
+         */
+        inline status_e utf16_to_utf16(const std::basic_string_view<char16_t>& utf16_sv, maybe_converted<char16_t>& utf16_result, bool comply_with_standard = false,
+                                       bom_e bom_policy = bom_e::keep);
+        /**
+         * @brief This function validates a UTF-32 string and borrows it if it needs no conversion.
+         *
+         * @param[in] utf32_sv UTF-32 string, its byte order is guessed from the BOM.
+         * @param[out] utf32_result view of @p utf32_sv or converted string in host byte order, refer to @ref maybe_funcs.
+         * @param[in] comply_with_standard reject surrogate code points. Defaults to @c false.
+         * @param[in] bom_policy what to do with the BOM. Defaults to @c bom_e::keep.
+         * @return status specified by #status_e enum.
+         */
+        inline status_e utf32_to_utf32(const std::basic_string_view<char32_t>& utf32_sv, maybe_converted<char32_t>& utf32_result, bool comply_with_standard = false,
+                                       bom_e bom_policy = bom_e::keep);
+
+        /**
+         * @}
+         */
+    } // namespace conversion
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Fills the owned string of @p result with the BOM followed by the host-order copy of @p body.
+     * @param body validated string without a BOM to add.
+     * @param reverse @p body has the opposite byte order.
+     * @param add_bom write a BOM first.
+     * @param[out] result the result to fill.
+     */
+    template <typename CharT>
+    void own_copy(const std::basic_string_view<CharT>& body, const bool reverse, const bool add_bom, maybe_converted<CharT>& result) {
+        const size_t bom_units = add_bom ? encoding_traits<CharT>::code_unit_count(constants::byte_order_mark) : 0;
+        resize_and_write(result.own(), bom_units + body.size(), [&body, reverse, add_bom](CharT* data) {
+            if (add_bom) {
+                data = encoding_traits<CharT>::encode(constants::byte_order_mark, data);
+            }
+            copy_code_units<CharT>(reinterpret_cast<std::byte*>(data), reinterpret_cast<const std::byte*>(body.data()), body.size(), reverse);
+        });
+    }
+} // namespace utf
+
+inline utf::conversion::status_e utf::conversion::utf8_to_utf8(const std::basic_string_view<char8_t>& utf8_sv, maybe_converted<char8_t>& utf8_result,
+                                                               const bool comply_with_standard, const bom_e bom_policy) {
+    bool                                  add_bom = false;
+    const std::basic_string_view<char8_t> body    = apply_bom_policy(utf8_sv, bom_policy, false, add_bom);
+
+    // the ASCII prefix is valid and converts to itself
+    const size_t                          ascii_size = ascii_prefix_size(reinterpret_cast<const std::byte*>(body.data()), body.size());
+    const std::basic_string_view<char8_t> rest       = body.substr(ascii_size);
+    size_t                                rest_size  = 0;
+    const status_e status = transcoded_size<char8_t, char8_t>(rest, rest_size, comply_with_standard, false);
+    if (status != status_e::success) {
+        utf8_result.clear();
+        return status;
+    }
+
+    // re-encoding only ever shortens overlong sequences, so the same size means the same string
+    if (rest_size == rest.size()) {
+        if (!add_bom) {
+            utf8_result.borrow(body);
+        } else {
+            own_copy(body, false, true, utf8_result);
+        }
+        return status_e::success;
+    }
+    const size_t bom_units = add_bom ? 3 : 0;
+    resize_and_write(utf8_result.own(), bom_units + ascii_size + rest_size, [&body, &rest, ascii_size, add_bom](char8_t* data) {
+        if (add_bom) {
+            data = encoding_traits<char8_t>::encode(constants::byte_order_mark, data);
+        }
+        data = std::copy(body.data(), body.data() + ascii_size, data);
+        transcode_validated<char8_t, char8_t>(rest, data, false, false);
+    });
+    return status_e::success;
+}
+
+inline utf::conversion::status_e utf::conversion::utf16_to_utf16(const std::basic_string_view<char16_t>& utf16_sv, maybe_converted<char16_t>& utf16_result,
+                                                                 const bool comply_with_standard, const bom_e bom_policy) {
+    const bool                             reverse = encoding_traits<char16_t>::is_reversed(utf16_sv);
+    bool                                   add_bom = false;
+    const std::basic_string_view<char16_t> body    = apply_bom_policy(utf16_sv, bom_policy, reverse, add_bom);
+
+    // unpaired surrogates are the only invalid UTF-16, and only when complying with the standard
+    if (comply_with_standard) {
+        const size_t valid_size = surrogate_free_prefix_size(reinterpret_cast<const std::byte*>(body.data()), body.size(), reverse);
+        size_t       ignored    = 0;
+        const status_e status = transcoded_size<char16_t, char16_t>(body.substr(valid_size), ignored, true, reverse);
+        if (status != status_e::success) {
+            utf16_result.clear();
+            return status;
+        }
+    }
+
+    if (!reverse && !add_bom) {
+        utf16_result.borrow(body);
+    } else {
+        own_copy(body, reverse, add_bom, utf16_result);
+    }
+    return status_e::success;
+}
+
+inline utf::conversion::status_e utf::conversion::utf32_to_utf32(const std::basic_string_view<char32_t>& utf32_sv, maybe_converted<char32_t>& utf32_result,
+                                                                 const bool comply_with_standard, const bom_e bom_policy) {
+    const bool                             reverse = encoding_traits<char32_t>::is_reversed(utf32_sv);
+    bool                                   add_bom = false;
+    const std::basic_string_view<char32_t> body    = apply_bom_policy(utf32_sv, bom_policy, reverse, add_bom);
+
+    size_t ignored = 0;
+    const status_e status = transcoded_size<char32_t, char32_t>(body, ignored, comply_with_standard, reverse);
+    if (status != status_e::success) {
+        utf32_result.clear();
+        return status;
+    }
+
+    if (!reverse && !add_bom) {
+        utf32_result.borrow(body);
+    } else {
+        own_copy(body, reverse, add_bom, utf32_result);
+    }
+    return status_e::success;
+}
+
+#endif // !defined(UTFUTILS_MAYBE_H)
@@ -0,0 +1,215 @@
+#if !defined(UTFUTILS_OFFSETS_H)
+#   define UTFUTILS_OFFSETS_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_offsets.hpp
+ * @brief Translation of positions in UTF-8 text between UTF-8, UTF-16 and code point offsets, e.g. for LSP.
+ */
+
+#include <algorithm>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Units offsets into a text are counted in, like @c PositionEncodingKind of the Language Server Protocol.
+     */
+    enum class position_encoding_e : uint8_t {
+        utf8  = 0, /**< UTF-8 code units, i.e. bytes. */
+        utf16 = 1, /**< UTF-16 code units, the LSP default. */
+        utf32 = 2  /**< Code points. */
+    };
+
+    /**
+     * @brief Position of a character as a line and an offset within it.
+     */
+    struct text_position {
+        size_t line      = 0; /**< Zero-based line number. */
+        size_t character = 0; /**< Offset within the line in units of a #position_encoding_e. */
+    };
+
+    /**
+     * @addtogroup offset_funcs Offset Translation Functions
+     * Functions used to translate offsets into UTF-8 text.
+     *
+     * The text is scanned up to the offset only, whole vectors at a time: code points are counted as bytes which aren't
+     * trailing ones and UTF-16 code units as those plus four-byte leading bytes, so the text is expected to be valid UTF-8.
+     * An offset inside a character (a trailing byte or the low surrogate of a pair) is moved to the start of the character,
+     * an offset past the end is moved to the end.
+     * @{
+     */
+
+    /**
+     * @brief Translates an offset into a byte offset.
+     *
+     * @param[in] utf8_sv UTF-8 text, e.g. a line.
+     * @param[in] offset offset in units of @p encoding.
+     * @param[in] encoding units of @p offset.
+     * @return Byte offset of the character.
+     */
+    inline size_t byte_offset_from(const std::basic_string_view<char8_t>& utf8_sv, size_t offset, position_encoding_e encoding);
+    /**
+     * @brief Translates a byte offset into an offset in other units.
+     *
+     * @param[in] utf8_sv UTF-8 text, e.g. a line.
+     * @param[in] byte_offset byte offset.
+     * @param[in] encoding units of the result.
+     * @return Offset of the character in units of @p encoding.
+     */
+    inline size_t offset_from_byte(const std::basic_string_view<char8_t>& utf8_sv, size_t byte_offset, position_encoding_e encoding);
+    /**
+     * @brief Translates an offset between units, e.g. an LSP column in UTF-16 code units into code points.
+     *
+     * @param[in] utf8_sv UTF-8 text, e.g. a line.
+     * @param[in] offset offset in units of @p from.
+     * @param[in] from units of @p offset.
+     * @param[in] to units of the result.
+     * @return Offset of the character in units of @p to.
+     */
+    inline size_t convert_offset(const std::basic_string_view<char8_t>& utf8_sv, const size_t offset, const position_encoding_e from, const position_encoding_e to) {
+        return offset_from_byte(utf8_sv, byte_offset_from(utf8_sv, offset, from), to);
+    }
+
+    /**
+     * @}
+     */
+
+    /**
+     * @brief Byte offsets of line starts of a UTF-8 text, to translate between byte offsets and line/character positions.
+     * @details
+     * Lines end with LF, CR LF or a lone CR, like in LSP. The index refers to the text it was built for, which must outlive it
+     * and stay unchanged. It is built with a vectorized search for line breaks; translating a position looks up the line and
+     * scans it with @ref offset_funcs, so a character offset costs a scan of at most one line.
+     */
+    class line_index {
+    public:
+        line_index() = default;
+        /**
+         * @brief Builds the index.
+         * @param[in] utf8_sv the text.
+         */
+        inline explicit line_index(const std::basic_string_view<char8_t>& utf8_sv);
+
+        /**
+         * @brief Returns number of lines, at least one. A line break at the end of the text starts an empty line.
+         */
+        size_t line_count() const {
+            return line_starts_.size();
+        }
+        /**
+         * @brief Returns byte offset of the start of the line, the size of the text for lines past the last one.
+         */
+        size_t line_start(const size_t line) const {
+            return line < line_starts_.size() ? line_starts_[line] : text_.size();
+        }
+        /**
+         * @brief Returns the line without its line break, an empty view for lines past the last one.
+         */
+        inline std::basic_string_view<char8_t> line(size_t line) const;
+        /**
+         * @brief Finds the line a byte belongs to, line breaks belong to the line they end.
+         */
+        size_t line_of(const size_t byte_offset) const {
+            return static_cast<size_t>(std::upper_bound(line_starts_.begin(), line_starts_.end(), byte_offset) - line_starts_.begin()) - 1;
+        }
+
+        /**
+         * @brief Translates a position into a byte offset.
+         * @param[in] position the position. A character offset past the end of its line means the end of the line, a line
+         * past the last one the end of the text.
+         * @param[in] encoding units of the character offset.
+         * @return Byte offset of the character.
+         */
+        inline size_t byte_offset_of(const text_position& position, position_encoding_e encoding) const;
+        /**
+         * @brief Translates a byte offset into a position.
+         * @param[in] byte_offset byte offset, a line break maps to the end of its line.
+         * @param[in] encoding units of the character offset.
+         * @return Line and character offset of the character.
+         */
+        inline text_position position_of(size_t byte_offset, position_encoding_e encoding) const;
+
+    private:
+        std::basic_string_view<char8_t> text_;
+        std::vector<size_t>             line_starts_ = {0};
+    };
+} // namespace utf
+
+inline size_t utf::byte_offset_from(const std::basic_string_view<char8_t>& utf8_sv, const size_t offset, const position_encoding_e encoding) {
+    const std::byte* bytes = reinterpret_cast<const std::byte*>(utf8_sv.data());
+    switch (encoding) {
+        case position_encoding_e::utf16:
+            return skip_utf16_code_units(bytes, utf8_sv.size(), offset);
+        case position_encoding_e::utf32:
+            return skip_code_points(bytes, utf8_sv.size(), offset);
+        default: {
+            size_t byte_offset = std::min(offset, utf8_sv.size());
+            // back to the leading byte, at most three trailing ones
+            for (size_t step = 0; step < 3 && byte_offset != 0 && byte_offset != utf8_sv.size() &&
+                                  (static_cast<uint8_t>(utf8_sv[byte_offset]) & 0xC0) == 0x80; ++step) {
+                --byte_offset;
+            }
+            return byte_offset;
+        }
+    }
+}
+
+inline size_t utf::offset_from_byte(const std::basic_string_view<char8_t>& utf8_sv, const size_t byte_offset, const position_encoding_e encoding) {
+    const size_t     start = byte_offset_from(utf8_sv, byte_offset, position_encoding_e::utf8);
+    const std::byte* bytes = reinterpret_cast<const std::byte*>(utf8_sv.data());
+    switch (encoding) {
+        case position_encoding_e::utf16:
+            return count_utf16_code_units(bytes, start);
+        case position_encoding_e::utf32:
+            return count_leading_bytes(bytes, start);
+        default:
+            return start;
+    }
+}
+
+inline utf::line_index::line_index(const std::basic_string_view<char8_t>& utf8_sv) : text_(utf8_sv) {
+    const std::byte* bytes = reinterpret_cast<const std::byte*>(text_.data());
+    for (size_t offset = find_line_break(bytes, text_.size()); offset != text_.size();
+         offset += find_line_break(bytes + offset, text_.size() - offset)) {
+        // CR LF is a single line break
+        offset += text_[offset] == '\r' && offset + 1 != text_.size() && text_[offset + 1] == '\n' ? 2 : 1;
+        line_starts_.push_back(offset);
+    }
+}
+
+inline std::basic_string_view<char8_t> utf::line_index::line(const size_t line) const {
+    if (line >= line_starts_.size()) {
+        return {};
+    }
+    // the last line has no line break
+    if (line + 1 == line_starts_.size()) {
+        return text_.substr(line_starts_[line]);
+    }
+    const size_t start = line_starts_[line];
+    size_t       end   = line_starts_[line + 1];
+    if (text_[end - 1] == '\n') {
+        --end;
+    }
+    if (end != start && text_[end - 1] == '\r') {
+        --end;
+    }
+    return text_.substr(start, end - start);
+}
+
+inline size_t utf::line_index::byte_offset_of(const text_position& position, const position_encoding_e encoding) const {
+    if (position.line >= line_starts_.size()) {
+        return text_.size();
+    }
+    return line_starts_[position.line] + byte_offset_from(line(position.line), position.character, encoding);
+}
+
+inline utf::text_position utf::line_index::position_of(const size_t byte_offset, const position_encoding_e encoding) const {
+    text_position position;
+    position.line      = line_of(byte_offset);
+    position.character = offset_from_byte(line(position.line), byte_offset - line_starts_[position.line], encoding);
+    return position;
+}
+
+#endif // !defined(UTFUTILS_OFFSETS_H)
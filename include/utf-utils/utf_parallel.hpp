@@ -0,0 +1,135 @@
+#if !defined(UTFUTILS_PARALLEL_H)
+#   define UTFUTILS_PARALLEL_H
+
+#include "utf_bytes.hpp"
+
+/**
+ * @file utf_parallel.hpp
+ * @brief Multi-threaded conversion of large buffers, used by file and stream conversions.
+ */
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Minimal number of code units a thread gets, smaller parts aren't worth starting a thread for.
+     */
+    constexpr size_t parallel_min_chunk_size = 1 << 16;
+
+    /**
+     * @internal
+     * @brief Checks if a character may start at @p code_unit, i.e. if a string may be split right before it.
+     */
+    inline bool is_split_point(const char8_t code_unit, bool) {
+        return (static_cast<uint8_t>(code_unit) & 0xC0) != 0x80;
+    }
+    inline bool is_split_point(const char16_t code_unit, const bool reverse) {
+        return !is_low_surrogate(reverse ? utf16_reverse_endianness(code_unit) : code_unit);
+    }
+    inline bool is_split_point(char32_t, bool) {
+        return true;
+    }
+
+    /**
+     * @internal
+     * @brief Converts a large string with several threads.
+     * @tparam InputCharT code unit type of the source encoding.
+     * @tparam OutputCharT code unit type of the target encoding.
+     * @param source source string.
+     * @param input_reverse the source string has the opposite byte order.
+     * @param output_reverse the target code units are written in the opposite byte order.
+     * @param options strictness, maximal number of threads and the BOM policy.
+     * @param allocate called once with the exact number of target code units, returns where to write them or @c nullptr to abort.
+     * @return status specified by #conversion::status_e enum.
+     * @details
+     * The input is split into parts at character boundaries. Every part is validated and measured by its own thread, the
+     * offsets of the parts in the output are computed from their sizes, then every thread converts its part in place.
+     * Inputs too small to be split are converted on the calling thread. On failure the status of the first bad part is returned.
+     * Parts in the opposite byte order on either side go through the block-wise byte-swapping kernels of @ref byte_funcs.
+     * The BOM policy is applied while splitting and writing, the BOM is written in front of the first part.
+     */
+    template <typename InputCharT, typename OutputCharT, typename Allocate>
+    conversion::status_e transcode_parallel(const std::basic_string_view<InputCharT>& source, const bool input_reverse, const bool output_reverse,
+                                            const transcode_options& options, Allocate&& allocate) {
+        bool                                     add_bom   = false;
+        const std::basic_string_view<InputCharT> input     = apply_bom_policy(source, options.bom_policy, input_reverse, add_bom);
+        const size_t                             bom_units = add_bom ? encoding_traits<OutputCharT>::code_unit_count(constants::byte_order_mark) : 0;
+
+        const unsigned thread_count = options.thread_count != 0 ? options.thread_count : std::max(std::thread::hardware_concurrency(), 1u);
+        const size_t part_count = std::max<size_t>(std::min<size_t>(thread_count, input.size() / parallel_min_chunk_size), 1);
+
+        std::vector<size_t> part_starts(part_count + 1, input.size());
+        part_starts[0] = 0;
+        for (size_t part = 1; part < part_count; ++part) {
+            size_t start = std::max(input.size() / part_count * part, part_starts[part - 1]);
+            // a character is at most four code units long, invalid input may be split anywhere
+            for (size_t step = 0; step < 4 && start < input.size() && !is_split_point(input[start], input_reverse); ++step) {
+                ++start;
+            }
+            part_starts[part] = start;
+        }
+        auto part_of = [&](const size_t part) {
+            return input.substr(part_starts[part], part_starts[part + 1] - part_starts[part]);
+        };
+        auto for_each_part = [&](auto&& function) {
+            std::vector<std::thread> threads;
+            threads.reserve(part_count - 1);
+            for (size_t part = 1; part < part_count; ++part) {
+                try {
+                    threads.emplace_back(function, part);
+                } catch (const std::system_error&) {
+                    // out of threads, the part is converted on the calling thread instead
+                    function(part);
+                }
+            }
+            function(0);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        };
+
+        // first pass: validate and measure every part
+        std::vector<conversion::status_e> statuses(part_count);
+        std::vector<size_t>               output_starts(part_count + 1, 0);
+        output_starts[0] = bom_units;
+        const bool swapped = input_reverse || output_reverse;
+        for_each_part([&](const size_t part) {
+            const std::basic_string_view<InputCharT> part_sv = part_of(part);
+            statuses[part] = swapped ? transcoded_bytes_size<InputCharT, OutputCharT>(reinterpret_cast<const std::byte*>(part_sv.data()), part_sv.size(), input_reverse,
+                                                                                      output_starts[part + 1], options.comply_with_standard)
+                                     : transcoded_size<InputCharT, OutputCharT>(part_sv, output_starts[part + 1], options.comply_with_standard, false);
+        });
+        for (size_t part = 0; part < part_count; ++part) {
+            if (statuses[part] != conversion::status_e::success) {
+                return statuses[part];
+            }
+            output_starts[part + 1] += output_starts[part];
+        }
+
+        // second pass: every part is converted straight into its place
+        OutputCharT* output = allocate(output_starts[part_count]);
+        if (output == nullptr && output_starts[part_count] != 0) {
+            return conversion::status_e::undefined_error;
+        }
+        if (add_bom) {
+            write_bom<OutputCharT>(reinterpret_cast<std::byte*>(output), output_reverse);
+        }
+        for_each_part([&](const size_t part) {
+            const std::basic_string_view<InputCharT> part_sv = part_of(part);
+            if (swapped) {
+                transcode_bytes_validated<InputCharT, OutputCharT>(reinterpret_cast<const std::byte*>(part_sv.data()), part_sv.size(), input_reverse,
+                                                                   reinterpret_cast<std::byte*>(output + output_starts[part]), output_reverse);
+            } else {
+                transcode_validated<InputCharT, OutputCharT>(part_sv, output + output_starts[part]);
+            }
+        });
+        return conversion::status_e::success;
+    }
+} // namespace utf
+
+#endif // !defined(UTFUTILS_PARALLEL_H)
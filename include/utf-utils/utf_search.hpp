@@ -0,0 +1,269 @@
+#if !defined(UTFUTILS_SEARCH_H)
+#   define UTFUTILS_SEARCH_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_search.hpp
+ * @brief Search in text without decoding it, also for needles in another encoding.
+ */
+
+#include <string>
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @addtogroup search_funcs Search Functions
+     * Functions used to search UTF-8 text.
+     *
+     * Needles are encoded once and looked for in the bytes of the text, whole vectors at a time, so the text isn't decoded.
+     * Offsets are byte offsets. A match starts with the leading byte of the needle, so in valid UTF-8 it is always at the
+     * start of a character. @c npos is returned if there is no match.
+     * @{
+     */
+
+    /**
+     * @brief Finds the first occurrence of a code point.
+     *
+     * @param[in] utf8_sv UTF-8 text.
+     * @param[in] code_point the code point.
+     * @param[in] start byte offset to start at. Defaults to @c 0.
+     * @return Byte offset of the character, @c npos if there is none or @p code_point is above @c U+10FFFF.
+     */
+    inline size_t find_code_point(const std::basic_string_view<char8_t>& utf8_sv, char32_t code_point, size_t start = 0);
+    /**
+     * @brief Finds the first occurrence of any of the code points, like @c std::string_view::find_first_of.
+     *
+     * @param[in] utf8_sv UTF-8 text.
+     * @param[in] code_points the code points. Those above @c U+10FFFF are ignored.
+     * @param[in] start byte offset to start at. Defaults to @c 0.
+     * @return Byte offset of the character, @c npos if there is none.
+     * @details
+     * Up to eight code points are looked for in a single pass, more take a pass per eight, each ending at the best match so far.
+     */
+    inline size_t find_any_of(const std::basic_string_view<char8_t>& utf8_sv, const std::basic_string_view<char32_t>& code_points, size_t start = 0);
+
+    /**
+     * @}
+     */
+
+    /**
+     * @brief Offset of a match in code units of the haystack and of the needle's encoding.
+     */
+    struct search_position {
+        size_t haystack_units = 0; /**< Offset in code units of the haystack, @c npos if nothing was found. */
+        size_t needle_units   = 0; /**< Offset of the same character if the haystack was in the needle's encoding, exact for valid haystacks. */
+    };
+
+    /**
+     * @brief Searches strings for a needle given in another encoding, e.g. UTF-16 documents for a UTF-8 query.
+     * @tparam HaystackCharT code unit type of the haystacks.
+     * @tparam NeedleCharT code unit type of the needle.
+     * @details
+     * Only the needle is converted, once, into the encoding of the haystacks; haystacks are searched in their own code
+     * units. Every 16-byte block of a haystack is compared with the first byte of the needle and with the first byte of
+     * its last code unit at the offset where it would be, and only positions where both match are compared in full.
+     *
+     * Matches are reported in both units. The offset in the needle's units is counted from the position the search starts
+     * at, so pass the previous match to find the next one without recounting the haystack from its start.
+     */
+    template <typename HaystackCharT, typename NeedleCharT>
+    class substring_searcher {
+    public:
+        /**
+         * @brief Converts the needle.
+         * @param[in] needle the needle, a leading BOM is ignored.
+         * @param[in] comply_with_standard should the conversion comply with Unicode standard. Defaults to @c false.
+         */
+        explicit substring_searcher(const std::basic_string_view<NeedleCharT>& needle, bool comply_with_standard = false);
+
+        /**
+         * @brief Returns status of the needle's conversion, nothing is found unless it is #conversion::status_e::success.
+         */
+        conversion::status_e status() const {
+            return status_;
+        }
+        /**
+         * @brief Returns the needle converted into the encoding of the haystacks, in host byte order.
+         */
+        std::basic_string_view<HaystackCharT> needle() const {
+            return needle_;
+        }
+
+        /**
+         * @brief Finds the first occurrence of the needle.
+         * @param[in] haystack the string to search. UTF-16 and UTF-32 ones with a BOM are searched in its byte order.
+         * @param[in] start position to start at, e.g. a previous match moved past it, defaults to the start of @p haystack.
+         * @return Position of the match, with @c npos as #search_position::haystack_units if there is none.
+         */
+        search_position find(const std::basic_string_view<HaystackCharT>& haystack, const search_position& start = {}) const;
+
+    private:
+        std::basic_string<HaystackCharT> needle_;
+        std::basic_string<HaystackCharT> swapped_needle_;
+        conversion::status_e             status_ = conversion::status_e::success;
+    };
+
+    /**
+     * @brief Finds the first occurrence of a needle in a haystack of another encoding.
+     *
+     * @param[in] haystack the string to search.
+     * @param[in] needle the needle.
+     * @return Position of the match, with @c npos as #search_position::haystack_units if there is none or the needle is invalid.
+     * @details Refer to #substring_searcher for details, use it to look for the same needle more than once.
+     */
+    template <typename HaystackCharT, typename NeedleCharT>
+    search_position find(const std::basic_string_view<HaystackCharT>& haystack, const std::basic_string_view<NeedleCharT>& needle) {
+        return substring_searcher<HaystackCharT, NeedleCharT>(needle).find(haystack);
+    }
+} // namespace utf
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Encodes a code point as UTF-8 needle.
+     * @return @c false if the code point is above @c U+10FFFF.
+     */
+    inline bool encode_needle(const char32_t code_point, short_needle& needle) {
+        if (code_point > constants::four_byte_boundary) {
+            return false;
+        }
+        char8_t code_units[4] {};
+        needle.size = static_cast<size_t>(utf8_encode(code_point, code_units) - code_units);
+        std::memcpy(needle.bytes, code_units, needle.size);
+        return true;
+    }
+
+    /**
+     * @internal
+     * @brief Counts code units a string would take in another encoding.
+     * @param input the string.
+     * @param reverse the string has the opposite byte order.
+     * @return Number of code units, exact for valid strings.
+     * @details
+     * Host order strings are counted by the value of each code unit, which compilers vectorize, or by the vectorized
+     * helpers for UTF-8. Others are decoded, and code units which can't be decoded count as @c U+FFFD.
+     */
+    template <typename InputCharT, typename OutputCharT>
+    size_t transcoded_units(const std::basic_string_view<InputCharT>& input, const bool reverse) {
+        const std::byte* bytes = reinterpret_cast<const std::byte*>(input.data());
+        size_t           count = 0;
+        if (!reverse) {
+            if constexpr (sizeof(InputCharT) == 1 && sizeof(OutputCharT) == 2) {
+                return count_utf16_code_units(bytes, input.size());
+            }
+            else if constexpr (sizeof(InputCharT) == 1 && sizeof(OutputCharT) == 4) {
+                return count_leading_bytes(bytes, input.size());
+            }
+            else if constexpr (sizeof(InputCharT) == 2 && sizeof(OutputCharT) == 1) {
+                // surrogates take two bytes each, four per pair
+                for (const char16_t code_unit : input) {
+                    count += 1 + (code_unit >= 0x80) + (code_unit >= 0x800) - (is_high_surrogate(code_unit) || is_low_surrogate(code_unit));
+                }
+                return count;
+            }
+            else if constexpr (sizeof(InputCharT) == 2 && sizeof(OutputCharT) == 4) {
+                for (const char16_t code_unit : input) {
+                    count += !is_low_surrogate(code_unit);
+                }
+                return count;
+            }
+            else if constexpr (sizeof(InputCharT) == 4) {
+                for (const char32_t code_unit : input) {
+                    count += sizeof(OutputCharT) == 1 ? 1 + (code_unit >= 0x80) + (code_unit >= 0x800) + (code_unit >= 0x10000) : 1 + (code_unit >= 0x10000);
+                }
+                return count;
+            }
+        }
+        const InputCharT* it  = input.data();
+        const InputCharT* end = it + input.size();
+        while (it != end) {
+            char32_t code_point = 0;
+            if (encoding_traits<InputCharT>::decode(it, end, code_point, false, reverse) != conversion::status_e::success) {
+                ++it;
+                code_point = constants::replacement_character;
+            }
+            count += encoding_traits<OutputCharT>::code_unit_count(code_point);
+        }
+        return count;
+    }
+} // namespace utf
+
+inline size_t utf::find_code_point(const std::basic_string_view<char8_t>& utf8_sv, const char32_t code_point, const size_t start) {
+    short_needle needle;
+    if (start >= utf8_sv.size() || !encode_needle(code_point, needle)) {
+        return std::basic_string_view<char8_t>::npos;
+    }
+    const size_t offset = find_short_needles(reinterpret_cast<const std::byte*>(utf8_sv.data()) + start, utf8_sv.size() - start, &needle, 1);
+    return offset != utf8_sv.size() - start ? start + offset : std::basic_string_view<char8_t>::npos;
+}
+
+inline size_t utf::find_any_of(const std::basic_string_view<char8_t>& utf8_sv, const std::basic_string_view<char32_t>& code_points, const size_t start) {
+    if (start >= utf8_sv.size()) {
+        return std::basic_string_view<char8_t>::npos;
+    }
+    const std::byte* data = reinterpret_cast<const std::byte*>(utf8_sv.data()) + start;
+    const size_t     size = utf8_sv.size() - start;
+
+    size_t best = size;
+    for (size_t first = 0; first < code_points.size(); first += max_short_needles) {
+        short_needle needles[max_short_needles];
+        size_t       count = 0;
+        for (size_t index = first; index < std::min(first + max_short_needles, code_points.size()); ++index) {
+            count += encode_needle(code_points[index], needles[count]) ? 1 : 0;
+        }
+        if (count == 0) {
+            continue;
+        }
+        // only matches starting before the best one matter, they end at most three bytes after it
+        const size_t limit  = std::min(size, best + 3);
+        const size_t offset = find_short_needles(data, limit, needles, count);
+        if (offset < best) {
+            best = offset;
+        }
+    }
+    return best != size ? start + best : std::basic_string_view<char8_t>::npos;
+}
+
+template <typename HaystackCharT, typename NeedleCharT>
+utf::substring_searcher<HaystackCharT, NeedleCharT>::substring_searcher(const std::basic_string_view<NeedleCharT>& needle, const bool comply_with_standard)
+    : status_(transcode<NeedleCharT, HaystackCharT>(needle, needle_, comply_with_standard, bom_e::strip)) {
+    if constexpr (sizeof(HaystackCharT) != 1) {
+        swapped_needle_.resize(needle_.size());
+        copy_swapped<HaystackCharT>(reinterpret_cast<std::byte*>(swapped_needle_.data()), reinterpret_cast<const std::byte*>(needle_.data()), needle_.size());
+    }
+}
+
+template <typename HaystackCharT, typename NeedleCharT>
+utf::search_position utf::substring_searcher<HaystackCharT, NeedleCharT>::find(const std::basic_string_view<HaystackCharT>& haystack,
+                                                                               const search_position& start) const {
+    constexpr size_t npos = std::basic_string_view<HaystackCharT>::npos;
+    if (status_ != conversion::status_e::success || start.haystack_units > haystack.size()) {
+        return {npos, npos};
+    }
+    const bool                              reverse = encoding_traits<HaystackCharT>::is_reversed(haystack);
+    const std::basic_string<HaystackCharT>& needle  = reverse ? swapped_needle_ : needle_;
+
+    size_t offset = start.haystack_units;
+    if (!needle.empty()) {
+        const std::byte* data  = reinterpret_cast<const std::byte*>(haystack.data() + start.haystack_units);
+        const size_t     size  = (haystack.size() - start.haystack_units) * sizeof(HaystackCharT);
+        const size_t     found = find_code_units(data, size, reinterpret_cast<const std::byte*>(needle.data()), needle.size() * sizeof(HaystackCharT), sizeof(HaystackCharT));
+        if (found == size) {
+            return {npos, npos};
+        }
+        offset += found / sizeof(HaystackCharT);
+    }
+
+    if constexpr (std::is_same_v<HaystackCharT, NeedleCharT>) {
+        return {offset, start.needle_units + offset - start.haystack_units};
+    }
+    else {
+        return {offset, start.needle_units + transcoded_units<HaystackCharT, NeedleCharT>(haystack.substr(start.haystack_units, offset - start.haystack_units), reverse)};
+    }
+}
+
+#endif // !defined(UTFUTILS_SEARCH_H)
@@ -0,0 +1,809 @@
+#if !defined(UTFUTILS_SIMD_H)
+#   define UTFUTILS_SIMD_H
+
+#include "utf_utils.hpp"
+
+/**
+ * @file utf_simd.hpp
+ * @brief Vectorized building blocks of the bulk kernels.
+ * @details
+ * The instruction set is chosen at compile time: build with @c -march (or @c UTFUTILS_NATIVE_ARCH for the compiled
+ * library) to get AVX2 or SSSE3 kernels. SSE2 and NEON are used where they're part of the baseline, scalar code otherwise.
+ * Define @c UTFUTILS_NO_SIMD to get the scalar code on any target, e.g. to check the vectorized kernels against it.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(UTFUTILS_NO_SIMD)
+#   if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       define UTFUTILS_SSE2
+#       include <emmintrin.h>
+#   endif
+#   if defined(__SSSE3__) || defined(__AVX__)
+#       define UTFUTILS_SSSE3
+#       include <tmmintrin.h>
+#   endif
+#   if defined(__AVX2__)
+#       define UTFUTILS_AVX2
+#       include <immintrin.h>
+#   endif
+#   if (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#       define UTFUTILS_NEON
+#       include <arm_neon.h>
+#   endif
+#endif
+
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
+
+namespace utf {
+    /**
+     * @internal
+     * @brief Copies code units reversing the byte order of each of them.
+     * @tparam CharT code unit type, @c char16_t or @c char32_t.
+     * @param destination where to write, may be unaligned. The copy runs forwards, so it may overlap @p source as long as
+     * it doesn't start after it.
+     * @param source what to read, may be unaligned.
+     * @param count number of code units.
+     */
+    template <typename CharT>
+    inline void copy_swapped(std::byte* destination, const std::byte* source, const size_t count) {
+        static_assert(sizeof(CharT) == 2 || sizeof(CharT) == 4, "only UTF-16 and UTF-32 code units have byte order");
+        size_t index = 0;
+#if defined(UTFUTILS_AVX2)
+        const __m256i shuffle_mask = sizeof(CharT) == 2 ? _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                                           1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+                                                        : _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for (; index + 32 / sizeof(CharT) <= count; index += 32 / sizeof(CharT)) {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + index * sizeof(CharT)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + index * sizeof(CharT)), _mm256_shuffle_epi8(block, shuffle_mask));
+        }
+#endif
+#if defined(UTFUTILS_SSSE3)
+        const __m128i shuffle_mask_128 = sizeof(CharT) == 2 ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+                                                            : _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for (; index + 16 / sizeof(CharT) <= count; index += 16 / sizeof(CharT)) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * sizeof(CharT)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + index * sizeof(CharT)), _mm_shuffle_epi8(block, shuffle_mask_128));
+        }
+#elif defined(UTFUTILS_SSE2)
+        for (; index + 16 / sizeof(CharT) <= count; index += 16 / sizeof(CharT)) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + index * sizeof(CharT)));
+            // swap bytes in words, then words in double words
+            block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+            if (sizeof(CharT) == 4) {
+                block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + index * sizeof(CharT)), block);
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 / sizeof(CharT) <= count; index += 16 / sizeof(CharT)) {
+            const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(source + index * sizeof(CharT)));
+            vst1q_u8(reinterpret_cast<uint8_t*>(destination + index * sizeof(CharT)), sizeof(CharT) == 2 ? vrev16q_u8(block) : vrev32q_u8(block));
+        }
+#endif
+        for (; index < count; ++index) {
+            CharT code_unit;
+            std::memcpy(&code_unit, source + index * sizeof(CharT), sizeof(CharT));
+            code_unit = encoding_traits<CharT>::reverse_endianness(code_unit);
+            std::memcpy(destination + index * sizeof(CharT), &code_unit, sizeof(CharT));
+        }
+    }
+
+    /**
+     * @internal
+     * @brief Copies code units, reversing their byte order if asked to.
+     * @tparam CharT code unit type.
+     * @param destination where to write, may be unaligned. May be equal to @p source, but mustn't overlap it otherwise.
+     * @param source what to read, may be unaligned.
+     * @param count number of code units.
+     * @param reverse reverse the byte order of each code unit.
+     */
+    template <typename CharT>
+    inline void copy_code_units(std::byte* destination, const std::byte* source, const size_t count, const bool reverse) {
+        if constexpr (sizeof(CharT) != 1) {
+            if (reverse) {
+                copy_swapped<CharT>(destination, source, count);
+                return;
+            }
+        }
+        if (destination != source && count != 0) {
+            std::memcpy(destination, source, count * sizeof(CharT));
+        }
+    }
+
+    /**
+     * @internal
+     * @brief Finds the first byte which isn't ASCII.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @return Number of leading ASCII bytes.
+     */
+    inline size_t ascii_prefix_size(const std::byte* data, const size_t size) {
+        size_t index = 0;
+#if defined(UTFUTILS_AVX2)
+        for (; index + 32 <= size; index += 32) {
+            if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index))) != 0) {
+                break;
+            }
+        }
+#endif
+#if defined(UTFUTILS_SSE2)
+        for (; index + 16 <= size; index += 16) {
+            if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index))) != 0) {
+                break;
+            }
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 <= size; index += 16) {
+            if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + index))) >= 0x80) {
+                break;
+            }
+        }
+#endif
+        // the block with the first non-ASCII byte is scanned here
+        while (index < size && static_cast<uint8_t>(data[index]) < 0x80) {
+            ++index;
+        }
+        return index;
+    }
+
+    /**
+     * @internal
+     * @brief Finds the first UTF-16 code unit which is a surrogate.
+     * @param data the code units, may be unaligned.
+     * @param size number of code units.
+     * @param reverse the code units are in the opposite byte order.
+     * @return Number of leading code units which aren't surrogates.
+     */
+    inline size_t surrogate_free_prefix_size(const std::byte* data, const size_t size, const bool reverse) {
+        // surrogates are 0xD800-0xDFFF, i.e. their top five bits are 11011
+        const uint16_t mask    = reverse ? 0x00F8 : 0xF800;
+        const uint16_t pattern = reverse ? 0x00D8 : 0xD800;
+        size_t index = 0;
+#if defined(UTFUTILS_AVX2)
+        const __m256i mask_256    = _mm256_set1_epi16(static_cast<short>(mask));
+        const __m256i pattern_256 = _mm256_set1_epi16(static_cast<short>(pattern));
+        for (; index + 16 <= size; index += 16) {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index * 2));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(block, mask_256), pattern_256)) != 0) {
+                break;
+            }
+        }
+#endif
+#if defined(UTFUTILS_SSE2)
+        const __m128i mask_128    = _mm_set1_epi16(static_cast<short>(mask));
+        const __m128i pattern_128 = _mm_set1_epi16(static_cast<short>(pattern));
+        for (; index + 8 <= size; index += 8) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index * 2));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(block, mask_128), pattern_128)) != 0) {
+                break;
+            }
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 8 <= size; index += 8) {
+            const uint16x8_t block = vld1q_u16(reinterpret_cast<const uint16_t*>(data + index * 2));
+            if (vmaxvq_u16(vceqq_u16(vandq_u16(block, vdupq_n_u16(mask)), vdupq_n_u16(pattern))) != 0) {
+                break;
+            }
+        }
+#endif
+        for (; index < size; ++index) {
+            uint16_t code_unit;
+            std::memcpy(&code_unit, data + index * 2, 2);
+            if ((code_unit & mask) == pattern) {
+                break;
+            }
+        }
+        return index;
+    }
+
+    /**
+     * @internal
+     * @brief Counts set bits.
+     */
+    inline unsigned bit_count(uint32_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_popcount(bits));
+#else
+        bits = bits - ((bits >> 1) & 0x55555555);
+        bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+        return (((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+    }
+
+    /**
+     * @internal
+     * @brief Counts zero bits below the lowest set one, @p bits mustn't be zero.
+     */
+    inline unsigned trailing_zero_count(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(bits));
+#else
+        unsigned count = 0;
+        for (; (bits & 1) == 0; bits >>= 1) {
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    /**
+     * @internal
+     * @brief Counts UTF-8 code units which aren't trailing ones, i.e. characters of valid UTF-8.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @return Number of bytes outside of @c 0x80-0xBF.
+     */
+    inline size_t count_leading_bytes(const std::byte* data, const size_t size) {
+        size_t result = 0;
+        size_t index  = 0;
+#if defined(UTFUTILS_SSE2) || defined(UTFUTILS_NEON)
+        // trailing bytes are below -64 as signed bytes, byte-sized counters are summed before they overflow
+        while (index + 16 <= size) {
+            const size_t blocks = std::min<size_t>((size - index) / 16, 255);
+#   if defined(UTFUTILS_SSE2)
+            __m128i accumulator = _mm_setzero_si128();
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+                accumulator = _mm_sub_epi8(accumulator, _mm_cmpgt_epi8(bytes, _mm_set1_epi8(-65)));
+            }
+            const __m128i sums = _mm_sad_epu8(accumulator, _mm_setzero_si128());
+            result += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+#   else
+            uint8x16_t accumulator = vdupq_n_u8(0);
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                const int8x16_t bytes = vld1q_s8(reinterpret_cast<const int8_t*>(data + index));
+                accumulator = vsubq_u8(accumulator, vcgtq_s8(bytes, vdupq_n_s8(-65)));
+            }
+            result += vaddlvq_u8(accumulator);
+#   endif
+        }
+#endif
+        for (; index < size; ++index) {
+            result += (static_cast<uint8_t>(data[index]) & 0xC0) != 0x80 ? 1 : 0;
+        }
+        return result;
+    }
+
+    /**
+     * @internal
+     * @brief Skips UTF-8 characters.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @param count number of characters to skip.
+     * @return Offset of the leading byte of character number @p count, @p size if there are fewer characters.
+     */
+    inline size_t skip_code_points(const std::byte* data, const size_t size, size_t count) {
+        size_t index = 0;
+        // whole blocks are skipped while the character is past them
+#if defined(UTFUTILS_AVX2)
+        for (; index + 32 <= size; index += 32) {
+            const __m256i  bytes   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index));
+            const unsigned leading = bit_count(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(-65)))));
+            if (leading > count) {
+                break;
+            }
+            count -= leading;
+        }
+#endif
+#if defined(UTFUTILS_SSE2)
+        for (; index + 16 <= size; index += 16) {
+            const __m128i  bytes   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            const unsigned leading = bit_count(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-65)))));
+            if (leading > count) {
+                break;
+            }
+            count -= leading;
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 <= size; index += 16) {
+            const int8x16_t bytes   = vld1q_s8(reinterpret_cast<const int8_t*>(data + index));
+            const unsigned  leading = vaddvq_u8(vshrq_n_u8(vcgtq_s8(bytes, vdupq_n_s8(-65)), 7));
+            if (leading > count) {
+                break;
+            }
+            count -= leading;
+        }
+#endif
+        for (; index < size; ++index) {
+            if ((static_cast<uint8_t>(data[index]) & 0xC0) != 0x80) {
+                if (count == 0) {
+                    return index;
+                }
+                --count;
+            }
+        }
+        return size;
+    }
+
+    /**
+     * @internal
+     * @brief Counts UTF-16 code units the UTF-8 characters would take.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @return Number of leading bytes plus the number of four-byte leading bytes, whose characters need a surrogate pair.
+     */
+    inline size_t count_utf16_code_units(const std::byte* data, const size_t size) {
+        size_t result = 0;
+        size_t index  = 0;
+#if defined(UTFUTILS_SSE2) || defined(UTFUTILS_NEON)
+        // a byte adds up to two to its counter, so they're summed twice as often
+        while (index + 16 <= size) {
+            const size_t blocks = std::min<size_t>((size - index) / 16, 127);
+#   if defined(UTFUTILS_SSE2)
+            __m128i accumulator = _mm_setzero_si128();
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                const __m128i bytes      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+                const __m128i leading    = _mm_cmpgt_epi8(bytes, _mm_set1_epi8(-65));
+                const __m128i four_bytes = _mm_cmpeq_epi8(_mm_max_epu8(bytes, _mm_set1_epi8(static_cast<char>(0xF0))), bytes);
+                accumulator = _mm_sub_epi8(_mm_sub_epi8(accumulator, leading), four_bytes);
+            }
+            const __m128i sums = _mm_sad_epu8(accumulator, _mm_setzero_si128());
+            result += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+#   else
+            uint8x16_t accumulator = vdupq_n_u8(0);
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(data + index));
+                accumulator = vsubq_u8(accumulator, vcgtq_s8(vreinterpretq_s8_u8(bytes), vdupq_n_s8(-65)));
+                accumulator = vsubq_u8(accumulator, vcgeq_u8(bytes, vdupq_n_u8(0xF0)));
+            }
+            result += vaddlvq_u8(accumulator);
+#   endif
+        }
+#endif
+        for (; index < size; ++index) {
+            const uint8_t code_unit = static_cast<uint8_t>(data[index]);
+            result += ((code_unit & 0xC0) != 0x80 ? 1 : 0) + (code_unit >= 0xF0 ? 1 : 0);
+        }
+        return result;
+    }
+
+    /**
+     * @internal
+     * @brief Skips UTF-8 characters taking the given number of UTF-16 code units.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @param count number of UTF-16 code units to skip.
+     * @return Offset of the leading byte of the character the code unit number @p count belongs to, @p size if there are
+     * fewer code units.
+     */
+    inline size_t skip_utf16_code_units(const std::byte* data, const size_t size, size_t count) {
+        size_t index = 0;
+#if defined(UTFUTILS_SSE2)
+        for (; index + 16 <= size; index += 16) {
+            const __m128i  bytes      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            const uint32_t leading    = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-65))));
+            const uint32_t four_bytes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(bytes, _mm_set1_epi8(static_cast<char>(0xF0))), bytes)));
+            const unsigned code_units = bit_count(leading) + bit_count(four_bytes);
+            if (code_units > count) {
+                break;
+            }
+            count -= code_units;
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 <= size; index += 16) {
+            const uint8x16_t bytes      = vld1q_u8(reinterpret_cast<const uint8_t*>(data + index));
+            const uint8x16_t leading    = vshrq_n_u8(vcgtq_s8(vreinterpretq_s8_u8(bytes), vdupq_n_s8(-65)), 7);
+            const uint8x16_t four_bytes = vshrq_n_u8(vcgeq_u8(bytes, vdupq_n_u8(0xF0)), 7);
+            const unsigned   code_units = vaddvq_u8(vaddq_u8(leading, four_bytes));
+            if (code_units > count) {
+                break;
+            }
+            count -= code_units;
+        }
+#endif
+        for (; index < size; ++index) {
+            const uint8_t code_unit = static_cast<uint8_t>(data[index]);
+            if ((code_unit & 0xC0) == 0x80) {
+                continue;
+            }
+            const size_t code_units = code_unit >= 0xF0 ? 2 : 1;
+            // the code unit is this character, possibly its low surrogate
+            if (count < code_units) {
+                return index;
+            }
+            count -= code_units;
+        }
+        return size;
+    }
+
+    /**
+     * @internal
+     * @brief Finds the first line feed or carriage return.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @return Offset of the byte, @p size if there is none.
+     */
+    inline size_t find_line_break(const std::byte* data, const size_t size) {
+        size_t index = 0;
+#if defined(UTFUTILS_SSE2)
+        for (; index + 16 <= size; index += 16) {
+            const __m128i bytes  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            const __m128i breaks = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')));
+            if (_mm_movemask_epi8(breaks) != 0) {
+                break;
+            }
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 <= size; index += 16) {
+            const uint8x16_t bytes  = vld1q_u8(reinterpret_cast<const uint8_t*>(data + index));
+            const uint8x16_t breaks = vorrq_u8(vceqq_u8(bytes, vdupq_n_u8('\n')), vceqq_u8(bytes, vdupq_n_u8('\r')));
+            if (vmaxvq_u8(breaks) != 0) {
+                break;
+            }
+        }
+#endif
+        while (index < size && data[index] != std::byte{'\n'} && data[index] != std::byte{'\r'}) {
+            ++index;
+        }
+        return index;
+    }
+
+    /**
+     * @internal
+     * @brief Counts zero bytes by their offset modulo four, i.e. by their position within a UTF-32 code unit.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @param[out] counts receives number of zero bytes at offsets @c 4k, @c 4k+1, @c 4k+2 and @c 4k+3.
+     */
+    inline void count_zero_bytes(const std::byte* data, const size_t size, size_t (&counts)[4]) {
+        counts[0] = counts[1] = counts[2] = counts[3] = 0;
+        size_t index = 0;
+#if defined(UTFUTILS_SSE2) || defined(UTFUTILS_NEON)
+        // every lane counts zeros at its offset, byte-sized counters are flushed before they overflow
+        while (index + 16 <= size) {
+            const size_t blocks = std::min<size_t>((size - index) / 16, 255);
+            uint8_t      lanes[16];
+#   if defined(UTFUTILS_SSE2)
+            __m128i accumulator = _mm_setzero_si128();
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+                accumulator = _mm_sub_epi8(accumulator, _mm_cmpeq_epi8(bytes, _mm_setzero_si128()));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), accumulator);
+#   else
+            uint8x16_t accumulator = vdupq_n_u8(0);
+            for (size_t block = 0; block < blocks; ++block, index += 16) {
+                const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(data + index));
+                accumulator = vsubq_u8(accumulator, vceqq_u8(bytes, vdupq_n_u8(0)));
+            }
+            vst1q_u8(lanes, accumulator);
+#   endif
+            for (size_t lane = 0; lane < 16; ++lane) {
+                counts[lane % 4] += lanes[lane];
+            }
+        }
+#endif
+        for (; index < size; ++index) {
+            counts[index % 4] += data[index] == std::byte{0} ? 1 : 0;
+        }
+    }
+
+    /**
+     * @internal
+     * @brief Finds the first byte in which two byte arrays differ.
+     * @param left the first array.
+     * @param right the second array.
+     * @param size number of bytes of each.
+     * @return Number of leading bytes the arrays have in common.
+     */
+    inline size_t common_prefix_size(const std::byte* left, const std::byte* right, const size_t size) {
+        size_t index = 0;
+#if defined(UTFUTILS_AVX2)
+        for (; index + 32 <= size; index += 32) {
+            const __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + index)),
+                                                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + index)));
+            if (_mm256_movemask_epi8(equal) != -1) {
+                break;
+            }
+        }
+#endif
+#if defined(UTFUTILS_SSE2)
+        for (; index + 16 <= size; index += 16) {
+            const __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(left + index)),
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + index)));
+            if (_mm_movemask_epi8(equal) != 0xFFFF) {
+                break;
+            }
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 <= size; index += 16) {
+            const uint8x16_t equal = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(left + index)),
+                                              vld1q_u8(reinterpret_cast<const uint8_t*>(right + index)));
+            if (vminvq_u8(equal) != 0xFF) {
+                break;
+            }
+        }
+#endif
+        while (index < size && left[index] == right[index]) {
+            ++index;
+        }
+        return index;
+    }
+
+#if defined(UTFUTILS_SSE2)
+    /**
+     * @internal
+     * @brief Loads 16 host order code units as bytes.
+     * @tparam CharT code unit type.
+     * @param data the code units.
+     * @param[out] ascii receives @c 0xFF for code units below @c 0x80 and zero for others.
+     * @return Low bytes of the code units, meaningful for ASCII ones only.
+     */
+    template <typename CharT>
+    inline __m128i load_ascii_lanes(const std::byte* data, __m128i& ascii) {
+        const __m128i* blocks = reinterpret_cast<const __m128i*>(data);
+        if constexpr (sizeof(CharT) == 1) {
+            const __m128i block = _mm_loadu_si128(blocks);
+            ascii = _mm_cmpgt_epi8(block, _mm_set1_epi8(-1));
+            return block;
+        }
+        else if constexpr (sizeof(CharT) == 2) {
+            const __m128i low   = _mm_loadu_si128(blocks);
+            const __m128i high  = _mm_loadu_si128(blocks + 1);
+            const __m128i upper = _mm_set1_epi16(static_cast<short>(0xFF80));
+            ascii = _mm_packs_epi16(_mm_cmpeq_epi16(_mm_and_si128(low, upper), _mm_setzero_si128()),
+                                    _mm_cmpeq_epi16(_mm_and_si128(high, upper), _mm_setzero_si128()));
+            return _mm_packus_epi16(_mm_andnot_si128(upper, low), _mm_andnot_si128(upper, high));
+        }
+        else {
+            __m128i       values[4];
+            __m128i       masks[4];
+            const __m128i upper = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+            for (int block = 0; block < 4; ++block) {
+                const __m128i code_units = _mm_loadu_si128(blocks + block);
+                masks[block]  = _mm_cmpeq_epi32(_mm_and_si128(code_units, upper), _mm_setzero_si128());
+                values[block] = _mm_andnot_si128(upper, code_units);
+            }
+            ascii = _mm_packs_epi16(_mm_packs_epi32(masks[0], masks[1]), _mm_packs_epi32(masks[2], masks[3]));
+            return _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3]));
+        }
+    }
+#elif defined(UTFUTILS_NEON)
+    /**
+     * @internal
+     * @brief Loads 16 host order code units as bytes.
+     * @tparam CharT code unit type.
+     * @param data the code units.
+     * @param[out] ascii receives @c 0xFF for code units below @c 0x80 and zero for others.
+     * @return Low bytes of the code units, meaningful for ASCII ones only.
+     */
+    template <typename CharT>
+    inline uint8x16_t load_ascii_lanes(const std::byte* data, uint8x16_t& ascii) {
+        if constexpr (sizeof(CharT) == 1) {
+            const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+            ascii = vcltq_u8(block, vdupq_n_u8(0x80));
+            return block;
+        }
+        else if constexpr (sizeof(CharT) == 2) {
+            const uint16x8_t low  = vld1q_u16(reinterpret_cast<const uint16_t*>(data));
+            const uint16x8_t high = vld1q_u16(reinterpret_cast<const uint16_t*>(data) + 8);
+            ascii = vcombine_u8(vmovn_u16(vcltq_u16(low, vdupq_n_u16(0x80))), vmovn_u16(vcltq_u16(high, vdupq_n_u16(0x80))));
+            return vcombine_u8(vmovn_u16(low), vmovn_u16(high));
+        }
+        else {
+            uint16x4_t values[4];
+            uint16x4_t masks[4];
+            for (int block = 0; block < 4; ++block) {
+                const uint32x4_t code_units = vld1q_u32(reinterpret_cast<const uint32_t*>(data) + block * 4);
+                masks[block]  = vmovn_u32(vcltq_u32(code_units, vdupq_n_u32(0x80)));
+                values[block] = vmovn_u32(code_units);
+            }
+            ascii = vcombine_u8(vmovn_u16(vcombine_u16(masks[0], masks[1])), vmovn_u16(vcombine_u16(masks[2], masks[3])));
+            return vcombine_u8(vmovn_u16(vcombine_u16(values[0], values[1])), vmovn_u16(vcombine_u16(values[2], values[3])));
+        }
+    }
+#endif
+
+    /**
+     * @internal
+     * @brief Finds the first position at which two host order strings of any encodings don't have the same ASCII character.
+     * @tparam LeftCharT code unit type of the first string.
+     * @tparam RightCharT code unit type of the second string.
+     * @param left code units of the first string.
+     * @param right code units of the second string.
+     * @param size number of code units to look at in each.
+     * @return Number of leading positions at which both strings have the same ASCII code unit.
+     */
+    template <typename LeftCharT, typename RightCharT>
+    inline size_t equal_ascii_prefix_size(const std::byte* left, const std::byte* right, const size_t size) {
+        size_t index = 0;
+#if defined(UTFUTILS_SSE2)
+        for (; index + 16 <= size; index += 16) {
+            __m128i       left_ascii;
+            __m128i       right_ascii;
+            const __m128i left_values  = load_ascii_lanes<LeftCharT>(left + index * sizeof(LeftCharT), left_ascii);
+            const __m128i right_values = load_ascii_lanes<RightCharT>(right + index * sizeof(RightCharT), right_ascii);
+            const __m128i equal        = _mm_and_si128(_mm_and_si128(left_ascii, right_ascii), _mm_cmpeq_epi8(left_values, right_values));
+            if (_mm_movemask_epi8(equal) != 0xFFFF) {
+                break;
+            }
+        }
+#elif defined(UTFUTILS_NEON)
+        for (; index + 16 <= size; index += 16) {
+            uint8x16_t       left_ascii;
+            uint8x16_t       right_ascii;
+            const uint8x16_t left_values  = load_ascii_lanes<LeftCharT>(left + index * sizeof(LeftCharT), left_ascii);
+            const uint8x16_t right_values = load_ascii_lanes<RightCharT>(right + index * sizeof(RightCharT), right_ascii);
+            const uint8x16_t equal        = vandq_u8(vandq_u8(left_ascii, right_ascii), vceqq_u8(left_values, right_values));
+            if (vminvq_u8(equal) != 0xFF) {
+                break;
+            }
+        }
+#endif
+        for (; index < size; ++index) {
+            LeftCharT  left_unit;
+            RightCharT right_unit;
+            std::memcpy(&left_unit, left + index * sizeof(LeftCharT), sizeof(LeftCharT));
+            std::memcpy(&right_unit, right + index * sizeof(RightCharT), sizeof(RightCharT));
+            const auto left_value  = static_cast<std::make_unsigned_t<LeftCharT>>(left_unit);
+            const auto right_value = static_cast<std::make_unsigned_t<RightCharT>>(right_unit);
+            if (left_value >= 0x80 || left_value != right_value) {
+                break;
+            }
+        }
+        return index;
+    }
+
+    /**
+     * @internal
+     * @brief Byte string of one to four bytes to look for, e.g. an encoded code point.
+     */
+    struct short_needle {
+        std::byte bytes[4] {};
+        size_t    size = 0;
+    };
+
+    /**
+     * @internal
+     * @brief Maximum number of needles #find_short_needles looks for at once.
+     */
+    constexpr size_t max_short_needles = 8;
+
+    /**
+     * @internal
+     * @brief Checks if any of the needles starts at the offset.
+     */
+    inline bool short_needle_at(const std::byte* data, const size_t size, const size_t offset, const short_needle* needles, const size_t count) {
+        for (size_t needle = 0; needle < count; ++needle) {
+            if (needles[needle].size <= size - offset && std::memcmp(data + offset, needles[needle].bytes, needles[needle].size) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @internal
+     * @brief Finds the first occurrence of any of the needles.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @param needles the needles.
+     * @param count number of needles, at most #max_short_needles.
+     * @return Offset of the first occurrence, @p size if there is none.
+     * @details
+     * Like in @c memchr, every block is compared with the first byte of each needle, and also with its last byte at the
+     * offset where it would be, so only the positions where both match are compared in full.
+     */
+    inline size_t find_short_needles(const std::byte* data, const size_t size, const short_needle* needles, const size_t count) {
+        size_t index = 0;
+#if defined(UTFUTILS_SSE2)
+        __m128i firsts[max_short_needles];
+        __m128i lasts[max_short_needles];
+        for (size_t needle = 0; needle < count; ++needle) {
+            firsts[needle] = _mm_set1_epi8(static_cast<char>(needles[needle].bytes[0]));
+            lasts[needle]  = _mm_set1_epi8(static_cast<char>(needles[needle].bytes[needles[needle].size - 1]));
+        }
+        // needles starting in a block end at most three bytes past it
+        for (; index + 19 <= size; index += 16) {
+            const __m128i block      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            uint64_t      candidates = 0;
+            for (size_t needle = 0; needle < count; ++needle) {
+                const __m128i ends = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + needles[needle].size - 1));
+                candidates |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block, firsts[needle]), _mm_cmpeq_epi8(ends, lasts[needle]))));
+            }
+            for (; candidates != 0; candidates &= candidates - 1) {
+                const size_t offset = index + trailing_zero_count(candidates);
+                if (short_needle_at(data, size, offset, needles, count)) {
+                    return offset;
+                }
+            }
+        }
+#elif defined(UTFUTILS_NEON)
+        uint8x16_t firsts[max_short_needles];
+        uint8x16_t lasts[max_short_needles];
+        for (size_t needle = 0; needle < count; ++needle) {
+            firsts[needle] = vdupq_n_u8(static_cast<uint8_t>(needles[needle].bytes[0]));
+            lasts[needle]  = vdupq_n_u8(static_cast<uint8_t>(needles[needle].bytes[needles[needle].size - 1]));
+        }
+        // needles starting in a block end at most three bytes past it
+        for (; index + 19 <= size; index += 16) {
+            const uint8x16_t block   = vld1q_u8(reinterpret_cast<const uint8_t*>(data + index));
+            uint8x16_t       matches = vdupq_n_u8(0);
+            for (size_t needle = 0; needle < count; ++needle) {
+                const uint8x16_t ends = vld1q_u8(reinterpret_cast<const uint8_t*>(data + index + needles[needle].size - 1));
+                matches = vorrq_u8(matches, vandq_u8(vceqq_u8(block, firsts[needle]), vceqq_u8(ends, lasts[needle])));
+            }
+            // four bits per byte
+            uint64_t candidates = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0) & 0x1111111111111111;
+            for (; candidates != 0; candidates &= candidates - 1) {
+                const size_t offset = index + trailing_zero_count(candidates) / 4;
+                if (short_needle_at(data, size, offset, needles, count)) {
+                    return offset;
+                }
+            }
+        }
+#endif
+        for (; index < size; ++index) {
+            if (short_needle_at(data, size, index, needles, count)) {
+                return index;
+            }
+        }
+        return size;
+    }
+
+    /**
+     * @internal
+     * @brief Finds the first occurrence of a byte string at an offset which is a multiple of the code unit size.
+     * @param data the bytes.
+     * @param size number of bytes.
+     * @param needle the byte string, not empty.
+     * @param needle_size number of bytes of the needle, a multiple of @p unit_size.
+     * @param unit_size size of a code unit: 1, 2 or 4.
+     * @return Offset of the first occurrence, @p size if there is none.
+     * @details
+     * Every block is compared with the first byte of the needle, and with the first byte of its last code unit at the
+     * offset where it would be. Only aligned positions where both match are compared in full.
+     */
+    inline size_t find_code_units(const std::byte* data, const size_t size, const std::byte* needle, const size_t needle_size, const size_t unit_size) {
+        if (needle_size > size) {
+            return size;
+        }
+        size_t index = 0;
+#if defined(UTFUTILS_SSE2) || defined(UTFUTILS_NEON)
+        const size_t last_offset = needle_size - unit_size;
+#endif
+#if defined(UTFUTILS_SSE2)
+        const __m128i  first   = _mm_set1_epi8(static_cast<char>(needle[0]));
+        const __m128i  last    = _mm_set1_epi8(static_cast<char>(needle[last_offset]));
+        // a bit per position, the bits of positions which start code units
+        const uint64_t aligned = unit_size == 1 ? 0xFFFF : unit_size == 2 ? 0x5555 : 0x1111;
+        const unsigned shift   = 0;
+#elif defined(UTFUTILS_NEON)
+        const uint8x16_t first   = vdupq_n_u8(static_cast<uint8_t>(needle[0]));
+        const uint8x16_t last    = vdupq_n_u8(static_cast<uint8_t>(needle[last_offset]));
+        // four bits per position, the lowest bits of positions which start code units
+        const uint64_t   aligned = unit_size == 1 ? 0x1111111111111111 : unit_size == 2 ? 0x0101010101010101 : 0x0001000100010001;
+        const unsigned   shift   = 2;
+#endif
+#if defined(UTFUTILS_SSE2) || defined(UTFUTILS_NEON)
+        for (; index + last_offset + 16 <= size; index += 16) {
+#   if defined(UTFUTILS_SSE2)
+            const __m128i starts     = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index)), first);
+            const __m128i ends       = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + last_offset)), last);
+            uint64_t      candidates = static_cast<uint64_t>(_mm_movemask_epi8(_mm_and_si128(starts, ends))) & aligned;
+#   else
+            const uint8x16_t starts     = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + index)), first);
+            const uint8x16_t ends       = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + index + last_offset)), last);
+            uint64_t         candidates = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vandq_u8(starts, ends)), 4)), 0) & aligned;
+#   endif
+            for (; candidates != 0; candidates &= candidates - 1) {
+                const size_t offset = index + (trailing_zero_count(candidates) >> shift);
+                if (std::memcmp(data + offset, needle, needle_size) == 0) {
+                    return offset;
+                }
+            }
+        }
+#endif
+        for (; index + needle_size <= size; index += unit_size) {
+            if (data[index] == needle[0] && std::memcmp(data + index, needle, needle_size) == 0) {
+                return index;
+            }
+        }
+        return size;
+    }
+} // namespace utf
+
+#endif // !defined(UTFUTILS_SIMD_H)
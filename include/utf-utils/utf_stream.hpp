@@ -0,0 +1,322 @@
+#if !defined(UTFUTILS_STREAM_H)
+#   define UTFUTILS_STREAM_H
+
+#include "utf_parallel.hpp"
+
+/**
+ * @file utf_stream.hpp
+ * @brief Conversion of data arriving in arbitrary chunks, e.g. from pipes.
+ */
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief Converts a stream of bytes chunk by chunk.
+     * @details
+     * Chunks may be cut anywhere, even in the middle of a code unit: only the incomplete character at the end of a chunk is
+     * kept and completed with the first bytes of the next one, the rest of a chunk is converted straight from the caller's
+     * memory (a chunk which isn't aligned for its code unit type is copied first). The character left at the end of the
+     * stream is converted like the end of a whole buffer, so the stream gives the same result and status as a single
+     * #conversion::transcode_bytes call with the same options. The byte order of generic UTF-16 and UTF-32 input is decided
+     * by the BOM at the start of the stream, generic output is written in host byte order. Every chunk is converted with the
+     * two-pass kernels, by several threads if it's large enough and #transcode_options::thread_count allows it.
+     * #transcode_options::bom_policy is applied to the first character of the stream.
+     */
+    class stream_converter {
+    public:
+        /**
+         * @param[in] input_encoding encoding of the input bytes.
+         * @param[in] output_encoding encoding of the output bytes.
+         * @param[in] options conversion options.
+         */
+        UTFUTILS_DECL stream_converter(encoding_e input_encoding, encoding_e output_encoding, const transcode_options& options = {});
+
+        /**
+         * @brief Converts the next chunk of the stream.
+         * @param[in] data pointer to the chunk.
+         * @param[in] size size of the chunk in bytes.
+         * @param[out] output receives the converted bytes, its previous contents are replaced. Cleared on failure.
+         * @return status specified by #conversion::status_e enum. The stream can't be continued after a failure, call #reset.
+         */
+        UTFUTILS_DECL conversion::status_e convert(const std::byte* data, size_t size, std::vector<std::byte>& output);
+        /**
+         * @brief Finishes the stream and prepares the converter for the next one.
+         * @param[out] output receives the remaining converted bytes, its previous contents are replaced. That's the kept
+         * character or the added BOM of an empty stream. Cleared on failure.
+         * @return status specified by #conversion::status_e enum, the one of converting the kept character as the end of the
+         * input: e.g. #conversion::status_e::character_cut_off for a part of a code unit or of a UTF-8 sequence, while a lone
+         * high surrogate is only rejected if #transcode_options::comply_with_standard is set.
+         */
+        UTFUTILS_DECL conversion::status_e finish(std::vector<std::byte>& output);
+        /**
+         * @brief Drops the kept bytes and the byte order of the current stream.
+         */
+        UTFUTILS_DECL void reset();
+
+    private:
+        /**
+         * @brief Decides the byte order of the input from the first code units of the stream.
+         */
+        template <typename InputCharT>
+        void start(const std::basic_string_view<InputCharT>& input_sv);
+        /**
+         * @brief Converts complete characters and appends them to @p output.
+         */
+        template <typename InputCharT>
+        conversion::status_e append_converted(const std::basic_string_view<InputCharT>& input_sv, std::vector<std::byte>& output);
+
+        encoding_e            input_encoding_;
+        encoding_e            output_encoding_;
+        transcode_options     options_;
+        bool                  started_       = false; /**< The byte order of the input is decided. */
+        bool                  input_reverse_ = false;
+        bool                  bom_handled_   = false; /**< The BOM policy was applied to the start of the stream. */
+        char32_t              kept_[2] {};            /**< Incomplete character at the end of the last chunk, @c char32_t for alignment. */
+        size_t                kept_size_ = 0;         /**< Number of kept bytes, less than four. */
+        std::vector<char32_t> buffer_;                /**< Copy of a chunk which isn't aligned for its code unit type. */
+    };
+
+    /**
+     * @brief Converts a large buffer in steps of bounded work, e.g. across iterations of an event loop.
+     * @details
+     * Every #step converts at most the given number of input code units with a #stream_converter, which keeps the
+     * character cut by the end of a step for the next one and converts the end of the input like a single conversion
+     * would, so the result and the status are the same as of #conversion::transcode_bytes with the same options. The input
+     * is read in place, unless it isn't aligned for its code unit type, and must outlive the job. The output is collected
+     * by the job and can be taken as it grows.
+     */
+    class conversion_job {
+    public:
+        /**
+         * @param[in] data pointer to the input.
+         * @param[in] size size of the input in bytes.
+         * @param[in] input_encoding encoding of the input bytes.
+         * @param[in] output_encoding encoding of the output bytes.
+         * @param[in] options conversion options, keep #transcode_options::thread_count at @c 1 to stay on the calling thread.
+         */
+        UTFUTILS_DECL conversion_job(const std::byte* data, size_t size, encoding_e input_encoding, encoding_e output_encoding, const transcode_options& options = {});
+
+        /**
+         * @brief Converts the next part of the input.
+         * @param[in] budget maximum number of input code units to convert, treated as @c 1 if zero. A trailing part of a code
+         * unit is converted with the last whole one.
+         * @return status specified by #conversion::status_e enum. Once the job failed or is #done, its final status is returned
+         * without doing anything.
+         */
+        UTFUTILS_DECL conversion::status_e step(size_t budget);
+        /**
+         * @brief Checks if the whole input was converted or the conversion failed.
+         */
+        bool done() const {
+            return done_;
+        }
+        /**
+         * @brief Returns number of input bytes converted so far.
+         */
+        size_t processed() const {
+            return processed_;
+        }
+        /**
+         * @brief Returns size of the input in bytes.
+         */
+        size_t size() const {
+            return size_;
+        }
+        /**
+         * @brief Returns the bytes converted so far and not taken yet. Cleared on failure.
+         */
+        const std::vector<std::byte>& output() const {
+            return output_;
+        }
+        /**
+         * @brief Takes the bytes converted so far, e.g. to write them out before the job is done.
+         */
+        std::vector<std::byte> take_output() {
+            return std::exchange(output_, {});
+        }
+
+    private:
+        const std::byte*       data_;
+        size_t                 size_;
+        size_t                 code_unit_size_ = 1;
+        size_t                 processed_      = 0;
+        bool                   done_           = false;
+        conversion::status_e   status_         = conversion::status_e::success;
+        stream_converter       converter_;
+        std::vector<std::byte> output_;
+        std::vector<std::byte> step_output_; /**< Output of the current step, reused between steps. */
+    };
+} // namespace utf
+
+//--------------------------------------------------IMPLEMENTATION--------------------------------------------------//
+#if defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+
+#include <cstring>
+
+UTFUTILS_DECL utf::stream_converter::stream_converter(const encoding_e input_encoding, const encoding_e output_encoding, const transcode_options& options)
+    : input_encoding_(input_encoding), output_encoding_(output_encoding), options_(options) {}
+
+template <typename InputCharT>
+void utf::stream_converter::start(const std::basic_string_view<InputCharT>& input_sv) {
+    if (!started_ && !input_sv.empty()) {
+        started_       = true;
+        input_reverse_ = needs_byte_swap(input_encoding_, input_sv);
+    }
+}
+
+template <typename InputCharT>
+utf::conversion::status_e utf::stream_converter::append_converted(const std::basic_string_view<InputCharT>& input_sv, std::vector<std::byte>& output) {
+    // only the first character of the stream may be a BOM
+    transcode_options options = options_;
+    if (bom_handled_) {
+        options.bom_policy = bom_e::keep;
+    }
+    return with_code_unit_type(output_encoding_, [&](auto output_code_unit) {
+        using output_char_t = decltype(output_code_unit);
+        const size_t               offset = output.size();
+        const conversion::status_e status = transcode_parallel<InputCharT, output_char_t>(
+            input_sv, input_reverse_, needs_byte_swap(output_encoding_, std::basic_string_view<output_char_t>()), options, [&](const size_t output_size) {
+                output.resize(offset + output_size * sizeof(output_char_t));
+                return reinterpret_cast<output_char_t*>(output.data() + offset);
+            });
+        if (status == conversion::status_e::success) {
+            bom_handled_ = true;
+        }
+        return status;
+    });
+}
+
+UTFUTILS_DECL utf::conversion::status_e utf::stream_converter::convert(const std::byte* data, size_t size, std::vector<std::byte>& output) {
+    output.clear();
+    const conversion::status_e status = with_code_unit_type(input_encoding_, [&](auto input_code_unit) {
+        using input_char_t = decltype(input_code_unit);
+        if (kept_size_ != 0) {
+            // the kept character is completed with the first bytes of the chunk; eight bytes always hold a complete
+            // character after the at most three kept ones, so the chunk is only too short if it's taken whole
+            const size_t taken = std::min(size, sizeof(kept_) - kept_size_);
+            if (taken != 0) {
+                std::memcpy(reinterpret_cast<std::byte*>(kept_) + kept_size_, data, taken);
+            }
+            const std::basic_string_view<input_char_t> kept_sv(reinterpret_cast<const input_char_t*>(kept_), (kept_size_ + taken) / sizeof(input_char_t));
+            start(kept_sv);
+            const size_t complete_size = complete_prefix_size(kept_sv, input_reverse_) * sizeof(input_char_t);
+            if (complete_size <= kept_size_) {
+                kept_size_ += taken;
+                return conversion::status_e::success;
+            }
+            const conversion::status_e kept_status = append_converted(kept_sv.substr(0, complete_size / sizeof(input_char_t)), output);
+            if (kept_status != conversion::status_e::success) {
+                return kept_status;
+            }
+            data += complete_size - kept_size_;
+            size -= complete_size - kept_size_;
+            kept_size_ = 0;
+        }
+
+        // the rest of the chunk is converted in place
+        const input_char_t* code_units = reinterpret_cast<const input_char_t*>(data);
+        if (reinterpret_cast<uintptr_t>(data) % alignof(input_char_t) != 0 && size != 0) {
+            buffer_.resize((size + sizeof(char32_t) - 1) / sizeof(char32_t));
+            std::memcpy(buffer_.data(), data, size);
+            code_units = reinterpret_cast<const input_char_t*>(buffer_.data());
+        }
+        const std::basic_string_view<input_char_t> input_sv(code_units, size / sizeof(input_char_t));
+        start(input_sv);
+        const size_t complete_size = complete_prefix_size(input_sv, input_reverse_);
+        if (complete_size != 0) {
+            const conversion::status_e chunk_status = append_converted(input_sv.substr(0, complete_size), output);
+            if (chunk_status != conversion::status_e::success) {
+                return chunk_status;
+            }
+        }
+        // the incomplete character (and incomplete code unit) is kept for the next chunk
+        kept_size_ = size - complete_size * sizeof(input_char_t);
+        if (kept_size_ != 0) {
+            std::memcpy(kept_, data + complete_size * sizeof(input_char_t), kept_size_);
+        }
+        return conversion::status_e::success;
+    });
+    if (status != conversion::status_e::success) {
+        output.clear();
+    }
+    return status;
+}
+
+UTFUTILS_DECL utf::conversion::status_e utf::stream_converter::finish(std::vector<std::byte>& output) {
+    output.clear();
+    conversion::status_e status = conversion::status_e::success;
+    if (kept_size_ != 0) {
+        // converted as the end of a whole buffer, so the strictness decides about a lone high surrogate
+        status = with_code_unit_type(input_encoding_, [&](auto input_code_unit) {
+            using input_char_t = decltype(input_code_unit);
+            if (kept_size_ % sizeof(input_char_t) != 0) {
+                return conversion::status_e::character_cut_off;
+            }
+            const std::basic_string_view<input_char_t> kept_sv(reinterpret_cast<const input_char_t*>(kept_), kept_size_ / sizeof(input_char_t));
+            start(kept_sv);
+            return append_converted(kept_sv, output);
+        });
+        if (status != conversion::status_e::success) {
+            output.clear();
+        }
+    }
+    else if (!bom_handled_ && options_.bom_policy == bom_e::add) {
+        with_code_unit_type(output_encoding_, [&](auto output_code_unit) {
+            using output_char_t = decltype(output_code_unit);
+            output.resize(sizeof(output_char_t) * 4);
+            output.resize(sizeof(output_char_t) * write_bom<output_char_t>(output.data(), needs_byte_swap(output_encoding_, std::basic_string_view<output_char_t>())));
+            return conversion::status_e::success;
+        });
+    }
+    reset();
+    return status;
+}
+
+UTFUTILS_DECL void utf::stream_converter::reset() {
+    started_       = false;
+    input_reverse_ = false;
+    bom_handled_   = false;
+    kept_size_     = 0;
+}
+
+UTFUTILS_DECL utf::conversion_job::conversion_job(const std::byte* data, const size_t size, const encoding_e input_encoding, const encoding_e output_encoding,
+                                                  const transcode_options& options)
+    : data_(data), size_(size), converter_(input_encoding, output_encoding, options) {
+    with_code_unit_type(input_encoding, [this](auto input_code_unit) {
+        code_unit_size_ = sizeof(input_code_unit);
+        return conversion::status_e::success;
+    });
+}
+
+UTFUTILS_DECL utf::conversion::status_e utf::conversion_job::step(const size_t budget) {
+    if (done_) {
+        return status_;
+    }
+    // the budget is clamped before it's turned into bytes, so a huge one can't overflow
+    const size_t remaining  = size_ - processed_;
+    const size_t whole_size = remaining - remaining % code_unit_size_;
+    size_t       chunk_size = std::min(std::max<size_t>(budget, 1), remaining / code_unit_size_) * code_unit_size_;
+    if (chunk_size == whole_size) {
+        chunk_size = remaining;
+    }
+    status_ = converter_.convert(data_ + processed_, chunk_size, step_output_);
+    processed_ += chunk_size;
+    if (status_ == conversion::status_e::success) {
+        output_.insert(output_.end(), step_output_.begin(), step_output_.end());
+        // the last step also reports a character cut off by the end of the input
+        if (processed_ == size_) {
+            status_ = converter_.finish(step_output_);
+            output_.insert(output_.end(), step_output_.begin(), step_output_.end());
+            done_ = true;
+        }
+    }
+    if (status_ != conversion::status_e::success) {
+        output_.clear();
+        done_ = true;
+    }
+    return status_;
+}
+
+#endif // defined(IMPLEMENT_UTFUTILS) || defined(UTFUTILS_HEADER_ONLY)
+#endif // !defined(UTFUTILS_STREAM_H)
@@ -0,0 +1,125 @@
+#if !defined(UTFUTILS_TRUNCATE_H)
+#   define UTFUTILS_TRUNCATE_H
+
+#include "utf_simd.hpp"
+
+/**
+ * @file utf_truncate.hpp
+ * @brief Truncation of strings which doesn't cut characters, e.g. to fit database columns.
+ */
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @addtogroup truncate_funcs Truncation Functions
+     * Functions used to cut strings to a maximum size without cutting a character in two.
+     *
+     * Only the end of the kept part is looked at: it is moved back over the trailing bytes or the low surrogate of the
+     * character it would cut, which takes at most three steps. Capping by code points too scans the kept part whole vectors
+     * at a time: UTF-8 by counting leading bytes, UTF-16 by skipping runs without surrogates. The result is a view of the
+     * input, so nothing is copied.
+     * @{
+     */
+
+    /**
+     * @brief Cuts UTF-8 string to at most @p max_bytes bytes.
+     *
+     * @param[in] utf8_sv string view that contains the UTF-8 string.
+     * @param[in] max_bytes maximum number of bytes.
+     * @param[in] max_code_points maximum number of code points. Defaults to no limit.
+     * @return The longest prefix within both limits which doesn't end inside a character.
+     */
+    inline std::basic_string_view<char8_t> truncate_utf8(const std::basic_string_view<char8_t>& utf8_sv, size_t max_bytes,
+                                                         size_t max_code_points = std::basic_string_view<char8_t>::npos);
+    /**
+     * @brief Cuts UTF-16 string to at most @p max_units code units.
+     *
+     * @param[in] utf16_sv string view that contains the UTF-16 string, in the byte order given by its BOM.
+     * @param[in] max_units maximum number of code units.
+     * @param[in] max_code_points maximum number of code points. Defaults to no limit.
+     * @return The longest prefix within both limits which doesn't end between the surrogates of a pair.
+     */
+    inline std::basic_string_view<char16_t> truncate_utf16(const std::basic_string_view<char16_t>& utf16_sv, size_t max_units,
+                                                           size_t max_code_points = std::basic_string_view<char16_t>::npos);
+
+    /**
+     * @brief Cuts every UTF-8 string of a column, e.g. before writing it into a fixed-size database column.
+     *
+     * @param[in] first iterator to the first string, anything convertible to @c std::basic_string_view<char8_t>.
+     * @param[in] last iterator past the last string.
+     * @param[out] out output iterator receiving the truncated views.
+     * @param[in] max_bytes maximum number of bytes of each string.
+     * @param[in] max_code_points maximum number of code points of each string. Defaults to no limit.
+     * @return Iterator past the last written view.
+     */
+    template <typename InputIt, typename OutputIt>
+    OutputIt truncate_utf8(InputIt first, InputIt last, OutputIt out, size_t max_bytes, size_t max_code_points = std::basic_string_view<char8_t>::npos) {
+        for (; first != last; ++first, ++out) {
+            *out = truncate_utf8(std::basic_string_view<char8_t>(*first), max_bytes, max_code_points);
+        }
+        return out;
+    }
+    /**
+     * @brief Cuts every UTF-16 string of a column.
+     * @details Refer to the UTF-8 overload for details.
+     */
+    template <typename InputIt, typename OutputIt>
+    OutputIt truncate_utf16(InputIt first, InputIt last, OutputIt out, size_t max_units, size_t max_code_points = std::basic_string_view<char16_t>::npos) {
+        for (; first != last; ++first, ++out) {
+            *out = truncate_utf16(std::basic_string_view<char16_t>(*first), max_units, max_code_points);
+        }
+        return out;
+    }
+
+    /**
+     * @}
+     */
+} // namespace utf
+
+inline std::basic_string_view<char8_t> utf::truncate_utf8(const std::basic_string_view<char8_t>& utf8_sv, const size_t max_bytes, const size_t max_code_points) {
+    size_t size = std::min(max_bytes, utf8_sv.size());
+    // the byte right after the cut must not be a trailing one, at most three of them follow a leading byte
+    for (size_t step = 0; step < 3 && size != 0 && size != utf8_sv.size() &&
+                          static_cast<uint8_t>(utf8_sv[size]) >> 6 == constants::trailing_byte_marker; ++step) {
+        --size;
+    }
+    if (max_code_points < size) {
+        size = skip_code_points(reinterpret_cast<const std::byte*>(utf8_sv.data()), size, max_code_points);
+    }
+    return utf8_sv.substr(0, size);
+}
+
+inline std::basic_string_view<char16_t> utf::truncate_utf16(const std::basic_string_view<char16_t>& utf16_sv, const size_t max_units, const size_t max_code_points) {
+    const bool reverse = encoding_traits<char16_t>::is_reversed(utf16_sv);
+    auto       value   = [&utf16_sv, reverse](const size_t index) {
+        return reverse ? encoding_traits<char16_t>::reverse_endianness(utf16_sv[index]) : utf16_sv[index];
+    };
+
+    size_t size = std::min(max_units, utf16_sv.size());
+    // don't separate a low surrogate from its high one
+    if (size != 0 && size != utf16_sv.size() && is_low_surrogate(value(size)) && is_high_surrogate(value(size - 1))) {
+        --size;
+    }
+    if (max_code_points < size) {
+        // runs without surrogates are a character per code unit and are skipped with vector compares
+        const std::byte* bytes     = reinterpret_cast<const std::byte*>(utf16_sv.data());
+        size_t           index     = 0;
+        size_t           remaining = max_code_points;
+        while (index < size) {
+            const size_t run = surrogate_free_prefix_size(bytes + index * sizeof(char16_t), std::min(size - index, remaining), reverse);
+            index     += run;
+            remaining -= run;
+            if (remaining == 0 || index == size) {
+                break;
+            }
+            // a pair or an unpaired surrogate is one character
+            index += index + 1 < size && is_high_surrogate(value(index)) && is_low_surrogate(value(index + 1)) ? 2 : 1;
+            --remaining;
+        }
+        size = index;
+    }
+    return utf16_sv.substr(0, size);
+}
+
+#endif // !defined(UTFUTILS_TRUNCATE_H)
@@ -10,7 +10,7 @@
  * @brief The main header file for UTF-* string support.
  * @version 0.1
  * @date 2023-07-16
- * 
+ *
  * @copyright Copyright (c) 2023
  */
 
@@ -19,6 +19,8 @@
 #include <cstddef>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #if __cplusplus < 202002L // < c++20
@@ -28,6 +30,50 @@
     using char8_t = char;
 #endif
 
+//--------------------------------------------------CONFIGURATION--------------------------------------------------//
+
+/**
+ * @def UTFUTILS_API
+ * @brief Marks symbols exported by the compiled library.
+ * @details
+ * Defined as export/import attribute when @c UTFUTILS_SHARED is defined (i.e. utf-utils is a shared library), empty otherwise.
+ * Refer to the main page for the available build modes.
+ */
+#if defined(UTFUTILS_SHARED)
+#   if defined(_WIN32)
+#       if defined(IMPLEMENT_UTFUTILS)
+#           define UTFUTILS_API __declspec(dllexport)
+#       else
+#           define UTFUTILS_API __declspec(dllimport)
+#       endif
+#   else
+#       define UTFUTILS_API __attribute__((visibility("default")))
+#   endif
+#else
+#   define UTFUTILS_API
+#endif
+
+/**
+ * @def UTFUTILS_DECL
+ * @brief Prefix of non-template functions: @c inline in header-only mode, #UTFUTILS_API otherwise.
+ */
+#if defined(UTFUTILS_HEADER_ONLY)
+#   define UTFUTILS_DECL inline
+#else
+#   define UTFUTILS_DECL UTFUTILS_API
+#endif
+
+/**
+ * @def UTFUTILS_CALL_COMPILED
+ * @brief Defined when conversions into @c std::basic_string call the kernels compiled into the library.
+ * @details
+ * @c UTFUTILS_COMPILED holds the C++ standard the library was built with. Before C++20 @c char8_t is @c char, so the
+ * compiled kernels are only called if this translation unit agrees on it. Otherwise the header ones are used as usual.
+ */
+#if defined(UTFUTILS_COMPILED) && !defined(UTFUTILS_HEADER_ONLY) && (UTFUTILS_COMPILED >= 20) == (__cplusplus >= 202002L)
+#   define UTFUTILS_CALL_COMPILED
+#endif
+
 //----------------------------------------------------INTERFACE----------------------------------------------------//
 
 /**
@@ -35,6 +81,37 @@
  * @brief This is the main namespace that contains everything related to utf-utils library.
  */
 namespace utf {
+    /**
+     * @brief Defines Unicode encoding forms.
+     */
+    enum class encoding_e : uint8_t {
+        utf8     = 0, /**< UTF-8. */
+        utf16    = 1, /**< UTF-16 in host byte order, unless the BOM says otherwise. */
+        utf32    = 2, /**< UTF-32 in host byte order, unless the BOM says otherwise. */
+        utf16_le = 3, /**< UTF-16, little-endian. */
+        utf16_be = 4, /**< UTF-16, big-endian. */
+        utf32_le = 5, /**< UTF-32, little-endian. */
+        utf32_be = 6  /**< UTF-32, big-endian. */
+    };
+
+    /**
+     * @brief Defines what conversions do with the byte order mark (@c U+FEFF at the start of a string).
+     */
+    enum class bom_e : uint8_t {
+        keep  = 0, /**< The BOM is converted like any other character, none is added. */
+        strip = 1, /**< The BOM of the source isn't written. */
+        add   = 2  /**< The target starts with a BOM, whether the source has one or not. */
+    };
+
+    /**
+     * @brief Options of whole-buffer conversions, i.e. of files and streams.
+     */
+    struct transcode_options {
+        bool     comply_with_standard = false;       /**< Should the conversion comply with Unicode standard. Refer to #conversion::utf8_to_utf16 for details. */
+        unsigned thread_count         = 1;           /**< Number of threads to convert large inputs with, @c 0 means one per hardware thread. */
+        bom_e    bom_policy           = bom_e::keep; /**< What to do with the BOM at the start of the source. */
+    };
+
     /**
      * @namespace utf::conversion
      * @brief This namespace contains conversion functions.
@@ -45,6 +122,7 @@ namespace utf {
          * @remark Refer to conversion functions' respected documentation for info on #status_e::non_standard_encoding value.
          */
         enum class status_e : int8_t {
+            unrepresentable_character = -4, /**< The character can't be represented in the target encoding, e.g. in Latin-1. */
             trailing_without_leading = -3, /**< The byte says it is trailing, but doesn't have a leading byte.*/
             character_cut_off = -2, /**< The first byte says it has trailing one/-s, but is, in fact, last in the string.*/
             non_standard_encoding = -1, /**< The encoding is not standard-compliant. */
@@ -55,15 +133,34 @@ namespace utf {
         /**
          * @addtogroup conv_funcs Conversion Functions
          * Functions used to convert between Unicode encodings.
+         *
+         * Every conversion function writes its result into a @a sink, which is either:
+         * - a contiguous resizable container (anything with @c data(), @c resize() and @c clear(), e.g. @c std::basic_string,
+         *   @c std::vector or a small-buffer string) whose @c value_type is as wide as the target code unit;
+         * - an output iterator (e.g. @c std::back_insert_iterator or a raw pointer into a big enough buffer).
+         *
+         * The input is validated and the exact output length is computed before anything is written. A container is therefore
+         * resized once and written once (on C++23 @c std::basic_string is sized with @c resize_and_overwrite, so it's never
+         * zero-filled first), its previous contents are replaced, and it is cleared on failure. An output iterator receives
+         * nothing on failure.
+         *
+         * The BOM is handled according to #bom_e while the output is measured and written: a stripped BOM is skipped in the
+         * input and an added one is encoded in front of the output, so neither costs an extra pass or moving the string. The
+         * byte order of a UTF-16 or UTF-32 source is still taken from its BOM when it's stripped.
+         *
+         * All conversion functions are @c constexpr. With a pointer or any other literal output iterator they can be evaluated
+         * at compile time since C++17, with @c std::basic_string or @c std::vector since C++20. To embed converted string literals
+         * see #utf::literal.
          * @{
          */
 
         /**
          * @brief This function converts UTF-8 string to UTF-16 string.
-         * 
+         *
          * @param[in] utf8_sv const reference to a string view representing UTF-8 string.
-         * @param[out] utf16_s reference to a string which will hold converted string.
+         * @param[out] utf16_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
          * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false.  Refer to "Remarks" for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
          * @return status specified by #status_e enum.
          * @remarks
          * Judging by this <a href="https://en.wikipedia.org/wiki/UTF-16#U+D800_to_U+DFFF">Wikipedia article</a> the standard does not allow
@@ -71,13 +168,15 @@ namespace utf {
          * convert "characters" in this range, though it is not recommended. By default the conversion is not strict. If you opt in to enable it
          * you also must be able to handle #status_e::non_standard_encoding return value separately.
          */
-        status_e utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char16_t>& utf16_s, bool comply_with_standard);
+        template <typename Sink>
+        constexpr status_e utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf16_sink, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
         /**
          * @brief This function converts UTF-8 string to UTF-32 string.
-         * 
+         *
          * @param[in] utf8_sv const reference to a string view representing UTF-8 string.
-         * @param[out] utf32_s reference to a string which will hold converted string.
+         * @param[out] utf32_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
          * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false.  Refer to "Remarks" for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
          * @return status specified by #status_e enum.
          * @remarks
          * Judging by this <a href="https://en.wikipedia.org/wiki/UTF-16#U+D800_to_U+DFFF">Wikipedia article</a> the standard does not allow
@@ -85,13 +184,15 @@ namespace utf {
          * convert "characters" in this range, though it is not recommended. By default the conversion is not strict. If you opt in to enable it
          * you also must be able to handle #status_e::non_standard_encoding return value separately.
          */
-        status_e utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char32_t>& utf32_s, bool comply_with_standard);
+        template <typename Sink>
+        constexpr status_e utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf32_sink, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
         /**
          * @brief This function converts UTF-16 string to UTF-8 string.
-         * 
+         *
          * @param[in] utf16_sv const reference to a string view representing UTF-16 string.
-         * @param[out] utf8_s reference to a string which will hold converted string.
+         * @param[out] utf8_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
          * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false.  Refer to "Remarks" for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
          * @return status specified by #status_e enum.
          * @remarks
          * Judging by this <a href="https://en.wikipedia.org/wiki/UTF-16#U+D800_to_U+DFFF">Wikipedia article</a> the standard does not allow
@@ -99,13 +200,15 @@ namespace utf {
          * convert "characters" in this range, though it is not recommended. By default the conversion is not strict. If you opt in to enable it
          * you also must be able to handle #status_e::non_standard_encoding return value separately.
          */
-        status_e utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char8_t>& utf8_s, bool comply_with_standard);
+        template <typename Sink>
+        constexpr status_e utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf8_sink, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
         /**
          * @brief This function converts UTF-16 string to UTF-32 string.
-         * 
+         *
          * @param[in] utf16_sv const reference to a string view representing UTF-16 string.
-         * @param[out] utf32_s reference to a string which will hold converted string.
+         * @param[out] utf32_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
          * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false.  Refer to "Remarks" for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
          * @return status specified by #status_e enum.
          * @remarks
          * Judging by this <a href="https://en.wikipedia.org/wiki/UTF-16#U+D800_to_U+DFFF">Wikipedia article</a> the standard does not allow
@@ -113,13 +216,15 @@ namespace utf {
          * convert "characters" in this range, though it is not recommended. By default the conversion is not strict. If you opt in to enable it
          * you also must be able to handle #status_e::non_standard_encoding return value separately.
          */
-        status_e utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char32_t>& utf32_s, bool comply_with_standard);
+        template <typename Sink>
+        constexpr status_e utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf32_sink, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
         /**
          * @brief This function converts UTF-32 string to UTF-8 string.
-         * 
+         *
          * @param[in] utf32_sv const reference to a string view representing UTF-32 string.
-         * @param[out] utf8_s reference to a string which will hold converted string.
+         * @param[out] utf8_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
          * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false.  Refer to "Remarks" for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
          * @return status specified by #status_e enum.
          * @remarks
          * Judging by this <a href="https://en.wikipedia.org/wiki/UTF-16#U+D800_to_U+DFFF">Wikipedia article</a> the standard does not allow
@@ -127,13 +232,15 @@ namespace utf {
          * convert "characters" in this range, though it is not recommended. By default the conversion is not strict. If you opt in to enable it
          * you also must be able to handle #status_e::non_standard_encoding return value separately.
          */
-        status_e utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char8_t>& utf8_s, bool comply_with_standard);
+        template <typename Sink>
+        constexpr status_e utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf8_sink, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
         /**
-         * @brief This function converts UTF-32 string to UTF-8 string.
-         * 
+         * @brief This function converts UTF-32 string to UTF-16 string.
+         *
          * @param[in] utf32_sv const reference to a string view representing UTF-32 string.
-         * @param[out] utf16_s reference to a string which will hold converted string.
+         * @param[out] utf16_sink container or output iterator which will receive converted string. Refer to @ref conv_funcs for details.
          * @param[in] comply_with_standard should the conversion function comply with Unicode standard. Defaults to @c false.  Refer to "Remarks" for details.
+         * @param[in] bom_policy what to do with the BOM. Defaults to #bom_e::keep.
          * @return status specified by #status_e enum.
          * @remarks
          * Judging by this <a href="https://en.wikipedia.org/wiki/UTF-16#U+D800_to_U+DFFF">Wikipedia article</a> the standard does not allow
@@ -141,7 +248,32 @@ namespace utf {
          * convert "characters" in this range, though it is not recommended. By default the conversion is not strict. If you opt in to enable it
          * you also must be able to handle #status_e::non_standard_encoding return value separately.
          */
-        status_e utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char16_t>& utf16_s, bool comply_with_standard);
+        template <typename Sink>
+        constexpr status_e utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf16_sink, bool comply_with_standard = false, bom_e bom_policy = bom_e::keep);
+
+#if defined(UTFUTILS_CALL_COMPILED)
+        /**
+         * @brief Conversions into @c std::basic_string compiled into the library.
+         * @details
+         * The templates above call them for a @c std::basic_string sink unless they're evaluated at compile time, so these
+         * conversions run with the optimization, @c -march (@c UTFUTILS_NATIVE_ARCH) and link-time optimization flags the
+         * library was built with rather than with those of the caller. Refer to the templates for the parameters.
+         */
+        namespace compiled {
+            UTFUTILS_API status_e utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char16_t>& utf16_string, bool comply_with_standard,
+                                                bom_e bom_policy);
+            UTFUTILS_API status_e utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char32_t>& utf32_string, bool comply_with_standard,
+                                                bom_e bom_policy);
+            UTFUTILS_API status_e utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char8_t>& utf8_string, bool comply_with_standard,
+                                                bom_e bom_policy);
+            UTFUTILS_API status_e utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char32_t>& utf32_string, bool comply_with_standard,
+                                                 bom_e bom_policy);
+            UTFUTILS_API status_e utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char8_t>& utf8_string, bool comply_with_standard,
+                                                bom_e bom_policy);
+            UTFUTILS_API status_e utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char16_t>& utf16_string, bool comply_with_standard,
+                                                 bom_e bom_policy);
+        } // namespace compiled
+#endif
 
         /**
          * @}
@@ -150,8 +282,7 @@ namespace utf {
     } // namespace conversion
 } // namespace utf
 
-//--------------------------------------------------IMPLEMENTATION--------------------------------------------------//
-#if defined IMPLEMENT_UTFUTILS
+//---------------------------------------------------INLINE HELPERS---------------------------------------------------//
 
 namespace utf {
     /**
@@ -288,6 +419,13 @@ namespace utf {
          * See <a href="https://en.wikipedia.org/wiki/Byte_order_mark">About BOM</a>.
         */
        constexpr uint16_t reversed_byte_order_mark     = 0xFFFE;
+        /**
+         * @internal
+         * @brief Replacement Character, substituted for code units which cannot be decoded.
+         * @details
+         * See <a href="https://en.wikipedia.org/wiki/Specials_(Unicode_block)#Replacement_character">Replacement character</a>.
+        */
+       constexpr uint16_t replacement_character       = 0xFFFD;
         /**
          * @}
          */
@@ -343,7 +481,7 @@ namespace utf {
      * See <a href="https://en.wikipedia.org/wiki/UTF-16#Code_points_from_U+010000_to_U+10FFFF">About surrogates</a>.
      */
     constexpr bool is_correct_code_point(const char32_t ch) {
-        return ch < constants::high_surrogate_start &&
+        return ch < constants::high_surrogate_start ||
                ch > constants::low_surrogate_end;
     }
     /**
@@ -371,13 +509,13 @@ namespace utf {
         }
     }
     constexpr char16_t utf16_reverse_endianness(const char16_t ch) {
-        int8_t first_byte  = ch >> 8;
-        int8_t second_byte = ch & 0xFF;
-        return (second_byte << 8) + first_byte;
+        const uint16_t first_byte  = ch >> 8;
+        const uint16_t second_byte = ch & 0xFF;
+        return static_cast<char16_t>((second_byte << 8) + first_byte);
     }
     constexpr endianness_e utf32_bom(const char32_t ch) {
-        int16_t first_word  = (ch >> 16) & 0xFFFF;
-        int16_t second_word =  ch        & 0xFFFF;
+        const uint16_t first_word  = (ch >> 16) & 0xFFFF;
+        const uint16_t second_word =  ch        & 0xFFFF;
 
         if (first_word == 0 && second_word == constants::byte_order_mark) {
             return endianness_e::big_endian;
@@ -388,343 +526,935 @@ namespace utf {
         return endianness_e::unspecified;
     }
     constexpr char32_t utf32_reverse_endianness(const char32_t ch) {
-        int8_t first_byte  =  ch >> 24;
-        int8_t second_byte = (ch >> 16) & 0xFF;
-        int8_t third_byte  = (ch >> 8)  & 0xFF;
-        int8_t fourth_byte =  ch        & 0xFF;
+        const uint32_t first_byte  =  ch >> 24;
+        const uint32_t second_byte = (ch >> 16) & 0xFF;
+        const uint32_t third_byte  = (ch >> 8)  & 0xFF;
+        const uint32_t fourth_byte =  ch        & 0xFF;
         return (fourth_byte << 24) + (third_byte << 16) + (second_byte << 8) + first_byte;
     }
-
     /**
-     * @}
+     * @internal
+     * @brief Checks if the call is evaluated at compile time.
+     * @details Before C++20 it can't tell and returns @c false, which is only right where the caller can't be evaluated at
+     * compile time before C++20 anyway, e.g. with a @c std::basic_string.
      */
-}
-
-using namespace utf;
-using namespace utf::conversion;
-using namespace utf::constants;
-
-status_e utf::conversion::utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char16_t>& utf16_s, bool comply_with_standard = false) {
-    // Convert to UTF-32
-    std::basic_string<char32_t> code_points;
-    status_e status = utf8_to_utf32(utf8_sv, code_points, comply_with_standard);
-    if (status < status_e::success) {
-        return status;
-    }
-    // Convert to UTF-16
-    std::basic_string<char16_t> result_string;
-    status = utf32_to_utf16(code_points, result_string, comply_with_standard);
-    if (status < status_e::success) {
-        return status;
-    }
-    utf16_s = result_string;
-    return status_e::success;
-}
-
-status_e utf::conversion::utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char32_t>& utf32_s, bool comply_with_standard = false) {
-    size_t code_unit_count = utf8_sv.size();
-
-    bool has_bom = false;
-    if (code_unit_count >= 3) {
-        has_bom = utf8_has_bom(utf8_sv.data());
-        if (has_bom) {
-            utf32_s.push_back(byte_order_mark);
-        }
+    constexpr bool is_constant_evaluated() {
+#if defined(__cpp_lib_is_constant_evaluated)
+        return std::is_constant_evaluated();
+#else
+        return false;
+#endif
     }
+    /**
+     * @internal
+     * @brief @c true if the host is big-endian.
+     */
+    constexpr bool host_is_big_endian =
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        true;
+#else
+        false;
+#endif
 
-    // if we have bom, we start from the 4th character in the string as we've handled BOM earlier.
-    for (size_t index = has_bom ? 3 : 0; index < code_unit_count; index++) {
-        char8_t this_char      = utf8_sv[index];
-        uint8_t this_code_unit = static_cast<uint8_t>(this_char);
-        // if first bit is zero it's ANSI
-        if (this_code_unit >> 7 == 0) {
-            utf32_s.push_back(this_char);
 
-            continue;
+    /**
+     * @internal
+     * @brief Decodes one UTF-8 character.
+     * @param[in,out] it pointer to the leading code unit. It is moved past the character on success.
+     * @param[in] end pointer past the last code unit of the string.
+     * @param[out] code_point decoded code point.
+     * @param[in] comply_with_standard reject surrogate code points and overlong sequences.
+     * @return status specified by #conversion::status_e enum.
+     * @details
+     * See <a href="https://en.wikipedia.org/wiki/UTF-8#Encoding">Wikipedia UTF-8#Encoding</a>.
+     */
+    constexpr conversion::status_e utf8_decode(const char8_t*& it, const char8_t* end, char32_t& code_point, const bool comply_with_standard) {
+        const uint8_t leading_code_unit = static_cast<uint8_t>(*it);
+        // if first bit is zero it's ANSI
+        if (leading_code_unit >> 7 == 0) {
+            code_point = leading_code_unit;
+            ++it;
+            return conversion::status_e::success;
         }
         // if first byte is "is trailing" for some reason
-        if (this_code_unit >> 6 == trailing_byte_marker) {
-            utf32_s.clear();
-            return status_e::trailing_without_leading;
-        }
-        // if first byte denotes double character
-        if (this_code_unit >> 5 == double_byte_marker) {
-            // get rid of markers
-            uint16_t first_bits = (this_code_unit & 0x1F) << 6;
-
-            // next byte
-            if (++index >= code_unit_count) {
-                utf32_s.clear();
-                return status_e::character_cut_off;
-            }
-            this_char      = utf8_sv[index];
-            this_code_unit = static_cast<uint8_t>(this_char);
-            // ~next byte
-
-            uint16_t last_bits = static_cast<uint16_t>(this_code_unit & 0x3F);
-            // create code point
-            char16_t code_point = first_bits + last_bits;
-            utf32_s.push_back(code_point);
-
-            continue;
-        }
-        // if first byte denotes triple character
-        if (this_code_unit >> 4 == triple_byte_marker) {
-            // get rid of markers
-            uint16_t first_bits = (this_code_unit & 0xF) << 12;
-
-            // next byte
-            if (++index >= code_unit_count) {
-                utf32_s.clear();
-                return status_e::character_cut_off;
-            }
-            this_char      = utf8_sv[index];
-            this_code_unit = static_cast<uint8_t>(this_char);
-            // ~next byte
+        if (leading_code_unit >> 6 == constants::trailing_byte_marker) {
+            return conversion::status_e::trailing_without_leading;
+        }
 
-            uint16_t middle_bits = (this_code_unit & 0x3F) << 6;
+        // get rid of markers
+        size_t   trailing_count = 0;
+        char32_t result         = 0;
+        char32_t shortest_form  = 0;
+        if (leading_code_unit >> 5 == constants::double_byte_marker) {
+            trailing_count = 1;
+            result         = leading_code_unit & 0x1F;
+            shortest_form  = constants::one_byte_boundary + 1;
+        }
+        else if (leading_code_unit >> 4 == constants::triple_byte_marker) {
+            trailing_count = 2;
+            result         = leading_code_unit & 0xF;
+            shortest_form  = constants::two_byte_boundary + 1;
+        }
+        else if (leading_code_unit >> 3 == constants::quadruple_byte_marker) {
+            trailing_count = 3;
+            result         = leading_code_unit & 0x7;
+            shortest_form  = constants::three_byte_boundary + 1;
+        }
+        else {
+            return conversion::status_e::undefined_error;
+        }
 
-            // next byte
-            if (++index >= code_unit_count) {
-                utf32_s.clear();
-                return status_e::character_cut_off;
+        if (static_cast<size_t>(end - it) <= trailing_count) {
+            return conversion::status_e::character_cut_off;
+        }
+        for (size_t index = 1; index <= trailing_count; index++) {
+            const uint8_t this_code_unit = static_cast<uint8_t>(it[index]);
+            // the sequence ended before the leading byte said it would
+            if (this_code_unit >> 6 != constants::trailing_byte_marker) {
+                return conversion::status_e::character_cut_off;
             }
-            this_char      = utf8_sv[index];
-            this_code_unit = static_cast<uint8_t>(this_char);
-            // ~next byte
-
-            uint16_t last_bits = this_code_unit & 0x3F;
+            result = (result << 6) + (this_code_unit & 0x3F);
+        }
 
-            char16_t code_point = first_bits + middle_bits + last_bits;
-            utf32_s.push_back(code_point);
-            continue;
+        if (result > constants::four_byte_boundary) {
+            return conversion::status_e::undefined_error;
+        }
+        if (comply_with_standard && (!is_correct_code_point(result) || result < shortest_form)) {
+            return conversion::status_e::non_standard_encoding;
+        }
+        code_point = result;
+        it += trailing_count + 1;
+        return conversion::status_e::success;
+    }
+    /**
+     * @internal
+     * @brief Decodes one UTF-8 character which ends right before @p it.
+     * @param[in] begin pointer to the first code unit of the string.
+     * @param[in,out] it pointer past the last code unit of the character. It is moved to the leading code unit on success.
+     * @param[out] code_point decoded code point.
+     * @param[in] comply_with_standard reject surrogate code points and overlong sequences.
+     * @return status specified by #conversion::status_e enum.
+     * @details
+     * UTF-8 is self-synchronizing: the leading code unit is found by skipping at most 3 trailing ones.
+     */
+    constexpr conversion::status_e utf8_decode_backward(const char8_t* begin, const char8_t*& it, char32_t& code_point, const bool comply_with_standard) {
+        const char8_t* start          = it - 1;
+        size_t         trailing_count = 0;
+        while (start != begin && trailing_count < 3 && static_cast<uint8_t>(*start) >> 6 == constants::trailing_byte_marker) {
+            --start;
+            ++trailing_count;
         }
-        // if first byte denotes quadruple character
-        if(this_code_unit >> 3 == quadruple_byte_marker) {
-            uint32_t first_bits = (this_code_unit & 0x7) << 18;
 
-            // next byte
-            if (++index >= code_unit_count) {
-                utf32_s.clear();
-                return status_e::character_cut_off;
-            }
-            this_char      = utf8_sv[index];
-            this_code_unit = static_cast<uint8_t>(this_char);
-            // ~next byte
+        const char8_t* cursor = start;
+        const conversion::status_e status = utf8_decode(cursor, it, code_point, comply_with_standard);
+        if (status != conversion::status_e::success) {
+            return status;
+        }
+        // the character found ends earlier, so the last code units are stray trailing ones
+        if (cursor != it) {
+            return conversion::status_e::trailing_without_leading;
+        }
+        it = start;
+        return conversion::status_e::success;
+    }
+    /**
+     * @internal
+     * @brief Returns the number of UTF-8 code units needed to encode the code point.
+     * @param code_point Code point to measure. Must not exceed @c U+10FFFF.
+     */
+    constexpr size_t utf8_code_unit_count(const char32_t code_point) {
+        if (code_point <= constants::one_byte_boundary) {
+            return 1;
+        }
+        if (code_point <= constants::two_byte_boundary) {
+            return 2;
+        }
+        if (code_point <= constants::three_byte_boundary) {
+            return 3;
+        }
+        return 4;
+    }
+    /**
+     * @internal
+     * @brief Encodes one code point as UTF-8.
+     * @param code_point Code point to encode. Must not exceed @c U+10FFFF.
+     * @param out Output iterator to write code units to.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename OutputIt>
+    constexpr OutputIt utf8_encode(const char32_t code_point, OutputIt out) {
+        if (code_point <= constants::one_byte_boundary) {
+            *out = static_cast<char8_t>(code_point);
+            ++out;
+            return out;
+        }
+        if (code_point <= constants::two_byte_boundary) {
+            *out = static_cast<char8_t>((constants::double_byte_marker   << 5) + (code_point >> 6));
+            ++out;
+            *out = static_cast<char8_t>((constants::trailing_byte_marker << 6) + (code_point & 0x3F));
+            ++out;
+            return out;
+        }
+        if (code_point <= constants::three_byte_boundary) {
+            *out = static_cast<char8_t>((constants::triple_byte_marker   << 4) + (code_point >> 12));
+            ++out;
+            *out = static_cast<char8_t>((constants::trailing_byte_marker << 6) + ((code_point >> 6) & 0x3F));
+            ++out;
+            *out = static_cast<char8_t>((constants::trailing_byte_marker << 6) + (code_point & 0x3F));
+            ++out;
+            return out;
+        }
+        *out = static_cast<char8_t>((constants::quadruple_byte_marker << 3) + (code_point >> 18));
+        ++out;
+        *out = static_cast<char8_t>((constants::trailing_byte_marker  << 6) + ((code_point >> 12) & 0x3F));
+        ++out;
+        *out = static_cast<char8_t>((constants::trailing_byte_marker  << 6) + ((code_point >> 6) & 0x3F));
+        ++out;
+        *out = static_cast<char8_t>((constants::trailing_byte_marker  << 6) + (code_point & 0x3F));
+        ++out;
+        return out;
+    }
 
-            uint32_t second_bits = static_cast<uint32_t>(this_code_unit & 0x3F) << 12;
+    /**
+     * @internal
+     * @brief Decodes one UTF-16 character (a single code unit or a surrogate pair).
+     * @param[in,out] it pointer to the first code unit. It is moved past the character on success.
+     * @param[in] end pointer past the last code unit of the string.
+     * @param[out] code_point decoded code point.
+     * @param[in] comply_with_standard reject unpaired surrogates.
+     * @param[in] reverse the string has the opposite byte order.
+     * @return status specified by #conversion::status_e enum.
+     * @details
+     * See <a href="https://en.wikipedia.org/wiki/UTF-16#Code_points_from_U+010000_to_U+10FFFF">About surrogates</a>.
+     */
+    constexpr conversion::status_e utf16_decode(const char16_t*& it, const char16_t* end, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+        const char16_t this_character = reverse ? utf16_reverse_endianness(*it) : *it;
 
-            // next byte
-            if (++index >= code_unit_count) {
-                utf32_s.clear();
-                return status_e::character_cut_off;
+        // if can be part of double character
+        if (is_high_surrogate(this_character) && end - it > 1) {
+            const char16_t next_character = reverse ? utf16_reverse_endianness(it[1]) : it[1];
+            if (is_low_surrogate(next_character)) {
+                // do decoding "double UTF-16" -> UTF-32:
+                // https://en.wikipedia.org/wiki/UTF-16#Code_points_from_U+010000_to_U+10FFFF
+                const char32_t high_code_point = static_cast<char32_t>(this_character - constants::high_surrogate_start) << 10;
+                const char32_t low_code_point  = next_character - constants::low_surrogate_start;
+                code_point = high_code_point + low_code_point + constants::supplementary_plane_offset;
+                it += 2;
+                return conversion::status_e::success;
             }
-            this_char      = utf8_sv[index];
-            this_code_unit = static_cast<uint8_t>(this_char);
-            // ~next byte
-            uint32_t third_bits = static_cast<uint32_t>(this_code_unit & 0x3F) << 6;
-
-            // next byte
-            if (++index >= code_unit_count) {
-                utf32_s.clear();
-                return status_e::character_cut_off;
+        }
+        // an unpaired surrogate is added as a code point unless we comply with the standard
+        if (comply_with_standard && !is_correct_code_point(this_character)) {
+            return conversion::status_e::non_standard_encoding;
+        }
+        code_point = this_character;
+        ++it;
+        return conversion::status_e::success;
+    }
+    /**
+     * @internal
+     * @brief Decodes one UTF-16 character which ends right before @p it.
+     * @param[in] begin pointer to the first code unit of the string.
+     * @param[in,out] it pointer past the last code unit of the character. It is moved to the first code unit on success.
+     * @param[out] code_point decoded code point.
+     * @param[in] comply_with_standard reject unpaired surrogates.
+     * @param[in] reverse the string has the opposite byte order.
+     * @return status specified by #conversion::status_e enum.
+     */
+    constexpr conversion::status_e utf16_decode_backward(const char16_t* begin, const char16_t*& it, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+        const char16_t* start = it - 1;
+        if (start != begin) {
+            const char16_t this_character     = reverse ? utf16_reverse_endianness(*start)  : *start;
+            const char16_t previous_character = reverse ? utf16_reverse_endianness(start[-1]) : start[-1];
+            if (is_low_surrogate(this_character) && is_high_surrogate(previous_character)) {
+                --start;
             }
-            this_char      = utf8_sv[index];
-            this_code_unit = static_cast<uint8_t>(this_char);
-            // ~next byte
-            uint32_t last_bits = static_cast<uint32_t>(this_code_unit & 0x3F);
-
+        }
 
-            char32_t code_point = first_bits + second_bits + third_bits + last_bits;
-            utf32_s.push_back(code_point);
-            continue;
+        const char16_t* cursor = start;
+        const conversion::status_e status = utf16_decode(cursor, it, code_point, comply_with_standard, reverse);
+        if (status != conversion::status_e::success) {
+            return status;
         }
+        it = start;
+        return conversion::status_e::success;
     }
-    return status_e::success;
-}
-
-status_e utf::conversion::utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char8_t>& utf8_s, bool comply_with_standard = false) {
-    // Convert to UTF-32
-    std::basic_string<char32_t> code_points;
-    status_e status = utf16_to_utf32(utf16_sv, code_points, comply_with_standard);
-    if (status < status_e::success) {
-        return status;
+    /**
+     * @internal
+     * @brief Returns the number of UTF-16 code units needed to encode the code point.
+     * @param code_point Code point to measure. Must not exceed @c U+10FFFF.
+     */
+    constexpr size_t utf16_code_unit_count(const char32_t code_point) {
+        return code_point >= constants::supplementary_plane_offset ? 2 : 1;
     }
-    // Convert to UTF-8
-    std::basic_string<char8_t> result_string;
-    status = utf32_to_utf8(code_points, result_string, comply_with_standard);
-    if (status < status_e::success) {
-        return status;
+    /**
+     * @internal
+     * @brief Encodes one code point as UTF-16.
+     * @param code_point Code point to encode. Must not exceed @c U+10FFFF.
+     * @param out Output iterator to write code units to.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename OutputIt>
+    constexpr OutputIt utf16_encode(const char32_t code_point, OutputIt out) {
+        if (code_point >= constants::supplementary_plane_offset) {
+            const char32_t surrogate_data = code_point - constants::supplementary_plane_offset;
+
+            *out = static_cast<char16_t>(constants::high_surrogate_start + (surrogate_data >> 10));
+            ++out;
+            *out = static_cast<char16_t>(constants::low_surrogate_start  + (surrogate_data & 0x3FF));
+            ++out;
+            return out;
+        }
+        *out = static_cast<char16_t>(code_point);
+        ++out;
+        return out;
     }
 
-    utf8_s = result_string;
-    return status_e::success;
-}
-
-status_e utf::conversion::utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char32_t>& utf32_s, bool comply_with_standard = false) {
-    const bool reverse = utf16_bom(utf16_sv[0]) == endianness_e::little_endian;
-
-    bool was_double_character = false;
-    for (auto character_it = utf16_sv.begin(); character_it != utf16_sv.end(); character_it++) {
-        // skip this character, because we handled it last iteration
-        if (was_double_character) {
-            was_double_character = false;
-            continue;
+    /**
+     * @internal
+     * @brief Decodes one UTF-32 character.
+     * @param[in,out] it pointer to the code unit. It is moved past the character on success.
+     * @param[in] end pointer past the last code unit of the string.
+     * @param[out] code_point decoded code point.
+     * @param[in] comply_with_standard reject surrogate code points.
+     * @param[in] reverse the string has the opposite byte order.
+     * @return status specified by #conversion::status_e enum.
+     */
+    constexpr conversion::status_e utf32_decode(const char32_t*& it, const char32_t* end, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+        static_cast<void>(end);
+        const char32_t this_code_point = reverse ? utf32_reverse_endianness(*it) : *it;
+        if (this_code_point > constants::four_byte_boundary) {
+            return conversion::status_e::undefined_error;
         }
-        // get this character
-        const char16_t this_character = reverse ? utf16_reverse_endianness(*character_it) : *character_it;
-
-        // get next character iterator
-        const auto next_character_it = character_it + 1;
+        if (comply_with_standard && !is_correct_code_point(this_code_point)) {
+            return conversion::status_e::non_standard_encoding;
+        }
+        code_point = this_code_point;
+        ++it;
+        return conversion::status_e::success;
+    }
+    /**
+     * @internal
+     * @brief Decodes one UTF-32 character which ends right before @p it.
+     * @param[in] begin pointer to the first code unit of the string.
+     * @param[in,out] it pointer past the code unit. It is moved to the code unit on success.
+     * @param[out] code_point decoded code point.
+     * @param[in] comply_with_standard reject surrogate code points.
+     * @param[in] reverse the string has the opposite byte order.
+     * @return status specified by #conversion::status_e enum.
+     */
+    constexpr conversion::status_e utf32_decode_backward(const char32_t* begin, const char32_t*& it, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+        static_cast<void>(begin);
+        const char32_t* start  = it - 1;
+        const char32_t* cursor = start;
+        const conversion::status_e status = utf32_decode(cursor, it, code_point, comply_with_standard, reverse);
+        if (status != conversion::status_e::success) {
+            return status;
+        }
+        it = start;
+        return conversion::status_e::success;
+    }
+    /**
+     * @internal
+     * @brief Encodes one code point as UTF-32.
+     * @param code_point Code point to encode.
+     * @param out Output iterator to write the code unit to.
+     * @return Iterator past the written code unit.
+     */
+    template <typename OutputIt>
+    constexpr OutputIt utf32_encode(const char32_t code_point, OutputIt out) {
+        *out = code_point;
+        ++out;
+        return out;
+    }
 
-        // check if this character is the last one
-        const bool exists_next_character = next_character_it != utf16_sv.end();
-        char16_t next_character;
+    /**
+     * @internal
+     * @brief Binds decoding and encoding functions of a single encoding to its code unit type.
+     * @tparam CharT code unit type: @c char8_t, @c char16_t or @c char32_t.
+     */
+    template <typename CharT>
+    struct encoding_traits;
 
-        // get next character if there is one
-        if (exists_next_character) {
-            next_character = reverse ? utf16_reverse_endianness(*next_character_it) : *next_character_it;
+    /**
+     * @internal
+     * @brief UTF-8 encoding traits.
+     */
+    template <>
+    struct encoding_traits<char8_t> {
+        static constexpr bool is_reversed(const std::basic_string_view<char8_t>&) {
+            return false;
+        }
+        static constexpr char8_t reverse_endianness(const char8_t code_unit) {
+            return code_unit;
+        }
+        static constexpr conversion::status_e decode(const char8_t*& it, const char8_t* end, char32_t& code_point, const bool comply_with_standard, const bool) {
+            return utf8_decode(it, end, code_point, comply_with_standard);
+        }
+        static constexpr conversion::status_e decode_backward(const char8_t* begin, const char8_t*& it, char32_t& code_point, const bool comply_with_standard, const bool) {
+            return utf8_decode_backward(begin, it, code_point, comply_with_standard);
+        }
+        static constexpr size_t code_unit_count(const char32_t code_point) {
+            return utf8_code_unit_count(code_point);
+        }
+        template <typename OutputIt>
+        static constexpr OutputIt encode(const char32_t code_point, OutputIt out) {
+            return utf8_encode(code_point, out);
+        }
+    };
+    /**
+     * @internal
+     * @brief UTF-16 encoding traits. The byte order is guessed from the BOM.
+     */
+    template <>
+    struct encoding_traits<char16_t> {
+        static constexpr bool is_reversed(const std::basic_string_view<char16_t>& sv) {
+            return !sv.empty() && utf16_bom(sv[0]) == endianness_e::little_endian;
+        }
+        static constexpr char16_t reverse_endianness(const char16_t code_unit) {
+            return utf16_reverse_endianness(code_unit);
+        }
+        static constexpr conversion::status_e decode(const char16_t*& it, const char16_t* end, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+            return utf16_decode(it, end, code_point, comply_with_standard, reverse);
+        }
+        static constexpr conversion::status_e decode_backward(const char16_t* begin, const char16_t*& it, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+            return utf16_decode_backward(begin, it, code_point, comply_with_standard, reverse);
+        }
+        static constexpr size_t code_unit_count(const char32_t code_point) {
+            return utf16_code_unit_count(code_point);
+        }
+        template <typename OutputIt>
+        static constexpr OutputIt encode(const char32_t code_point, OutputIt out) {
+            return utf16_encode(code_point, out);
+        }
+    };
+    /**
+     * @internal
+     * @brief UTF-32 encoding traits. The byte order is guessed from the BOM.
+     */
+    template <>
+    struct encoding_traits<char32_t> {
+        static constexpr bool is_reversed(const std::basic_string_view<char32_t>& sv) {
+            return !sv.empty() && utf32_bom(sv[0]) == endianness_e::little_endian;
         }
+        static constexpr char32_t reverse_endianness(const char32_t code_unit) {
+            return utf32_reverse_endianness(code_unit);
+        }
+        static constexpr conversion::status_e decode(const char32_t*& it, const char32_t* end, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+            return utf32_decode(it, end, code_point, comply_with_standard, reverse);
+        }
+        static constexpr conversion::status_e decode_backward(const char32_t* begin, const char32_t*& it, char32_t& code_point, const bool comply_with_standard, const bool reverse) {
+            return utf32_decode_backward(begin, it, code_point, comply_with_standard, reverse);
+        }
+        static constexpr size_t code_unit_count(const char32_t) {
+            return 1;
+        }
+        template <typename OutputIt>
+        static constexpr OutputIt encode(const char32_t code_point, OutputIt out) {
+            return utf32_encode(code_point, out);
+        }
+    };
 
-        // if can be part of double character
-        if (is_high_surrogate(this_character)) {
-            // if there is no next character we add this as code point
-            if (!exists_next_character) {
-                if (comply_with_standard) {
-                    utf32_s.clear();
-                    return status_e::non_standard_encoding;
-                }
-                utf32_s.push_back(this_character);
+    /**
+     * @internal
+     * @brief Validates the string and computes the length of its representation in another encoding.
+     * @tparam InputCharT code unit type of the source encoding.
+     * @tparam OutputCharT code unit type of the target encoding.
+     * @param[in] input source string.
+     * @param[out] output_size number of target code units. Only set on success.
+     * @param[in] comply_with_standard should the conversion comply with Unicode standard.
+     * @param[in] reverse the source string has the opposite byte order.
+     * @return status specified by #conversion::status_e enum.
+     */
+    template <typename InputCharT, typename OutputCharT>
+    constexpr conversion::status_e transcoded_size(const std::basic_string_view<InputCharT>& input, size_t& output_size, const bool comply_with_standard, const bool reverse) {
+        const InputCharT* it      = input.data();
+        const InputCharT* end     = it + input.size();
+
+        size_t result = 0;
+        while (it != end) {
+            char32_t code_point = 0;
+            const conversion::status_e status = encoding_traits<InputCharT>::decode(it, end, code_point, comply_with_standard, reverse);
+            if (status != conversion::status_e::success) {
+                return status;
+            }
+            result += encoding_traits<OutputCharT>::code_unit_count(code_point);
+        }
+        output_size = result;
+        return conversion::status_e::success;
+    }
+    /**
+     * @internal
+     * @brief Validates the string and computes the length of its representation in another encoding.
+     * The byte order of the source string is guessed from the BOM.
+     */
+    template <typename InputCharT, typename OutputCharT>
+    constexpr conversion::status_e transcoded_size(const std::basic_string_view<InputCharT>& input, size_t& output_size, const bool comply_with_standard) {
+        return transcoded_size<InputCharT, OutputCharT>(input, output_size, comply_with_standard, encoding_traits<InputCharT>::is_reversed(input));
+    }
+    /**
+     * @internal
+     * @brief Converts a string which was already validated by #transcoded_size.
+     * @tparam InputCharT code unit type of the source encoding.
+     * @tparam OutputCharT code unit type of the target encoding.
+     * @param input source string.
+     * @param out output iterator to write target code units to.
+     * @param input_reverse the source string has the opposite byte order.
+     * @param output_reverse the target code units are written in the opposite byte order.
+     * @return Iterator past the last written code unit.
+     */
+    template <typename InputCharT, typename OutputCharT, typename OutputIt>
+    constexpr OutputIt transcode_validated(const std::basic_string_view<InputCharT>& input, OutputIt out, const bool input_reverse, const bool output_reverse) {
+        const InputCharT* it  = input.data();
+        const InputCharT* end = it + input.size();
+
+        while (it != end) {
+            char32_t code_point = 0;
+            // validation already happened, non-strict decoding cannot fail and yields the same code points
+            encoding_traits<InputCharT>::decode(it, end, code_point, false, input_reverse);
+            if (!output_reverse) {
+                out = encoding_traits<OutputCharT>::encode(code_point, out);
                 continue;
             }
-
-            // if next character is not part of the double character we add this as code point
-            if (!is_low_surrogate(next_character)) {
-                if (comply_with_standard) {
-                    utf32_s.clear();
-                    return status_e::non_standard_encoding;
-                }
-                utf32_s.push_back(this_character);
+            OutputCharT        code_units[4] {};
+            const OutputCharT* code_units_end = encoding_traits<OutputCharT>::encode(code_point, code_units);
+            for (const OutputCharT* code_unit = code_units; code_unit != code_units_end; ++code_unit) {
+                *out = encoding_traits<OutputCharT>::reverse_endianness(*code_unit);
+                ++out;
+            }
+        }
+        return out;
+    }
+    /**
+     * @internal
+     * @brief Converts a string which was already validated by #transcoded_size.
+     * The byte order of the source string is guessed from the BOM, the target is written in host byte order.
+     */
+    template <typename InputCharT, typename OutputCharT, typename OutputIt>
+    constexpr OutputIt transcode_validated(const std::basic_string_view<InputCharT>& input, OutputIt out) {
+        return transcode_validated<InputCharT, OutputCharT>(input, out, encoding_traits<InputCharT>::is_reversed(input), false);
+    }
+    /**
+     * @internal
+     * @brief Checks if code units of the encoding have to be byte-swapped on this host.
+     * @param encoding encoding of the string.
+     * @param sv the string, used to look for a BOM if the encoding doesn't specify byte order. Pass an empty one for output.
+     */
+    template <typename CharT>
+    constexpr bool needs_byte_swap(const encoding_e encoding, const std::basic_string_view<CharT>& sv) {
+        switch (encoding) {
+            case encoding_e::utf16_le:
+            case encoding_e::utf32_le:
+                return host_is_big_endian;
+            case encoding_e::utf16_be:
+            case encoding_e::utf32_be:
+                return !host_is_big_endian;
+            default:
+                return encoding_traits<CharT>::is_reversed(sv);
+        }
+    }
+    /**
+     * @internal
+     * @brief Computes the length of the longest prefix which doesn't end with an incomplete character.
+     * @param sv the string.
+     * @param reverse the string has the opposite byte order.
+     * @return Number of code units in the prefix. Invalid sequences count as complete, so they're reported right away.
+     */
+    constexpr size_t complete_prefix_size(const std::basic_string_view<char8_t>& sv, bool) {
+        // the last leading byte within the longest sequence length
+        for (size_t tail = 1; tail <= 4 && tail <= sv.size(); ++tail) {
+            const uint8_t code_unit = static_cast<uint8_t>(sv[sv.size() - tail]);
+            if ((code_unit & 0xC0) == 0x80) {
                 continue;
             }
+            size_t length = 1;
+            if ((code_unit & 0xE0) == 0xC0) {
+                length = 2;
+            } else if ((code_unit & 0xF0) == 0xE0) {
+                length = 3;
+            } else if ((code_unit & 0xF8) == 0xF0) {
+                length = 4;
+            }
+            return length > tail ? sv.size() - tail : sv.size();
+        }
+        return sv.size();
+    }
+    constexpr size_t complete_prefix_size(const std::basic_string_view<char16_t>& sv, const bool reverse) {
+        if (sv.empty()) {
+            return 0;
+        }
+        const char16_t last = reverse ? utf16_reverse_endianness(sv.back()) : sv.back();
+        return is_high_surrogate(last) ? sv.size() - 1 : sv.size();
+    }
+    constexpr size_t complete_prefix_size(const std::basic_string_view<char32_t>& sv, bool) {
+        return sv.size();
+    }
+    /**
+     * @internal
+     * @brief Computes the length of the BOM at the start of the string.
+     * @param sv the string.
+     * @param reverse the string has the opposite byte order.
+     * @return Number of code units of the BOM, @c 0 if there is none.
+     */
+    template <typename CharT>
+    constexpr size_t bom_size(const std::basic_string_view<CharT>& sv, const bool reverse) {
+        if constexpr (sizeof(CharT) == 1) {
+            return sv.size() >= 3 && utf8_has_bom(sv.data()) ? 3 : 0;
+        }
+        else {
+            return !sv.empty() && (reverse ? encoding_traits<CharT>::reverse_endianness(sv[0]) : sv[0]) == constants::byte_order_mark ? 1 : 0;
+        }
+    }
+    /**
+     * @internal
+     * @brief Applies the BOM policy to the source string.
+     * @param input source string.
+     * @param bom_policy what to do with the BOM.
+     * @param reverse the source string has the opposite byte order.
+     * @param[out] add_bom receives whether a BOM has to be written in front of the converted string.
+     * @return The part of the source string to convert.
+     */
+    template <typename InputCharT>
+    constexpr std::basic_string_view<InputCharT> apply_bom_policy(const std::basic_string_view<InputCharT>& input, const bom_e bom_policy,
+                                                                  const bool reverse, bool& add_bom) {
+        const size_t input_bom_size = bom_size(input, reverse);
+        add_bom = bom_policy == bom_e::add && input_bom_size == 0;
+        return bom_policy == bom_e::strip ? input.substr(input_bom_size) : input;
+    }
 
-            // it turned out we have a double character
-            was_double_character = true;
-
-            // do decoding "double UTF-16" -> UTF-32:
-            // https://en.wikipedia.org/wiki/UTF-16#Code_points_from_U+010000_to_U+10FFFF
-            const char32_t high_code_point = (this_character - high_surrogate_start) << 10;
-            const char16_t low_code_point  = next_character - low_surrogate_start;
-            const char32_t code_point      = high_code_point + low_code_point + supplementary_plane_offset;
-            utf32_s.push_back(code_point);
+    /**
+     * @internal
+     * @brief Checks if the sink is a contiguous resizable container.
+     */
+    template <typename Sink, typename = void>
+    struct is_resizable_container : std::false_type {};
+    /**
+     * @internal
+     * @brief Checks if the sink is a contiguous resizable container.
+     */
+    template <typename Sink>
+    struct is_resizable_container<Sink, std::void_t<typename Sink::value_type,
+                                                    decltype(std::declval<Sink&>().data()),
+                                                    decltype(std::declval<Sink&>().resize(size_t{})),
+                                                    decltype(std::declval<Sink&>().clear())>> : std::true_type {};
+    /**
+     * @internal
+     * @brief Checks if the sink is a @c std::basic_string.
+     */
+    template <typename Sink>
+    struct is_basic_string : std::false_type {};
+    /**
+     * @internal
+     * @brief Checks if the sink is a @c std::basic_string.
+     */
+    template <typename CharT, typename Traits, typename Allocator>
+    struct is_basic_string<std::basic_string<CharT, Traits, Allocator>> : std::true_type {};
 
-            continue;
+    /**
+     * @internal
+     * @brief Calls @p function with a value of the code unit type of the encoding, i.e. turns #encoding_e into a type.
+     * @param encoding encoding to dispatch on.
+     * @param function generic callable taking @c char8_t, @c char16_t or @c char32_t and returning #conversion::status_e.
+     * @return Result of @p function or #conversion::status_e::undefined_error if the encoding is unknown.
+     */
+    template <typename Function>
+    constexpr conversion::status_e with_code_unit_type(const encoding_e encoding, Function&& function) {
+        switch (encoding) {
+            case encoding_e::utf8:
+                return function(char8_t{});
+            case encoding_e::utf16:
+            case encoding_e::utf16_le:
+            case encoding_e::utf16_be:
+                return function(char16_t{});
+            case encoding_e::utf32:
+            case encoding_e::utf32_le:
+            case encoding_e::utf32_be:
+                return function(char32_t{});
         }
-
-        // if not a double character add this as next code point
-        utf32_s.push_back(this_character);
+        return conversion::status_e::undefined_error;
     }
-    return status_e::success;
-}
 
-status_e utf::conversion::utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char8_t>& utf8_s, bool comply_with_standard = false) {
-    bool reverse = utf32_bom(utf32_sv[0]) == endianness_e::little_endian;
+    /**
+     * @internal
+     * @brief Resizes a contiguous container and lets @p writer fill all of it.
+     * @param container container to resize.
+     * @param size new size of the container.
+     * @param writer callable receiving pointer to the container's data which must write exactly @p size elements.
+     * @details
+     * On C++23 @c std::basic_string is resized with @c resize_and_overwrite, so its contents aren't zero-filled first.
+     */
+    template <typename Container, typename Writer>
+    constexpr void resize_and_write(Container& container, const size_t size, Writer&& writer) {
+#if defined(__cpp_lib_string_resize_and_overwrite)
+        if constexpr (is_basic_string<Container>::value) {
+            container.resize_and_overwrite(size, [&writer, size](typename Container::value_type* data, size_t) {
+                writer(data);
+                return size;
+            });
+        }
+        else
+#endif
+        {
+            container.resize(size);
+            writer(container.data());
+        }
+    }
 
-    for (char32_t this_code_point : utf32_sv) {
-        if (reverse) {
-            this_code_point = utf32_reverse_endianness(this_code_point);
+    /**
+     * @internal
+     * @brief Writes a validated conversion into a sink. Refer to @ref conv_funcs for details on sinks.
+     * @tparam OutputCharT code unit type of the target encoding.
+     * @param[out] sink container or output iterator.
+     * @param output_size exact number of code units to write.
+     * @param writer generic callable receiving pointer to the container's data or the output iterator.
+     */
+    template <typename OutputCharT, typename Sink, typename Writer>
+    constexpr void write_to_sink(Sink&& sink, const size_t output_size, Writer&& writer) {
+        using sink_t = std::remove_cv_t<std::remove_reference_t<Sink>>;
+        if constexpr (is_resizable_container<sink_t>::value) {
+            static_assert(sizeof(typename sink_t::value_type) == sizeof(OutputCharT), "Container's value_type must have the size of the target code unit");
+            resize_and_write(sink, output_size, writer);
         }
-        if (this_code_point > four_byte_boundary) {
-            utf8_s.clear();
-            return status_e::undefined_error;
+        else {
+            // arrays decay to pointers here
+            auto output = sink;
+            writer(output);
         }
-        if (this_code_point <= one_byte_boundary) {
-            utf8_s.push_back(static_cast<char8_t>(this_code_point));
-            continue;
+    }
+    /**
+     * @internal
+     * @brief Clears a container sink after a failed conversion, output iterators are left alone.
+     */
+    template <typename Sink>
+    constexpr void clear_sink(Sink&& sink) {
+        if constexpr (is_resizable_container<std::remove_cv_t<std::remove_reference_t<Sink>>>::value) {
+            sink.clear();
         }
-        if (this_code_point <= two_byte_boundary) {
-            const uint16_t cp_16       = static_cast<uint16_t>(this_code_point);
-
-            const uint8_t first_5_bits = cp_16 >>  6;
-            const uint8_t last_6_bits  = cp_16 & 0x3F;
-
-            utf8_s.push_back((double_byte_marker   << 5) + first_5_bits);
-            utf8_s.push_back((trailing_byte_marker << 6) + last_6_bits );
-
-            continue;
+        else {
+            static_cast<void>(sink);
         }
-        if (this_code_point <= three_byte_boundary) {
-            const uint16_t cp_16      = static_cast<uint16_t>(this_code_point);
+    }
 
-            const bool wrong_encoding = comply_with_standard        &&
-                                        cp_16 < low_surrogate_start ||
-                                        cp_16 > high_surrogate_start;
-            if (wrong_encoding) {
-                utf8_s.clear();
-                return status_e::non_standard_encoding;
+    /**
+     * @internal
+     * @brief Default writer of #transcode: the BOM if it's added, then the validated conversion.
+     */
+    template <typename InputCharT, typename OutputCharT>
+    struct validated_writer {
+        template <typename OutputIt>
+        constexpr void operator()(const std::basic_string_view<InputCharT>& body, OutputIt output, const bool reverse, const bool add_bom) const {
+            if (add_bom) {
+                output = encoding_traits<OutputCharT>::encode(constants::byte_order_mark, output);
             }
+            transcode_validated<InputCharT, OutputCharT>(body, output, reverse, false);
+        }
+    };
 
-            const uint8_t  first_4_bits  =  cp_16 >> 12;
-            const uint8_t  middle_6_bits = (cp_16 >> 6 ) & 0x3F;
-            const uint8_t  last_6_bits   =  cp_16        & 0x3F;
+    /**
+     * @internal
+     * @brief Converts a string and writes the result into a sink. Refer to @ref conv_funcs for details on sinks.
+     * @tparam InputCharT code unit type of the source encoding.
+     * @tparam OutputCharT code unit type of the target encoding.
+     * @param[in] input source string.
+     * @param[out] sink container or output iterator.
+     * @param[in] comply_with_standard should the conversion comply with Unicode standard.
+     * @param[in] bom_policy what to do with the BOM.
+     * @param[in] writer called once the source is validated with the source without its BOM, pointer to the container's
+     * data or the output iterator, whether the source is byte-swapped and whether to add the BOM. It must write exactly the
+     * measured number of code units, variants which also record something on the way pass their own. Defaults to
+     * #validated_writer.
+     * @return status specified by #conversion::status_e enum.
+     */
+    template <typename InputCharT, typename OutputCharT, typename Sink, typename Writer = validated_writer<InputCharT, OutputCharT>>
+    constexpr conversion::status_e transcode(const std::basic_string_view<InputCharT>& input, Sink&& sink, const bool comply_with_standard,
+                                             const bom_e bom_policy = bom_e::keep, Writer&& writer = Writer()) {
+        const bool                               reverse = encoding_traits<InputCharT>::is_reversed(input);
+        bool                                     add_bom = false;
+        const std::basic_string_view<InputCharT> body    = apply_bom_policy(input, bom_policy, reverse, add_bom);
+
+        size_t output_size = 0;
+        const conversion::status_e status = transcoded_size<InputCharT, OutputCharT>(body, output_size, comply_with_standard, reverse);
+        if (status != conversion::status_e::success) {
+            clear_sink(std::forward<Sink>(sink));
+            return status;
+        }
+        if (add_bom) {
+            output_size += encoding_traits<OutputCharT>::code_unit_count(constants::byte_order_mark);
+        }
+        write_to_sink<OutputCharT>(std::forward<Sink>(sink), output_size, [&](auto output) {
+            writer(body, output, reverse, add_bom);
+        });
+        return conversion::status_e::success;
+    }
 
-            utf8_s.push_back((triple_byte_marker   << 4) + first_4_bits );
-            utf8_s.push_back((trailing_byte_marker << 6) + middle_6_bits);
-            utf8_s.push_back((trailing_byte_marker << 6) + last_6_bits  );
+    /**
+     * @}
+     */
+}
 
-            continue;
+template <typename Sink>
+constexpr utf::conversion::status_e utf::conversion::utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf16_sink, bool comply_with_standard, bom_e bom_policy) {
+#if defined(UTFUTILS_CALL_COMPILED)
+    if constexpr (std::is_same_v<Sink, std::basic_string<char16_t>&>) {
+        if (!is_constant_evaluated()) {
+            return compiled::utf8_to_utf16(utf8_sv, utf16_sink, comply_with_standard, bom_policy);
         }
-        if (this_code_point <= four_byte_boundary) {
-            const uint8_t first_3_bits  =  this_code_point >> 18;
-            const uint8_t second_6_bits = (this_code_point >> 12) & 0x3F;
-            const uint8_t third_6_bits  = (this_code_point >> 6 ) & 0x3F;
-            const uint8_t last_6_bits   =  this_code_point        & 0x3F;
-
-            utf8_s.push_back((quadruple_byte_marker << 5) + first_3_bits );
-            utf8_s.push_back((trailing_byte_marker  << 6) + second_6_bits);
-            utf8_s.push_back((trailing_byte_marker  << 6) + third_6_bits );
-            utf8_s.push_back((trailing_byte_marker  << 6) + last_6_bits  );
+    }
+#endif
+    return transcode<char8_t, char16_t>(utf8_sv, std::forward<Sink>(utf16_sink), comply_with_standard, bom_policy);
+}
 
-            continue;
+template <typename Sink>
+constexpr utf::conversion::status_e utf::conversion::utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, Sink&& utf32_sink, bool comply_with_standard, bom_e bom_policy) {
+#if defined(UTFUTILS_CALL_COMPILED)
+    if constexpr (std::is_same_v<Sink, std::basic_string<char32_t>&>) {
+        if (!is_constant_evaluated()) {
+            return compiled::utf8_to_utf32(utf8_sv, utf32_sink, comply_with_standard, bom_policy);
         }
     }
+#endif
+    return transcode<char8_t, char32_t>(utf8_sv, std::forward<Sink>(utf32_sink), comply_with_standard, bom_policy);
+}
 
-    return status_e::success;
+template <typename Sink>
+constexpr utf::conversion::status_e utf::conversion::utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf8_sink, bool comply_with_standard, bom_e bom_policy) {
+#if defined(UTFUTILS_CALL_COMPILED)
+    if constexpr (std::is_same_v<Sink, std::basic_string<char8_t>&>) {
+        if (!is_constant_evaluated()) {
+            return compiled::utf16_to_utf8(utf16_sv, utf8_sink, comply_with_standard, bom_policy);
+        }
+    }
+#endif
+    return transcode<char16_t, char8_t>(utf16_sv, std::forward<Sink>(utf8_sink), comply_with_standard, bom_policy);
 }
 
-status_e utf::conversion::utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char16_t>& utf16_s, bool comply_with_standard = false) {
-    bool reverse = utf32_bom(utf32_sv[0]) == endianness_e::little_endian;
-    for (char32_t this_code_point : utf32_sv) {
-        if (reverse) {
-            this_code_point = utf32_reverse_endianness(this_code_point);
+template <typename Sink>
+constexpr utf::conversion::status_e utf::conversion::utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, Sink&& utf32_sink, bool comply_with_standard, bom_e bom_policy) {
+#if defined(UTFUTILS_CALL_COMPILED)
+    if constexpr (std::is_same_v<Sink, std::basic_string<char32_t>&>) {
+        if (!is_constant_evaluated()) {
+            return compiled::utf16_to_utf32(utf16_sv, utf32_sink, comply_with_standard, bom_policy);
         }
-        if (this_code_point >= supplementary_plane_end) {
-            utf16_s.clear();
-            return status_e::undefined_error;
+    }
+#endif
+    return transcode<char16_t, char32_t>(utf16_sv, std::forward<Sink>(utf32_sink), comply_with_standard, bom_policy);
+}
+
+template <typename Sink>
+constexpr utf::conversion::status_e utf::conversion::utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf8_sink, bool comply_with_standard, bom_e bom_policy) {
+#if defined(UTFUTILS_CALL_COMPILED)
+    if constexpr (std::is_same_v<Sink, std::basic_string<char8_t>&>) {
+        if (!is_constant_evaluated()) {
+            return compiled::utf32_to_utf8(utf32_sv, utf8_sink, comply_with_standard, bom_policy);
         }
-        if (!is_correct_code_point(this_code_point) && comply_with_standard) {
-            utf16_s.clear();
-            return status_e::non_standard_encoding;
+    }
+#endif
+    return transcode<char32_t, char8_t>(utf32_sv, std::forward<Sink>(utf8_sink), comply_with_standard, bom_policy);
+}
+
+template <typename Sink>
+constexpr utf::conversion::status_e utf::conversion::utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, Sink&& utf16_sink, bool comply_with_standard, bom_e bom_policy) {
+#if defined(UTFUTILS_CALL_COMPILED)
+    if constexpr (std::is_same_v<Sink, std::basic_string<char16_t>&>) {
+        if (!is_constant_evaluated()) {
+            return compiled::utf32_to_utf16(utf32_sv, utf16_sink, comply_with_standard, bom_policy);
         }
-        if (this_code_point >= supplementary_plane_offset) {
-            const int32_t  surrogate_data      = this_code_point - supplementary_plane_offset;
+    }
+#endif
+    return transcode<char32_t, char16_t>(utf32_sv, std::forward<Sink>(utf16_sink), comply_with_standard, bom_policy);
+}
 
-            const int16_t  high_surrogate_data = surrogate_data >> 10;
-            const int16_t  low_surrogate_data  = surrogate_data & 0x3FF;
+//-------------------------------------------------COMPILE-TIME LITERALS-------------------------------------------------//
+#if defined(__cpp_consteval) && defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
 
-            const char16_t high_surrogate      = high_surrogate_start + high_surrogate_data;
-            const char16_t low_surrogate       = low_surrogate_start  + low_surrogate_data;
+namespace utf {
+    /**
+     * @brief Null-terminated string of fixed length usable as a template argument.
+     * @tparam CharT code unit type.
+     * @tparam N number of code units including the null terminator.
+     */
+    template <typename CharT, size_t N>
+    struct fixed_string {
+        CharT code_units[N] {}; /**< Code units followed by the null terminator. */
 
-            utf16_s.push_back(high_surrogate);
-            utf16_s.push_back(low_surrogate);
+        constexpr fixed_string() = default;
+        /**
+         * @brief Copies a string literal.
+         */
+        constexpr fixed_string(const CharT (&str)[N]) {
+            for (size_t index = 0; index < N; index++) {
+                code_units[index] = str[index];
+            }
+        }
 
-            continue;
+        constexpr size_t size() const {
+            return N - 1;
         }
-        const char16_t character = static_cast<char16_t>(this_code_point);
-        utf16_s.push_back(character);
+        constexpr const CharT* data() const {
+            return code_units;
+        }
+        constexpr const CharT* c_str() const {
+            return code_units;
+        }
+        constexpr std::basic_string_view<CharT> view() const {
+            return std::basic_string_view<CharT>(code_units, N - 1);
+        }
+        constexpr operator std::basic_string_view<CharT>() const {
+            return view();
+        }
+    };
+
+    /**
+     * @internal
+     * @brief Converts the literal at compile time. An ill-formed literal makes the program ill-formed.
+     */
+    template <typename OutputCharT, fixed_string Literal>
+    consteval auto make_literal() {
+        using input_char_t = std::remove_cv_t<std::remove_extent_t<decltype(Literal.code_units)>>;
+
+        constexpr size_t output_size = [] {
+            size_t size = 0;
+            if (transcoded_size<input_char_t, OutputCharT>(Literal.view(), size, true) != conversion::status_e::success) {
+                throw "utf::literal: the string literal is not valid Unicode";
+            }
+            return size;
+        }();
+
+        fixed_string<OutputCharT, output_size + 1> result;
+        transcode_validated<input_char_t, OutputCharT>(Literal.view(), result.code_units);
+        return result;
     }
-    return status_e::success;
-}
 
-#endif // defined IMPLEMENT_UTFUTILS
-#endif // !defined(UTFUTILS_H)
\ No newline at end of file
+    /**
+     * @brief String literal converted to another UTF at compile time.
+     * @tparam OutputCharT target code unit type: @c char8_t, @c char16_t or @c char32_t.
+     * @tparam Literal UTF-8, UTF-16 or UTF-32 string literal.
+     * @details
+     * The result is a #fixed_string stored in read-only data, nothing is converted at run time:
+     * @code
+     * constexpr std::u16string_view greeting = utf::literal<char16_t, u8"Привет">;
+     * @endcode
+     * The conversion complies with the standard, an invalid literal fails to compile.
+     */
+    template <typename OutputCharT, fixed_string Literal>
+    inline constexpr auto literal = make_literal<OutputCharT, Literal>();
+    /**
+     * @brief String literal converted to UTF-8 at compile time. Refer to #literal for details.
+     */
+    template <fixed_string Literal>
+    inline constexpr auto utf8_literal  = literal<char8_t, Literal>;
+    /**
+     * @brief String literal converted to UTF-16 at compile time. Refer to #literal for details.
+     */
+    template <fixed_string Literal>
+    inline constexpr auto utf16_literal = literal<char16_t, Literal>;
+    /**
+     * @brief String literal converted to UTF-32 at compile time. Refer to #literal for details.
+     */
+    template <fixed_string Literal>
+    inline constexpr auto utf32_literal = literal<char32_t, Literal>;
+} // namespace utf
+
+#endif // defined(__cpp_consteval)
+
+#endif // !defined(UTFUTILS_H)
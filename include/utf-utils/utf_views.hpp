@@ -0,0 +1,310 @@
+#if !defined(UTFUTILS_VIEWS_H)
+#   define UTFUTILS_VIEWS_H
+
+#include "utf_decode.hpp"
+
+/**
+ * @file utf_views.hpp
+ * @brief Lazy transcoding views for C++20 ranges pipelines.
+ * @details
+ * The views decode and encode one character at a time while being iterated, so nothing is allocated and only the
+ * characters actually visited are transcoded, e.g. @c sv|utf::views::as_utf32|std::views::take(n) decodes @c n code points.
+ * Code units which cannot be decoded are presented as @c U+FFFD. Available only when compiling as C++20 or later.
+ */
+
+#if __cplusplus >= 202002L && __has_include(<ranges>)
+#   include <concepts>
+#   include <iterator>
+#   include <ranges>
+#endif
+
+#if defined(__cpp_lib_ranges)
+
+//----------------------------------------------------INTERFACE----------------------------------------------------//
+
+namespace utf {
+    /**
+     * @brief A range of UTF-8, UTF-16 or UTF-32 code units which can be decoded lazily.
+     */
+    template <typename Range>
+    concept decodable_range = std::ranges::contiguous_range<Range> &&
+                              std::ranges::sized_range<Range>      &&
+                              (std::same_as<std::ranges::range_value_t<Range>, char8_t>  ||
+                               std::same_as<std::ranges::range_value_t<Range>, char16_t> ||
+                               std::same_as<std::ranges::range_value_t<Range>, char32_t>);
+
+    /**
+     * @brief A range of code points which can be encoded lazily.
+     */
+    template <typename Range>
+    concept encodable_range = std::ranges::forward_range<Range> &&
+                              std::convertible_to<std::ranges::range_reference_t<Range>, char32_t>;
+
+    /**
+     * @brief View presenting UTF-8, UTF-16 or UTF-32 code units as code points.
+     * @details
+     * UTF-16 and UTF-32 byte order is guessed from the BOM just like the conversion functions do.
+     */
+    template <std::ranges::view View>
+        requires decodable_range<View>
+    class decode_view : public std::ranges::view_interface<decode_view<View>> {
+        using char_type = std::ranges::range_value_t<View>;
+
+    public:
+        using iterator = decode_iterator<char_type>;
+
+        decode_view() requires std::default_initializable<View> = default;
+        constexpr explicit decode_view(View base) : base_(std::move(base)) {}
+
+        constexpr View base() const& requires std::copy_constructible<View> {
+            return base_;
+        }
+        constexpr View base() && {
+            return std::move(base_);
+        }
+
+        constexpr iterator begin() const {
+            const std::basic_string_view<char_type> sv = code_units();
+            return iterator(sv.data(), sv.data(), sv.data() + sv.size(), encoding_traits<char_type>::is_reversed(sv));
+        }
+        constexpr iterator end() const {
+            const std::basic_string_view<char_type> sv = code_units();
+            return iterator(sv.data(), sv.data() + sv.size(), sv.data() + sv.size(), encoding_traits<char_type>::is_reversed(sv));
+        }
+
+    private:
+        constexpr std::basic_string_view<char_type> code_units() const {
+            return std::basic_string_view<char_type>(std::ranges::data(base_), std::ranges::size(base_));
+        }
+
+        View base_ = View();
+    };
+
+    template <typename Range>
+    decode_view(Range&&) -> decode_view<std::views::all_t<Range>>;
+
+    /**
+     * @brief View presenting code points as UTF-8, UTF-16 or UTF-32 code units.
+     * @tparam CharT target code unit type: @c char8_t, @c char16_t or @c char32_t.
+     * @details
+     * Code points above @c U+10FFFF are encoded as @c U+FFFD. The view is bidirectional if the underlying range is.
+     */
+    template <std::ranges::view View, typename CharT>
+        requires encodable_range<const View>
+    class encode_view : public std::ranges::view_interface<encode_view<View, CharT>> {
+        using base_iterator = std::ranges::iterator_t<const View>;
+        using base_sentinel = std::ranges::sentinel_t<const View>;
+
+    public:
+        /**
+         * @brief Iterator over the code units of the encoded code points.
+         */
+        class iterator {
+        public:
+            using iterator_concept  = std::conditional_t<std::ranges::bidirectional_range<const View>, std::bidirectional_iterator_tag, std::forward_iterator_tag>;
+            using iterator_category = iterator_concept;
+            using value_type        = CharT;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = void;
+            using reference         = CharT;
+
+            iterator() = default;
+            constexpr iterator(base_iterator current, base_sentinel end) : current_(std::move(current)), end_(std::move(end)) {
+                encode_current();
+            }
+
+            constexpr CharT operator*() const {
+                return code_units_[index_];
+            }
+            constexpr iterator& operator++() {
+                if (++index_ == count_) {
+                    ++current_;
+                    index_ = 0;
+                    encode_current();
+                }
+                return *this;
+            }
+            constexpr iterator operator++(int) {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+            constexpr iterator& operator--() requires std::ranges::bidirectional_range<const View> {
+                if (index_ == 0) {
+                    --current_;
+                    encode_current();
+                    index_ = count_ - 1;
+                    return *this;
+                }
+                --index_;
+                return *this;
+            }
+            constexpr iterator operator--(int) requires std::ranges::bidirectional_range<const View> {
+                iterator previous = *this;
+                --*this;
+                return previous;
+            }
+
+            /**
+             * @brief Returns iterator to the code point the current code unit belongs to.
+             */
+            constexpr const base_iterator& base() const {
+                return current_;
+            }
+
+            friend constexpr bool operator==(const iterator& lhs, const iterator& rhs) {
+                return lhs.current_ == rhs.current_ && lhs.index_ == rhs.index_;
+            }
+            friend constexpr bool operator==(const iterator& lhs, std::default_sentinel_t) {
+                return lhs.current_ == lhs.end_;
+            }
+
+        private:
+            constexpr void encode_current() {
+                if (current_ == end_) {
+                    count_ = 0;
+                    return;
+                }
+                char32_t code_point = *current_;
+                if (code_point > constants::four_byte_boundary) {
+                    code_point = constants::replacement_character;
+                }
+                count_ = static_cast<uint8_t>(encoding_traits<CharT>::encode(code_point, code_units_) - code_units_);
+            }
+
+            base_iterator current_{};
+            base_sentinel end_{};
+            CharT         code_units_[4]{};
+            uint8_t       count_ = 0;
+            uint8_t       index_ = 0;
+        };
+
+        encode_view() requires std::default_initializable<View> = default;
+        constexpr explicit encode_view(View base) : base_(std::move(base)) {}
+
+        constexpr View base() const& requires std::copy_constructible<View> {
+            return base_;
+        }
+        constexpr View base() && {
+            return std::move(base_);
+        }
+
+        constexpr iterator begin() const {
+            return iterator(std::ranges::begin(base_), std::ranges::end(base_));
+        }
+        constexpr auto end() const {
+            if constexpr (std::ranges::common_range<const View>) {
+                return iterator(std::ranges::end(base_), std::ranges::end(base_));
+            }
+            else {
+                return std::default_sentinel;
+            }
+        }
+
+    private:
+        View base_ = View();
+    };
+
+    /**
+     * @internal
+     * @brief Makes a range adaptor usable on the right-hand side of @c operator|.
+     */
+    template <typename Adaptor>
+    struct adaptor_closure {
+        template <typename Range>
+            requires std::invocable<const Adaptor&, Range>
+        friend constexpr auto operator|(Range&& range, const Adaptor& adaptor) {
+            return adaptor(std::forward<Range>(range));
+        }
+    };
+
+    /**
+     * @internal
+     * @brief Range adaptor creating #decode_view. If @p CharT is @c void, any code unit type is accepted.
+     */
+    template <typename CharT>
+    struct decode_adaptor : adaptor_closure<decode_adaptor<CharT>> {
+        template <std::ranges::viewable_range Range>
+            requires decodable_range<Range> && (std::is_void_v<CharT> || std::same_as<std::ranges::range_value_t<Range>, CharT>)
+        constexpr auto operator()(Range&& range) const {
+            return decode_view(std::views::all(std::forward<Range>(range)));
+        }
+    };
+
+    /**
+     * @internal
+     * @brief Range adaptor creating #encode_view.
+     */
+    template <typename CharT>
+    struct encode_adaptor : adaptor_closure<encode_adaptor<CharT>> {
+        template <std::ranges::viewable_range Range>
+            requires encodable_range<const std::views::all_t<Range>>
+        constexpr auto operator()(Range&& range) const {
+            return encode_view<std::views::all_t<Range>, CharT>(std::views::all(std::forward<Range>(range)));
+        }
+    };
+
+    /**
+     * @internal
+     * @brief Range adaptor decoding code units of any UTF and encoding them as @p CharT.
+     */
+    template <typename CharT>
+    struct transcode_adaptor : adaptor_closure<transcode_adaptor<CharT>> {
+        template <std::ranges::viewable_range Range>
+            requires decodable_range<Range>
+        constexpr auto operator()(Range&& range) const {
+            return encode_adaptor<CharT>{}(decode_adaptor<void>{}(std::forward<Range>(range)));
+        }
+    };
+
+    /**
+     * @namespace utf::views
+     * @brief This namespace contains range adaptor objects for lazy transcoding.
+     */
+    namespace views {
+        /**
+         * @brief Decodes a contiguous range of UTF-8 code units into code points.
+         */
+        inline constexpr decode_adaptor<char8_t>  decode_utf8;
+        /**
+         * @brief Decodes a contiguous range of UTF-16 code units into code points.
+         */
+        inline constexpr decode_adaptor<char16_t> decode_utf16;
+        /**
+         * @brief Decodes a contiguous range of UTF-32 code units into code points.
+         */
+        inline constexpr decode_adaptor<char32_t> decode_utf32;
+        /**
+         * @brief Encodes a range of code points as UTF-8 code units.
+         */
+        inline constexpr encode_adaptor<char8_t>  encode_utf8;
+        /**
+         * @brief Encodes a range of code points as UTF-16 code units.
+         */
+        inline constexpr encode_adaptor<char16_t> encode_utf16;
+        /**
+         * @brief Encodes a range of code points as UTF-32 code units.
+         */
+        inline constexpr encode_adaptor<char32_t> encode_utf32;
+        /**
+         * @brief Decodes a contiguous range of UTF-8, UTF-16 or UTF-32 code units into code points.
+         */
+        inline constexpr decode_adaptor<void>        as_utf32;
+        /**
+         * @brief Transcodes a contiguous range of UTF-8, UTF-16 or UTF-32 code units into UTF-16 code units.
+         */
+        inline constexpr transcode_adaptor<char16_t> as_utf16;
+        /**
+         * @brief Transcodes a contiguous range of UTF-8, UTF-16 or UTF-32 code units into UTF-8 code units.
+         */
+        inline constexpr transcode_adaptor<char8_t>  as_utf8;
+    } // namespace views
+} // namespace utf
+
+template <typename View>
+inline constexpr bool std::ranges::enable_borrowed_range<utf::decode_view<View>> = std::ranges::enable_borrowed_range<View>;
+template <typename View, typename CharT>
+inline constexpr bool std::ranges::enable_borrowed_range<utf::encode_view<View, CharT>> = std::ranges::enable_borrowed_range<View>;
+
+#endif // defined(__cpp_lib_ranges)
+#endif // !defined(UTFUTILS_VIEWS_H)
@@ -0,0 +1,49 @@
+/**
+ * @file utf_utils.cpp
+ * @brief Translation unit of the compiled utf-utils library.
+ * @details
+ * Emits everything the headers keep behind @c IMPLEMENT_UTFUTILS, i.e. all non-template functions, and the conversions
+ * into @c std::basic_string which the conversion templates call. Build it with the optimization and @c -march flags you
+ * want every consumer to benefit from.
+ */
+
+#define IMPLEMENT_UTFUTILS
+
+#include "utf-utils/utf_utils.hpp"
+#include "utf-utils/utf_file.hpp"
+#include "utf-utils/utf_stream.hpp"
+#include "utf-utils/utf_bytes.hpp"
+#include "utf-utils/utf_detect.hpp"
+
+// The conversion templates call these for std::basic_string sinks, so the kernels are instantiated here with the flags
+// of the library. Calling transcode directly keeps them from calling themselves.
+
+UTFUTILS_API utf::conversion::status_e utf::conversion::compiled::utf8_to_utf16(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char16_t>& utf16_string,
+                                                                                const bool comply_with_standard, const bom_e bom_policy) {
+    return transcode<char8_t, char16_t>(utf8_sv, utf16_string, comply_with_standard, bom_policy);
+}
+
+UTFUTILS_API utf::conversion::status_e utf::conversion::compiled::utf8_to_utf32(const std::basic_string_view<char8_t>& utf8_sv, std::basic_string<char32_t>& utf32_string,
+                                                                                const bool comply_with_standard, const bom_e bom_policy) {
+    return transcode<char8_t, char32_t>(utf8_sv, utf32_string, comply_with_standard, bom_policy);
+}
+
+UTFUTILS_API utf::conversion::status_e utf::conversion::compiled::utf16_to_utf8(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char8_t>& utf8_string,
+                                                                                const bool comply_with_standard, const bom_e bom_policy) {
+    return transcode<char16_t, char8_t>(utf16_sv, utf8_string, comply_with_standard, bom_policy);
+}
+
+UTFUTILS_API utf::conversion::status_e utf::conversion::compiled::utf16_to_utf32(const std::basic_string_view<char16_t>& utf16_sv, std::basic_string<char32_t>& utf32_string,
+                                                                                 const bool comply_with_standard, const bom_e bom_policy) {
+    return transcode<char16_t, char32_t>(utf16_sv, utf32_string, comply_with_standard, bom_policy);
+}
+
+UTFUTILS_API utf::conversion::status_e utf::conversion::compiled::utf32_to_utf8(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char8_t>& utf8_string,
+                                                                                const bool comply_with_standard, const bom_e bom_policy) {
+    return transcode<char32_t, char8_t>(utf32_sv, utf8_string, comply_with_standard, bom_policy);
+}
+
+UTFUTILS_API utf::conversion::status_e utf::conversion::compiled::utf32_to_utf16(const std::basic_string_view<char32_t>& utf32_sv, std::basic_string<char16_t>& utf16_string,
+                                                                                 const bool comply_with_standard, const bom_e bom_policy) {
+    return transcode<char32_t, char16_t>(utf32_sv, utf16_string, comply_with_standard, bom_policy);
+}
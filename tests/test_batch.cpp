@@ -0,0 +1,119 @@
+/**
+ * @file test_batch.cpp
+ * @brief Checks batch conversion of ranges and of Arrow-style buffers against converting every string on its own.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_batch.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    /**
+     * @brief Calls the batch conversion for the pair of code unit types, @p inputs is a range or a buffer with offsets.
+     */
+    template <typename InputCharT, typename OutputCharT, typename OffsetT, typename... Inputs>
+    status_e convert_batch(utf::string_arena<OutputCharT, OffsetT>& arena, size_t* failed_index, const Inputs&... inputs) {
+        using namespace utf::conversion;
+        if constexpr (sizeof(InputCharT) == 1) {
+            if constexpr (sizeof(OutputCharT) == 2) {
+                return utf8_to_utf16_batch(inputs..., arena, false, failed_index);
+            }
+            else {
+                return utf8_to_utf32_batch(inputs..., arena, false, failed_index);
+            }
+        }
+        else if constexpr (sizeof(InputCharT) == 2) {
+            if constexpr (sizeof(OutputCharT) == 1) {
+                return utf16_to_utf8_batch(inputs..., arena, false, failed_index);
+            }
+            else {
+                return utf16_to_utf32_batch(inputs..., arena, false, failed_index);
+            }
+        }
+        else {
+            if constexpr (sizeof(OutputCharT) == 1) {
+                return utf32_to_utf8_batch(inputs..., arena, false, failed_index);
+            }
+            else {
+                return utf32_to_utf16_batch(inputs..., arena, false, failed_index);
+            }
+        }
+    }
+
+    template <typename OutputCharT, typename OffsetT>
+    bool arena_holds(const utf::string_arena<OutputCharT, OffsetT>& arena, const std::vector<std::u32string>& strings) {
+        if (arena.size() != strings.size()) {
+            return false;
+        }
+        for (size_t index = 0; index < strings.size(); ++index) {
+            if (arena[index] != encode<OutputCharT>(strings[index])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename InputCharT, typename OutputCharT>
+    void check_batch(random_engine& rng) {
+        for (const size_t count : {0, 1, 2, 17, 300}) {
+            std::vector<std::u32string>                strings;
+            std::vector<std::basic_string<InputCharT>> inputs;
+            std::basic_string<InputCharT>              data;
+            std::vector<uint32_t>                      offsets(1, 0);
+            for (size_t index = 0; index < count; ++index) {
+                strings.push_back(random_code_points(rng, random_below(rng, 3) == 0 ? 0 : random_below(rng, 50), text_mix_e::wide));
+                inputs.push_back(encode<InputCharT>(strings.back()));
+                data += inputs.back();
+                offsets.push_back(static_cast<uint32_t>(data.size()));
+            }
+
+            utf::string_arena<OutputCharT> range_arena;
+            UTF_CHECK(convert_batch<InputCharT>(range_arena, nullptr, inputs) == status_e::success);
+            UTF_CHECK(arena_holds(range_arena, strings));
+
+            utf::string_arena<OutputCharT, int32_t> offsets_arena;
+            UTF_CHECK(convert_batch<InputCharT>(offsets_arena, nullptr, std::basic_string_view<InputCharT>(data), offsets.data(), count) == status_e::success);
+            UTF_CHECK(arena_holds(offsets_arena, strings));
+
+            if (count == 0) {
+                continue;
+            }
+            // an invalid string stops the batch and is reported
+            const size_t bad = random_below(rng, count);
+            inputs[bad] += static_cast<InputCharT>(sizeof(InputCharT) == 1 ? 0xFF : sizeof(InputCharT) == 2 ? 0xDC00 : 0x110000);
+            size_t         failed_index = count;
+            const status_e status       = convert_batch<InputCharT>(range_arena, &failed_index, inputs);
+            if constexpr (sizeof(InputCharT) == 2) {
+                // unpaired surrogates are only rejected when complying with the standard
+                UTF_CHECK(status == status_e::success);
+            }
+            else {
+                UTF_CHECK(status != status_e::success && failed_index == bad && range_arena.empty() && range_arena.data.empty());
+            }
+
+            // the arena doesn't fit into the offset type
+            utf::string_arena<OutputCharT, uint8_t> narrow_arena;
+            const std::vector<std::basic_string<InputCharT>> long_inputs(2, std::basic_string<InputCharT>(200, static_cast<InputCharT>('a')));
+            failed_index = 0;
+            UTF_CHECK(convert_batch<InputCharT>(narrow_arena, &failed_index, long_inputs) == status_e::undefined_error);
+            UTF_CHECK(failed_index == 1 && narrow_arena.empty());
+        }
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(30);
+    check_batch<char8_t, char16_t>(rng);
+    check_batch<char8_t, char32_t>(rng);
+    check_batch<char16_t, char8_t>(rng);
+    check_batch<char16_t, char32_t>(rng);
+    check_batch<char32_t, char8_t>(rng);
+    check_batch<char32_t, char16_t>(rng);
+    return result();
+}
@@ -0,0 +1,124 @@
+/**
+ * @file test_bytes.cpp
+ * @brief Checks byte buffer conversions, in-place byte swapping and encoding detection.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_detect.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+using utf::encoding_e;
+
+namespace {
+    void test_transcode_bytes(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string code_points = random_code_points(rng, size, text_mix_e::mixed);
+            for (const encoding_e input_encoding : all_encodings) {
+                const std::vector<std::byte> input = to_encoding(code_points, input_encoding);
+                unaligned_copy               unaligned(input, 1 + size % 3);
+                for (const encoding_e output_encoding : all_encodings) {
+                    std::vector<std::byte> output;
+                    UTF_CHECK(utf::conversion::transcode_bytes(unaligned.data(), input.size(), input_encoding, output, output_encoding) == status_e::success);
+                    UTF_CHECK(output == to_encoding(code_points, output_encoding));
+                }
+            }
+        }
+    }
+
+    void test_transcode_bytes_bom(random_engine& rng) {
+        const std::u32string text = random_code_points(rng, 3000, text_mix_e::wide);
+        // generic UTF-16 takes its byte order from a swapped BOM
+        std::u16string with_bom = u'\uFEFF' + to_utf16(text);
+        const std::vector<std::byte> swapped = to_swapped_bytes(with_bom);
+        std::vector<std::byte>       output;
+        UTF_CHECK(utf::conversion::transcode_bytes(swapped.data(), swapped.size(), encoding_e::utf16, output, encoding_e::utf32, false, utf::bom_e::strip) == status_e::success);
+        UTF_CHECK(output == to_bytes(text));
+        UTF_CHECK(utf::conversion::transcode_bytes(swapped.data(), swapped.size(), encoding_e::utf16, output, encoding_e::utf8) == status_e::success);
+        UTF_CHECK(output == to_encoding(U'\uFEFF' + text, encoding_e::utf8));
+
+        const std::vector<std::byte> plain = to_encoding(text, encoding_e::utf8);
+        UTF_CHECK(utf::conversion::transcode_bytes(plain.data(), plain.size(), encoding_e::utf8, output, encoding_e::utf16_be, false, utf::bom_e::add) == status_e::success);
+        UTF_CHECK(output == to_encoding(U'\uFEFF' + text, encoding_e::utf16_be));
+
+        // unpaired surrogates pass unless the conversion complies with the standard, errors clear the output
+        std::u16string broken = to_utf16(text);
+        broken[broken.size() / 2]     = u'\xDC00';
+        broken[broken.size() / 2 - 1] = u'a';
+        const std::vector<std::byte> broken_bytes = to_bytes(broken);
+        UTF_CHECK(utf::conversion::transcode_bytes(broken_bytes.data(), broken_bytes.size(), encoding_e::utf16, output, encoding_e::utf8) == status_e::success);
+        UTF_CHECK(utf::conversion::transcode_bytes(broken_bytes.data(), broken_bytes.size(), encoding_e::utf16, output, encoding_e::utf8, true) == status_e::non_standard_encoding);
+        UTF_CHECK(output.empty());
+        UTF_CHECK(utf::conversion::transcode_bytes(plain.data(), 3, encoding_e::utf16_le, output, encoding_e::utf8) == status_e::character_cut_off);
+        UTF_CHECK(output.empty());
+    }
+
+    template <typename CharT>
+    void test_swap_endianness_inplace(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const bool strip_bom : {false, true}) {
+                std::basic_string<CharT> code_units(size, CharT(0));
+                for (CharT& code_unit : code_units) {
+                    code_unit = static_cast<CharT>(rng());
+                }
+                if (size != 0 && random_below(rng, 2) == 0) {
+                    code_units[0] = random_below(rng, 2) == 0 ? CharT(0xFEFF) : swapped(CharT(0xFEFF));
+                }
+                const bool               has_bom  = size != 0 && (code_units[0] == CharT(0xFEFF) || code_units[0] == swapped(CharT(0xFEFF)));
+                const size_t             skipped  = strip_bom && has_bom ? 1 : 0;
+                std::basic_string<CharT> expected = code_units.substr(skipped);
+                for (CharT& code_unit : expected) {
+                    code_unit = swapped(code_unit);
+                }
+                UTF_CHECK(utf::swap_endianness_inplace(code_units.data(), size, strip_bom) == size - skipped);
+                UTF_CHECK(code_units.substr(0, size - skipped) == expected);
+            }
+        }
+    }
+
+    void test_detect_encoding(random_engine& rng) {
+        auto detect = [](const std::vector<std::byte>& bytes) { return utf::detect_encoding(bytes.data(), bytes.size()); };
+        const std::u32string text = random_code_points(rng, 2000, text_mix_e::mixed);
+
+        for (const encoding_e encoding : {encoding_e::utf8, encoding_e::utf16_le, encoding_e::utf16_be, encoding_e::utf32_le, encoding_e::utf32_be}) {
+            // a BOM decides
+            const utf::detected_encoding with_bom = detect(to_encoding(U'\uFEFF' + text, encoding));
+            UTF_CHECK(with_bom.encoding == encoding);
+            UTF_CHECK(with_bom.confidence == 1);
+            UTF_CHECK(with_bom.bom_size == to_encoding(U"\uFEFF", encoding).size());
+            // the zero bytes of mostly ASCII text do too
+            for (const size_t misalignment : {0, 1}) {
+                const std::vector<std::byte> bytes = to_encoding(text, encoding);
+                unaligned_copy               unaligned(bytes, misalignment);
+                const utf::detected_encoding detected = utf::detect_encoding(unaligned.data(), bytes.size());
+                UTF_CHECK(detected.encoding == encoding);
+                UTF_CHECK(detected.bom_size == 0);
+                UTF_CHECK(detected.confidence >= 0.5);
+            }
+        }
+        // an unpaired surrogate in the middle rules UTF-16 out, read in place or block by block
+        std::u16string broken = to_utf16(text);
+        broken[broken.size() / 2] = static_cast<char16_t>(0xDC00);
+        const std::vector<std::byte> broken_bytes = to_bytes(broken);
+        for (const size_t misalignment : {0, 1}) {
+            unaligned_copy unaligned(broken_bytes, misalignment);
+            UTF_CHECK(utf::detect_encoding(unaligned.data(), broken_bytes.size()).encoding != (host_is_little_endian() ? encoding_e::utf16_le : encoding_e::utf16_be));
+        }
+        UTF_CHECK(detect({}).encoding == encoding_e::utf8);
+        UTF_CHECK(detect(to_encoding(U"plain ASCII text", encoding_e::utf8)).confidence == 1);
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(34);
+    test_transcode_bytes(rng);
+    test_transcode_bytes_bom(rng);
+    test_swap_endianness_inplace<char16_t>(rng);
+    test_swap_endianness_inplace<char32_t>(rng);
+    test_detect_encoding(rng);
+    return result();
+}
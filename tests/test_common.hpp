@@ -0,0 +1,326 @@
+#if !defined(UTFUTILS_TEST_COMMON_H)
+#   define UTFUTILS_TEST_COMMON_H
+
+/**
+ * @file test_common.hpp
+ * @brief Checks, random text and scalar reference implementations shared by the tests.
+ * @details
+ * Every test is built once per instruction set the compiler can target (and once with @c UTFUTILS_NO_SIMD), and compares
+ * the library with the plain loops in here, so the vectorized and the scalar kernels are held to the same results.
+ */
+
+#include "utf-utils/utf_utils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace utf_test {
+    /**
+     * @brief Number of failed checks so far.
+     */
+    inline int failures = 0;
+
+    /**
+     * @brief Reports a failed check, failures after the first few are only counted.
+     */
+    inline void report(const char* expression, const char* file, const int line) {
+        if (++failures <= 20) {
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        }
+    }
+
+    /**
+     * @brief Exit code of a test: @c 0 if every check passed, @c 77 (skipped) if the CPU lacks the instruction set it was built for.
+     */
+    inline int unsupported_cpu() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   if defined(__AVX2__)
+        if (!__builtin_cpu_supports("avx2")) {
+            return 77;
+        }
+#   elif defined(__SSSE3__)
+        if (!__builtin_cpu_supports("ssse3")) {
+            return 77;
+        }
+#   endif
+#endif
+        return 0;
+    }
+
+    inline int result() {
+        if (failures != 0) {
+            std::fprintf(stderr, "%d check(s) failed\n", failures);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    using random_engine = std::mt19937_64;
+
+    /**
+     * @brief Sizes around the block sizes of the kernels: 16 and 32 bytes, counter flushes and the 1024 units of byte blocks.
+     */
+    constexpr size_t boundary_sizes[] = {0,  1,  2,  3,  4,  7,  8,  9,   15,  16,  17,  18,  19,  20,   31,   32,   33,   35,  47,
+                                         48, 63, 64, 65, 95, 127, 128, 129, 255, 256, 257, 1023, 1024, 1025, 2047, 4080, 4081, 8191};
+
+    /**
+     * @brief Kinds of characters random text is made of.
+     */
+    enum class text_mix_e {
+        ascii,   /**< ASCII only. */
+        latin1,  /**< Up to U+00FF. */
+        mixed,   /**< Mostly ASCII with characters of every UTF-8 length. */
+        wide     /**< Characters of every UTF-8 length in equal parts. */
+    };
+
+    inline size_t random_below(random_engine& rng, const size_t bound) {
+        return bound == 0 ? 0 : static_cast<size_t>(rng() % bound);
+    }
+
+    /**
+     * @brief Returns a random valid code point.
+     */
+    inline char32_t random_code_point(random_engine& rng, const text_mix_e mix) {
+        switch (mix) {
+            case text_mix_e::ascii:
+                return static_cast<char32_t>(random_below(rng, 0x80));
+            case text_mix_e::latin1:
+                return static_cast<char32_t>(random_below(rng, 0x100));
+            case text_mix_e::mixed:
+                if (random_below(rng, 4) != 0) {
+                    return static_cast<char32_t>(random_below(rng, 0x80));
+                }
+                [[fallthrough]];
+            case text_mix_e::wide:
+                break;
+        }
+        switch (random_below(rng, 4)) {
+            case 0:
+                return static_cast<char32_t>(random_below(rng, 0x80));
+            case 1:
+                return static_cast<char32_t>(0x80 + random_below(rng, 0x800 - 0x80));
+            case 2: {
+                // skip the surrogates
+                const char32_t code_point = static_cast<char32_t>(0x800 + random_below(rng, 0x10000 - 0x800 - 0x800));
+                return code_point >= 0xD800 ? code_point + 0x800 : code_point;
+            }
+            default:
+                return static_cast<char32_t>(0x10000 + random_below(rng, 0x110000 - 0x10000));
+        }
+    }
+
+    inline std::u32string random_code_points(random_engine& rng, const size_t size, const text_mix_e mix) {
+        std::u32string result(size, U'\0');
+        for (char32_t& code_point : result) {
+            code_point = random_code_point(rng, mix);
+        }
+        return result;
+    }
+
+    inline std::vector<std::byte> random_bytes(random_engine& rng, const size_t size) {
+        std::vector<std::byte> result(size);
+        for (std::byte& byte : result) {
+            byte = static_cast<std::byte>(rng());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Encodes code points as UTF-8.
+     */
+    inline std::basic_string<char8_t> to_utf8(const std::u32string& code_points) {
+        std::basic_string<char8_t> result;
+        for (const char32_t code_point : code_points) {
+            if (code_point < 0x80) {
+                result += static_cast<char8_t>(code_point);
+            }
+            else if (code_point < 0x800) {
+                result += static_cast<char8_t>(0xC0 | code_point >> 6);
+                result += static_cast<char8_t>(0x80 | (code_point & 0x3F));
+            }
+            else if (code_point < 0x10000) {
+                result += static_cast<char8_t>(0xE0 | code_point >> 12);
+                result += static_cast<char8_t>(0x80 | (code_point >> 6 & 0x3F));
+                result += static_cast<char8_t>(0x80 | (code_point & 0x3F));
+            }
+            else {
+                result += static_cast<char8_t>(0xF0 | code_point >> 18);
+                result += static_cast<char8_t>(0x80 | (code_point >> 12 & 0x3F));
+                result += static_cast<char8_t>(0x80 | (code_point >> 6 & 0x3F));
+                result += static_cast<char8_t>(0x80 | (code_point & 0x3F));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Encodes code points as UTF-16 in host byte order.
+     */
+    inline std::u16string to_utf16(const std::u32string& code_points) {
+        std::u16string result;
+        for (const char32_t code_point : code_points) {
+            if (code_point < 0x10000) {
+                result += static_cast<char16_t>(code_point);
+            }
+            else {
+                result += static_cast<char16_t>(0xD800 + ((code_point - 0x10000) >> 10));
+                result += static_cast<char16_t>(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Encodes code points in the encoding of a code unit type: UTF-8, UTF-16 or UTF-32 in host byte order.
+     */
+    template <typename CharT>
+    std::basic_string<CharT> encode(const std::u32string& code_points) {
+        if constexpr (sizeof(CharT) == 1) {
+            return to_utf8(code_points);
+        }
+        else if constexpr (sizeof(CharT) == 2) {
+            return to_utf16(code_points);
+        }
+        else {
+            return code_points;
+        }
+    }
+
+    /**
+     * @brief Returns the bytes of a string.
+     */
+    template <typename CharT>
+    std::vector<std::byte> to_bytes(const std::basic_string<CharT>& string) {
+        std::vector<std::byte> result(string.size() * sizeof(CharT));
+        if (!result.empty()) {
+            std::memcpy(result.data(), string.data(), result.size());
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the bytes of a string with the byte order of every code unit reversed.
+     */
+    template <typename CharT>
+    std::vector<std::byte> to_swapped_bytes(const std::basic_string<CharT>& string) {
+        std::vector<std::byte> result = to_bytes(string);
+        for (size_t offset = 0; offset < result.size(); offset += sizeof(CharT)) {
+            for (size_t low = 0, high = sizeof(CharT) - 1; low < high; ++low, --high) {
+                std::swap(result[offset + low], result[offset + high]);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Reverses the byte order of a code unit.
+     */
+    template <typename CharT>
+    CharT swapped(const CharT code_unit) {
+        CharT result = 0;
+        for (size_t byte = 0; byte < sizeof(CharT); ++byte) {
+            result = static_cast<CharT>(result << 8 | ((code_unit >> (8 * byte)) & 0xFF));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Checks if the host is little-endian.
+     */
+    inline bool host_is_little_endian() {
+        const char16_t code_unit = 1;
+        return *reinterpret_cast<const unsigned char*>(&code_unit) == 1;
+    }
+
+    /**
+     * @brief Encodes code points as bytes in the given encoding, generic UTF-16 and UTF-32 in host byte order.
+     */
+    inline std::vector<std::byte> to_encoding(const std::u32string& code_points, const utf::encoding_e encoding) {
+        const bool little = host_is_little_endian();
+        switch (encoding) {
+            case utf::encoding_e::utf8:
+                return to_bytes(to_utf8(code_points));
+            case utf::encoding_e::utf16:
+                return to_bytes(to_utf16(code_points));
+            case utf::encoding_e::utf16_le:
+            case utf::encoding_e::utf16_be:
+                return (encoding == utf::encoding_e::utf16_le) == little ? to_bytes(to_utf16(code_points)) : to_swapped_bytes(to_utf16(code_points));
+            case utf::encoding_e::utf32:
+                return to_bytes(code_points);
+            default:
+                return (encoding == utf::encoding_e::utf32_le) == little ? to_bytes(code_points) : to_swapped_bytes(code_points);
+        }
+    }
+
+    /**
+     * @brief Every encoding of #utf::encoding_e.
+     */
+    constexpr utf::encoding_e all_encodings[] = {utf::encoding_e::utf8,     utf::encoding_e::utf16,    utf::encoding_e::utf32,   utf::encoding_e::utf16_le,
+                                                 utf::encoding_e::utf16_be, utf::encoding_e::utf32_le, utf::encoding_e::utf32_be};
+
+    /**
+     * @brief Copy of bytes which starts at the given offset from a 64-byte boundary, to feed kernels unaligned data.
+     */
+    class unaligned_copy {
+    public:
+        unaligned_copy(const std::byte* data, const size_t size, const size_t misalignment)
+            : storage_(size + 128), offset_(static_cast<size_t>(64 - reinterpret_cast<uintptr_t>(storage_.data()) % 64) + misalignment % 64) {
+            if (size != 0) {
+                std::memcpy(storage_.data() + offset_, data, size);
+            }
+        }
+        unaligned_copy(const std::vector<std::byte>& bytes, const size_t misalignment) : unaligned_copy(bytes.data(), bytes.size(), misalignment) {}
+
+        std::byte* data() {
+            return storage_.data() + offset_;
+        }
+
+    private:
+        std::vector<std::byte> storage_;
+        size_t                 offset_;
+    };
+} // namespace utf_test
+
+/**
+ * @brief Checks a condition and reports it if it doesn't hold, the test goes on.
+ */
+#define UTF_CHECK(...)                                             \
+    do {                                                           \
+        if (!static_cast<bool>(__VA_ARGS__)) {                     \
+            utf_test::report(#__VA_ARGS__, __FILE__, __LINE__);    \
+        }                                                          \
+    } while (false)
+
+namespace utf_test {
+    /**
+     * @brief Converts into a container, a misaligned raw pointer and a back inserter and checks all of them against the
+     * expected string.
+     * @param convert callable taking the sink and returning the status of the conversion.
+     */
+    template <typename OutputCharT, typename Convert>
+    void check_sinks(Convert convert, const std::basic_string<OutputCharT>& expected, const size_t misalignment) {
+        // previous contents of a container are replaced
+        std::basic_string<OutputCharT> container(3, OutputCharT('x'));
+        UTF_CHECK(convert(container) == utf::conversion::status_e::success);
+        UTF_CHECK(container == expected);
+
+        // the pointer kernels must neither write past the result nor depend on alignment
+        std::vector<OutputCharT> buffer(expected.size() + 64 + misalignment, OutputCharT(0x5A));
+        OutputCharT*             pointer = buffer.data() + misalignment;
+        UTF_CHECK(convert(pointer) == utf::conversion::status_e::success);
+        UTF_CHECK(std::basic_string<OutputCharT>(pointer, expected.size()) == expected);
+        UTF_CHECK(std::all_of(pointer + expected.size(), buffer.data() + buffer.size(), [](const OutputCharT code_unit) { return code_unit == OutputCharT(0x5A); }));
+
+        std::basic_string<OutputCharT> inserted;
+        UTF_CHECK(convert(std::back_inserter(inserted)) == utf::conversion::status_e::success);
+        UTF_CHECK(inserted == expected);
+    }
+} // namespace utf_test
+
+#endif // !defined(UTFUTILS_TEST_COMMON_H)
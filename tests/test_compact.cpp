@@ -0,0 +1,123 @@
+/**
+ * @file test_compact.cpp
+ * @brief Checks compact strings of every width: the width picked on assignment and conversion back into every kind of sink.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_compact.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    void check_round_trip(const utf::compact_string& text, const std::u32string& code_points, const size_t misalignment) {
+        UTF_CHECK(text.size() == code_points.size());
+        for (size_t index = 0; index < code_points.size(); ++index) {
+            UTF_CHECK(text[index] == code_points[index]);
+        }
+        check_sinks<char8_t>([&](auto&& sink) { return text.to_utf8(sink); }, to_utf8(code_points), misalignment);
+        check_sinks<char16_t>([&](auto&& sink) { return text.to_utf16(sink); }, to_utf16(code_points), misalignment);
+        check_sinks<char32_t>([&](auto&& sink) { return text.to_utf32(sink); }, code_points, misalignment);
+    }
+
+    /**
+     * @brief Assigns random text from every encoding, with the width limited to one, two or four bytes.
+     */
+    void test_widths(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const size_t width : {1, 2, 4}) {
+                std::u32string code_points = random_code_points(rng, size, width == 1 ? text_mix_e::latin1 : text_mix_e::wide);
+                if (width == 2) {
+                    for (char32_t& code_point : code_points) {
+                        code_point = code_point > 0xFFFF ? U'\u4E00' : code_point;
+                    }
+                }
+                if (width == 4 && size != 0) {
+                    code_points[random_below(rng, size)] = U'\U0001F600';
+                }
+                const size_t expected_width = size == 0 ? 1 : width;
+
+                utf::compact_string text;
+                UTF_CHECK(text.assign_utf8(to_utf8(code_points)) == status_e::success);
+                UTF_CHECK(text.char_width() == expected_width);
+                check_round_trip(text, code_points, size % 3);
+
+                utf::compact_string from_utf16;
+                UTF_CHECK(from_utf16.assign_utf16(u'\uFEFF' + to_utf16(code_points)) == status_e::success);
+                UTF_CHECK(from_utf16 == text);
+
+                utf::compact_string from_utf32;
+                UTF_CHECK(from_utf32.assign_utf32(code_points) == status_e::success);
+                UTF_CHECK(from_utf32 == text);
+            }
+        }
+    }
+
+    void test_lone_surrogates() {
+        // a lenient UCS-2 string keeps unpaired surrogates, converting it back must not pair them
+        const std::u16string utf16 = std::u16string(u"a") + static_cast<char16_t>(0xD83D) + u"b" + static_cast<char16_t>(0xDE00);
+        utf::compact_string  text;
+        UTF_CHECK(text.assign_utf16(utf16) == status_e::success);
+        UTF_CHECK(text.char_width() == 2);
+
+        std::u16string converted;
+        UTF_CHECK(text.to_utf16(converted) == status_e::success);
+        UTF_CHECK(converted == utf16);
+        std::u32string widened;
+        UTF_CHECK(text.to_utf32(widened) == status_e::success);
+        UTF_CHECK(widened == std::u32string(utf16.begin(), utf16.end()));
+
+        // UCS-2 storage is UTF-16 without pairs, so it comes back unchanged
+        utf::compact_string reassigned;
+        UTF_CHECK(reassigned.assign_utf16(converted) == status_e::success);
+        UTF_CHECK(reassigned == text);
+
+        UTF_CHECK(text.assign_utf16(utf16, true) != status_e::success);
+        UTF_CHECK(text.empty());
+    }
+
+    void test_adjacent_surrogates() {
+        // a high surrogate code point followed by a low one would be a pair in UCS-2, it's kept as two code points in UTF-32
+        const std::u32string             code_points = {0xD83D, 0xDE00};
+        const std::basic_string<char8_t> cesu8       = to_utf8(code_points);
+        UTF_CHECK(cesu8.size() == 6);
+
+        utf::compact_string from_utf32;
+        UTF_CHECK(from_utf32.assign_utf32(code_points) == status_e::success);
+        utf::compact_string from_utf8;
+        UTF_CHECK(from_utf8.assign_utf8(cesu8) == status_e::success);
+        for (const utf::compact_string* text : {&from_utf32, &from_utf8}) {
+            UTF_CHECK(text->char_width() == 4 && text->size() == 2);
+            UTF_CHECK((*text)[0] == 0xD83D && (*text)[1] == 0xDE00);
+            std::basic_string<char8_t> utf8;
+            UTF_CHECK(text->to_utf8(utf8) == status_e::success);
+            UTF_CHECK(utf8 == cesu8);
+            std::u32string utf32;
+            UTF_CHECK(text->to_utf32(utf32) == status_e::success);
+            UTF_CHECK(utf32 == code_points);
+        }
+        UTF_CHECK(from_utf8 == from_utf32);
+
+        // in the other order, or apart, they stay UCS-2
+        UTF_CHECK(from_utf32.assign_utf32(std::u32string{0xDE00, 0xD83D}) == status_e::success);
+        UTF_CHECK(from_utf32.char_width() == 2);
+        UTF_CHECK(from_utf8.assign_utf8(to_utf8(std::u32string{0xD83D, U'a', 0xDE00})) == status_e::success);
+        UTF_CHECK(from_utf8.char_width() == 2);
+
+        // a real pair is one character
+        UTF_CHECK(from_utf32.assign_utf16(to_utf16(U"\U0001F600")) == status_e::success);
+        UTF_CHECK(from_utf32.char_width() == 4 && from_utf32.size() == 1);
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(39);
+    test_widths(rng);
+    test_lone_surrogates();
+    test_adjacent_surrogates();
+    return result();
+}
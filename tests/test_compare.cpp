@@ -0,0 +1,100 @@
+/**
+ * @file test_compare.cpp
+ * @brief Checks code point order comparison of strings in every pair of encodings.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_compare.hpp"
+#include "utf-utils/utf_hash.hpp"
+
+using namespace utf_test;
+
+namespace {
+    int sign(const int value) {
+        return (value > 0) - (value < 0);
+    }
+
+    template <typename LeftCharT, typename RightCharT>
+    void check_compare(const std::u32string& left, const std::u32string& right) {
+        const std::basic_string<LeftCharT>  left_string  = encode<LeftCharT>(left);
+        const std::basic_string<RightCharT> right_string = encode<RightCharT>(right);
+        const int expected = sign(left.compare(right));
+        UTF_CHECK(sign(utf::compare(std::basic_string_view<LeftCharT>(left_string), std::basic_string_view<RightCharT>(right_string))) == expected);
+        UTF_CHECK(utf::equal(std::basic_string_view<LeftCharT>(left_string), std::basic_string_view<RightCharT>(right_string)) == (expected == 0));
+    }
+
+    template <typename LeftCharT, typename RightCharT>
+    void test_compare(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const text_mix_e mix : {text_mix_e::ascii, text_mix_e::mixed, text_mix_e::wide}) {
+                const std::u32string left = random_code_points(rng, size, mix);
+                check_compare<LeftCharT, RightCharT>(left, left);
+                if (size == 0) {
+                    check_compare<LeftCharT, RightCharT>(left, U"a");
+                    continue;
+                }
+                // a prefix, and a difference anywhere, e.g. past a long common ASCII run
+                const size_t at = random_below(rng, size);
+                check_compare<LeftCharT, RightCharT>(left, left.substr(0, at));
+                check_compare<LeftCharT, RightCharT>(left.substr(0, at), left);
+                std::u32string right = left;
+                right[at] = random_code_point(rng, mix);
+                check_compare<LeftCharT, RightCharT>(left, right);
+                // U+E000-U+FFFF order before supplementary characters although their UTF-16 code units don't
+                right[at] = U'\uFFFD';
+                std::u32string supplementary = left;
+                supplementary[at] = U'\U0001F600';
+                check_compare<LeftCharT, RightCharT>(right, supplementary);
+                check_compare<LeftCharT, RightCharT>(supplementary, right);
+            }
+        }
+    }
+
+    void test_invalid_and_swapped() {
+        // code units which can't be decoded compare as U+FFFD
+        const std::basic_string<char8_t> invalid(1, static_cast<char8_t>(0xFF));
+        UTF_CHECK(utf::compare(std::basic_string_view<char8_t>(invalid), std::u32string_view(U"\uFFFD")) == 0);
+        // UTF-16 with a swapped BOM is read in its byte order
+        std::u16string swapped_text = u"\uFEFFab\U0001F600";
+        for (char16_t& code_unit : swapped_text) {
+            code_unit = swapped(code_unit);
+        }
+        UTF_CHECK(utf::compare(std::u16string_view(swapped_text), std::u32string_view(U"\uFEFFab\U0001F600")) == 0);
+        // a leading BOM is skipped on either side like by code_point_hash, a BOM further in is a character
+        UTF_CHECK(utf::compare(std::u16string_view(swapped_text), std::u32string_view(U"ab\U0001F600")) == 0);
+        const std::basic_string<char8_t> plain = to_utf8(U"abc");
+        UTF_CHECK(utf::equal(std::u16string_view(u"\uFEFFabc"), std::basic_string_view<char8_t>(plain)));
+        UTF_CHECK(utf::equal(std::basic_string_view<char8_t>(to_utf8(U"\uFEFFabc")), std::basic_string_view<char8_t>(plain)));
+        UTF_CHECK(utf::compare(std::u32string_view(U"\uFEFF"), std::u16string_view(u"")) == 0);
+        UTF_CHECK(utf::compare(std::u32string_view(U"a\uFEFF"), std::u16string_view(u"a")) > 0);
+        UTF_CHECK(utf::compare(std::u32string_view(U"\uFEFF\uFEFFa"), std::u16string_view(u"a")) > 0);
+
+        utf::fnv1a_64 bom_hash;
+        utf::fnv1a_64 plain_hash;
+        UTF_CHECK(utf::code_point_hash(std::u16string_view(u"\uFEFFabc"), bom_hash) == utf::conversion::status_e::success);
+        UTF_CHECK(utf::code_point_hash(std::basic_string_view<char8_t>(plain), plain_hash) == utf::conversion::status_e::success);
+        UTF_CHECK(bom_hash.value == plain_hash.value);
+        // the hash only agrees with equal() on valid strings
+        UTF_CHECK(utf::equal(std::basic_string_view<char8_t>(invalid), std::u16string_view(u"\uFFFD")));
+        UTF_CHECK(utf::code_point_hash(std::basic_string_view<char8_t>(invalid), bom_hash) != utf::conversion::status_e::success);
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(45);
+    test_compare<char8_t, char8_t>(rng);
+    test_compare<char8_t, char16_t>(rng);
+    test_compare<char8_t, char32_t>(rng);
+    test_compare<char16_t, char8_t>(rng);
+    test_compare<char16_t, char16_t>(rng);
+    test_compare<char16_t, char32_t>(rng);
+    test_compare<char32_t, char8_t>(rng);
+    test_compare<char32_t, char16_t>(rng);
+    test_compare<char32_t, char32_t>(rng);
+    test_invalid_and_swapped();
+    return result();
+}
@@ -0,0 +1,103 @@
+/**
+ * @file test_constexpr.cpp
+ * @brief Checks that conversions and utf::literal are evaluated at compile time.
+ * @details Every check is a @c static_assert and is repeated at run time, where it goes through the same code.
+ */
+
+#include "test_common.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    /**
+     * @brief Converts into an array through a pointer sink, which is a literal type since C++17.
+     * @param convert callable converting into the pointer it's given.
+     * @param expected the expected code units followed by the null terminator.
+     */
+    template <typename OutputCharT, size_t N, typename Convert>
+    constexpr bool converts_to(Convert convert, const OutputCharT (&expected)[N]) {
+        OutputCharT output[N] {};
+        if (convert(static_cast<OutputCharT*>(output)) != status_e::success) {
+            return false;
+        }
+        for (size_t index = 0; index < N; ++index) {
+            if (output[index] != expected[index]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr std::basic_string_view<char8_t> utf8_text   = u8"a\u00E9\u20AC\U0001F600";
+    constexpr std::u16string_view             utf16_text  = u"a\u00E9\u20AC\U0001F600";
+    constexpr std::u32string_view             utf32_text  = U"a\u00E9\u20AC\U0001F600";
+
+    constexpr bool pointer_sinks() {
+        return converts_to([](char16_t* out) { return utf::conversion::utf8_to_utf16(utf8_text, out); }, u"a\u00E9\u20AC\U0001F600") &&
+               converts_to([](char32_t* out) { return utf::conversion::utf8_to_utf32(utf8_text, out); }, U"a\u00E9\u20AC\U0001F600") &&
+               converts_to([](char8_t* out) { return utf::conversion::utf16_to_utf8(utf16_text, out); }, u8"a\u00E9\u20AC\U0001F600") &&
+               converts_to([](char32_t* out) { return utf::conversion::utf16_to_utf32(utf16_text, out); }, U"a\u00E9\u20AC\U0001F600") &&
+               converts_to([](char8_t* out) { return utf::conversion::utf32_to_utf8(utf32_text, out); }, u8"a\u00E9\u20AC\U0001F600") &&
+               converts_to([](char16_t* out) { return utf::conversion::utf32_to_utf16(utf32_text, out); }, u"a\u00E9\u20AC\U0001F600");
+    }
+    static_assert(pointer_sinks(), "conversions into pointers must be constant expressions");
+
+    constexpr bool bom_policies() {
+        return converts_to([](char16_t* out) { return utf::conversion::utf8_to_utf16(utf8_text, out, false, utf::bom_e::add); }, u"\uFEFFa\u00E9\u20AC\U0001F600") &&
+               converts_to([](char8_t* out) { return utf::conversion::utf32_to_utf8(U"\uFEFFa", out, false, utf::bom_e::strip); }, u8"a");
+    }
+    static_assert(bom_policies(), "the BOM policy must be applied at compile time");
+
+    constexpr status_e invalid_status() {
+        char16_t output[4] {};
+        const char8_t cut_off[] = {static_cast<char8_t>(0xE2), static_cast<char8_t>(0x82)};
+        return utf::conversion::utf8_to_utf16(std::basic_string_view<char8_t>(cut_off, 2), static_cast<char16_t*>(output));
+    }
+    static_assert(invalid_status() == status_e::character_cut_off, "invalid input must be reported at compile time");
+
+    constexpr status_e surrogate_status() {
+        char8_t output[4] {};
+        return utf::conversion::utf32_to_utf8(U"\xD800", static_cast<char8_t*>(output), true);
+    }
+    static_assert(surrogate_status() == status_e::non_standard_encoding, "surrogates must be rejected at compile time");
+
+#if defined(__cpp_lib_constexpr_string) && __cpp_lib_constexpr_string >= 201907L
+    // since C++20 std::basic_string is a literal type too, the allocation is freed before the evaluation ends
+    constexpr bool string_sinks() {
+        std::u16string utf16;
+        std::basic_string<char8_t> utf8;
+        std::u32string utf32 = U"replaced";
+        return utf::conversion::utf8_to_utf16(utf8_text, utf16) == status_e::success && utf16 == utf16_text &&
+               utf::conversion::utf16_to_utf8(utf16_text, utf8) == status_e::success && utf8 == utf8_text &&
+               utf::conversion::utf8_to_utf32(utf8_text, utf32) == status_e::success && utf32 == utf32_text &&
+               utf::conversion::utf16_to_utf32(u"\xDC00", utf32, true) == status_e::non_standard_encoding && utf32.empty();
+    }
+    static_assert(string_sinks(), "conversions into strings must be constant expressions since C++20");
+#endif
+
+#if defined(__cpp_consteval) && defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    // literals are converted once at compile time and stored with their null terminator
+    static_assert(utf::utf16_literal<u8"a\u00E9\u20AC\U0001F600">.view() == utf16_text);
+    static_assert(utf::utf8_literal<U"a\u00E9\u20AC\U0001F600">.view() == utf8_text);
+    static_assert(utf::utf32_literal<u"a\u00E9\u20AC\U0001F600">.view() == utf32_text);
+    static_assert(utf::literal<char16_t, U"\U0001F600">.size() == 2 && utf::literal<char16_t, U"\U0001F600">.c_str()[2] == 0);
+    static_assert(utf::literal<char8_t, u8"">.size() == 0);
+    constexpr std::u16string_view greeting = utf::literal<char16_t, u8"\u041F\u0440\u0438\u0432\u0435\u0442">;
+    static_assert(greeting == u"\u041F\u0440\u0438\u0432\u0435\u0442");
+#endif
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    UTF_CHECK(pointer_sinks());
+    UTF_CHECK(bom_policies());
+    UTF_CHECK(invalid_status() == status_e::character_cut_off);
+    UTF_CHECK(surrogate_status() == status_e::non_standard_encoding);
+#if defined(__cpp_lib_constexpr_string) && __cpp_lib_constexpr_string >= 201907L
+    UTF_CHECK(string_sinks());
+#endif
+    return result();
+}
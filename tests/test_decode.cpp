@@ -0,0 +1,127 @@
+/**
+ * @file test_decode.cpp
+ * @brief Checks decoding forwards and backwards from any position, also from inside a character and over invalid code units.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_decode.hpp"
+
+using namespace utf_test;
+
+namespace {
+    /**
+     * @brief Offsets of the first code unit of every character, plus the size at the end.
+     */
+    template <typename CharT>
+    std::vector<size_t> character_offsets(const std::u32string& code_points) {
+        std::vector<size_t> offsets(1, 0);
+        for (const char32_t code_point : code_points) {
+            offsets.push_back(offsets.back() + encode<CharT>(std::u32string(1, code_point)).size());
+        }
+        return offsets;
+    }
+
+    /**
+     * @brief Starts at random code units, inside characters too, and steps to both ends of the string.
+     */
+    template <typename CharT>
+    void test_decoder_at(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string                code_points = random_code_points(rng, size, text_mix_e::wide);
+            const std::basic_string<CharT>      text        = encode<CharT>(code_points);
+            const std::basic_string_view<CharT> sv(text);
+            const std::vector<size_t>           offsets = character_offsets<CharT>(code_points);
+
+            for (int round = 0; round < 4; ++round) {
+                const size_t offset    = random_below(rng, text.size() + 2);
+                const size_t character = offset >= text.size() ? size : static_cast<size_t>(std::upper_bound(offsets.begin(), offsets.end(), offset) - offsets.begin()) - 1;
+                UTF_CHECK(utf::character_start(sv, offset) == offsets[character]);
+
+                utf::decode_iterator<CharT> it = utf::decoder_at(sv, offset);
+                UTF_CHECK(it.base() == text.data() + offsets[character]);
+                std::u32string forward;
+                for (utf::decode_iterator<CharT> end = utf::decoder_at(sv, text.size()); it != end; ++it) {
+                    forward += *it;
+                }
+                UTF_CHECK(forward == code_points.substr(character));
+
+                std::u32string backward;
+                for (it = utf::decoder_at(sv, offset); it.base() != text.data();) {
+                    backward.insert(backward.begin(), *--it);
+                }
+                UTF_CHECK(backward == code_points.substr(0, character));
+            }
+            // the same steps by the postfix operators
+            utf::decode_iterator<CharT> it = utf::decoder_at(sv, 0);
+            for (size_t character = 0; character < size; ++character) {
+                UTF_CHECK(*it++ == code_points[character]);
+            }
+            for (size_t character = size; character != 0; --character) {
+                it--;
+                UTF_CHECK(*it == code_points[character - 1]);
+            }
+        }
+    }
+
+    template <typename CharT>
+    void test_last_code_points(random_engine& rng) {
+        const std::u32string           code_points = random_code_points(rng, 100, text_mix_e::wide);
+        const std::basic_string<CharT> text       = encode<CharT>(code_points);
+        for (const size_t count : {0, 1, 2, 37, 100, 101}) {
+            const std::basic_string_view<CharT> tail = utf::last_code_points(std::basic_string_view<CharT>(text), count);
+            UTF_CHECK(tail == encode<CharT>(code_points.substr(code_points.size() - std::min<size_t>(count, code_points.size()))));
+            UTF_CHECK(tail.data() + tail.size() == text.data() + text.size());
+        }
+    }
+
+    void test_invalid_and_swapped() {
+        // every code unit which can't be decoded is one U+FFFD in both directions
+        std::basic_string<char8_t> utf8 = to_utf8(U"a\u00E9");
+        utf8.insert(utf8.begin() + 1, static_cast<char8_t>(0x80));
+        utf8 += static_cast<char8_t>(0xE2);
+        const std::u32string expected = U"a\uFFFD\u00E9\uFFFD";
+        std::u32string       forward;
+        for (auto it = utf::decoder_at(std::basic_string_view<char8_t>(utf8), 0); it.base() != utf8.data() + utf8.size(); ++it) {
+            forward += *it;
+        }
+        UTF_CHECK(forward == expected);
+        std::u32string backward;
+        for (auto it = utf::decoder_at(std::basic_string_view<char8_t>(utf8), utf8.size()); it.base() != utf8.data();) {
+            backward.insert(backward.begin(), *--it);
+        }
+        UTF_CHECK(backward == expected);
+
+        // a lone low surrogate is decoded on its own, not joined with the character before it
+        const std::u16string lone = std::u16string(u"a") + static_cast<char16_t>(0xDC00);
+        UTF_CHECK(utf::character_start(std::u16string_view(lone), 1) == 1);
+        UTF_CHECK(*utf::decoder_at(std::u16string_view(lone), 1) == 0xDC00);
+
+        // a swapped BOM gives the byte order, offsets inside a pair move to its start
+        std::u16string swapped_text = u"\uFEFFx\U0001F600";
+        for (char16_t& code_unit : swapped_text) {
+            code_unit = swapped(code_unit);
+        }
+        const std::u16string_view swapped_sv(swapped_text);
+        UTF_CHECK(utf::character_start(swapped_sv, 3) == 2);
+        auto it = utf::decoder_at(swapped_sv, 3);
+        UTF_CHECK(*it == U'\U0001F600');
+        UTF_CHECK(*--it == U'x');
+        UTF_CHECK(utf::last_code_points(swapped_sv, 1) == swapped_sv.substr(2));
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(49);
+    test_decoder_at<char8_t>(rng);
+    test_decoder_at<char16_t>(rng);
+    test_decoder_at<char32_t>(rng);
+    test_last_code_points<char8_t>(rng);
+    test_last_code_points<char16_t>(rng);
+    test_last_code_points<char32_t>(rng);
+    test_invalid_and_swapped();
+    return result();
+}
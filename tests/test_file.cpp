@@ -0,0 +1,110 @@
+/**
+ * @file test_file.cpp
+ * @brief Checks file-to-file conversion through memory mappings, and what happens to the target when it fails.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_file.hpp"
+
+#include <fstream>
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    void write_file(const std::filesystem::path& path, const std::vector<std::byte>& bytes) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::vector<std::byte> read_file(const std::filesystem::path& path) {
+        std::ifstream          file(path, std::ios::binary);
+        std::vector<std::byte> bytes(static_cast<size_t>(std::filesystem::file_size(path)));
+        file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return bytes;
+    }
+
+    void test_round_trips(random_engine& rng, const std::filesystem::path& directory) {
+        // large enough for four threads in every encoding
+        const std::u32string        code_points = random_code_points(rng, 4 * utf::parallel_min_chunk_size + 3, text_mix_e::mixed);
+        const std::filesystem::path input       = directory / "input";
+        const std::filesystem::path output      = directory / "output";
+        for (const utf::encoding_e from : all_encodings) {
+            write_file(input, to_encoding(code_points, from));
+            for (const utf::encoding_e to : all_encodings) {
+                for (const unsigned thread_count : {1u, 4u}) {
+                    utf::transcode_options options;
+                    options.thread_count = thread_count;
+                    std::error_code error;
+                    UTF_CHECK(utf::convert_file(input, from, output, to, error, options) == status_e::success && !error);
+                    UTF_CHECK(read_file(output) == to_encoding(code_points, to));
+                }
+            }
+        }
+
+        // the BOM policy, and an empty file which isn't mapped at all
+        std::error_code        error;
+        utf::transcode_options options;
+        options.bom_policy = utf::bom_e::add;
+        write_file(input, to_encoding(code_points.substr(0, 100), utf::encoding_e::utf8));
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf8, output, utf::encoding_e::utf16_be, error, options) == status_e::success);
+        UTF_CHECK(read_file(output) == to_encoding(U"\uFEFF" + code_points.substr(0, 100), utf::encoding_e::utf16_be));
+        write_file(input, {});
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf16, output, utf::encoding_e::utf8, error) == status_e::success && !error);
+        UTF_CHECK(std::filesystem::exists(output) && std::filesystem::file_size(output) == 0);
+    }
+
+    void test_failures(const std::filesystem::path& directory) {
+        const std::filesystem::path  input    = directory / "input";
+        const std::filesystem::path  output   = directory / "output";
+        const std::vector<std::byte> previous = to_encoding(U"previous", utf::encoding_e::utf8);
+        std::error_code              error;
+
+        // invalid sources are rejected before the target is touched
+        write_file(input, to_encoding(U"abc", utf::encoding_e::utf8));
+        write_file(output, previous);
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf16_le, output, utf::encoding_e::utf8, error) == status_e::character_cut_off && !error);
+        UTF_CHECK(read_file(output) == previous);
+        write_file(input, to_encoding(U"ab\xD800", utf::encoding_e::utf32_le));
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf32_le, output, utf::encoding_e::utf8, error, true) == status_e::non_standard_encoding && !error);
+        UTF_CHECK(read_file(output) == previous);
+
+        // converting a file into itself would truncate it while it's read
+        write_file(input, previous);
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf8, input, utf::encoding_e::utf16, error) == status_e::undefined_error);
+        UTF_CHECK(error == std::errc::invalid_argument);
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf8, directory / "." / "input", utf::encoding_e::utf16, error) == status_e::undefined_error);
+        UTF_CHECK(error == std::errc::invalid_argument);
+        UTF_CHECK(read_file(input) == previous);
+
+        // I/O errors: a missing source creates nothing, a target which can't be opened isn't removed
+        const std::filesystem::path missing = directory / "missing";
+        UTF_CHECK(utf::convert_file(missing, utf::encoding_e::utf8, output, utf::encoding_e::utf16, error) == status_e::undefined_error);
+        UTF_CHECK(error == std::errc::no_such_file_or_directory);
+        const std::filesystem::path target_directory = directory / "target";
+        std::filesystem::create_directory(target_directory);
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf8, target_directory, utf::encoding_e::utf16, error) == status_e::undefined_error);
+        UTF_CHECK(static_cast<bool>(error));
+        UTF_CHECK(std::filesystem::is_directory(target_directory));
+        UTF_CHECK(utf::convert_file(input, utf::encoding_e::utf8, missing / "output", utf::encoding_e::utf16, error) == status_e::undefined_error);
+        UTF_CHECK(static_cast<bool>(error) && !std::filesystem::exists(missing));
+    }
+} // namespace
+
+int main(int, char** argv) {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    // every variant gets its own directory
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / std::filesystem::path(argv[0]).filename().concat(".files");
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    random_engine rng(31);
+    test_round_trips(rng, directory);
+    test_failures(directory);
+
+    std::filesystem::remove_all(directory);
+    return result();
+}
@@ -0,0 +1,166 @@
+/**
+ * @file test_incremental.cpp
+ * @brief Checks conversion of edits of a UTF-8 document into edits of its UTF-16 copy, and the spacing of the offset map.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_incremental.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    /**
+     * @brief Counts UTF-16 code units of valid UTF-8 bytes.
+     */
+    size_t utf16_size_of(const std::basic_string_view<char8_t>& utf8_sv) {
+        size_t size = 0;
+        for (const char8_t code_unit : utf8_sv) {
+            const uint8_t byte = static_cast<uint8_t>(code_unit);
+            size += (byte & 0xC0) != 0x80 ? (byte >= 0xF0 ? 2 : 1) : 0;
+        }
+        return size;
+    }
+
+    /**
+     * @brief Moves an offset forward to the start of a character.
+     */
+    size_t character_start(const std::basic_string<char8_t>& utf8, size_t offset) {
+        while (offset < utf8.size() && (static_cast<uint8_t>(utf8[offset]) & 0xC0) == 0x80) {
+            ++offset;
+        }
+        return offset;
+    }
+
+    /**
+     * @brief Document with its UTF-16 copy and offset map, edited through #utf::conversion::utf8_edit_to_utf16.
+     */
+    struct document {
+        std::basic_string<char8_t> utf8;
+        std::u16string             utf16;
+        utf::utf16_offset_map      offset_map;
+
+        document(const std::u32string& code_points, const size_t stride)
+            : utf8(to_utf8(code_points)), utf16(to_utf16(code_points)), offset_map(utf8, stride) {}
+
+        void edit(const size_t byte_offset, const size_t removed_size, const std::basic_string<char8_t>& inserted) {
+            utf::utf16_edit utf16_edit;
+            UTF_CHECK(utf::conversion::utf8_edit_to_utf16(utf8, offset_map, byte_offset, removed_size, inserted, utf16_edit) == status_e::success);
+            utf8.replace(byte_offset, removed_size, inserted);
+            utf16.replace(utf16_edit.offset, utf16_edit.removed_size, utf16_edit.inserted);
+        }
+
+        /**
+         * @brief Checks the copy and every pair of the map, and that pairs are at most a stride and a character apart.
+         */
+        void check() const {
+            std::u16string expected;
+            UTF_CHECK(utf::conversion::utf8_to_utf16(utf8, expected) == status_e::success);
+            UTF_CHECK(utf16 == expected);
+            UTF_CHECK(offset_map.utf8_size() == utf8.size());
+            UTF_CHECK(offset_map.utf16_size() == utf16.size());
+
+            const auto& pairs = offset_map.checkpoints();
+            UTF_CHECK(!pairs.empty() && pairs.front().utf8 == 0 && pairs.front().utf16 == 0);
+            for (size_t index = 1; index < pairs.size(); ++index) {
+                UTF_CHECK(pairs[index].utf8 > pairs[index - 1].utf8);
+                UTF_CHECK(pairs[index].utf8 - pairs[index - 1].utf8 <= offset_map.stride() + 3);
+                UTF_CHECK(pairs[index].utf8 < utf8.size() && (static_cast<uint8_t>(utf8[pairs[index].utf8]) & 0xC0) != 0x80);
+                UTF_CHECK(pairs[index].utf16 == utf16_size_of(std::basic_string_view<char8_t>(utf8).substr(0, pairs[index].utf8)));
+            }
+            UTF_CHECK(utf8.size() - pairs.back().utf8 <= offset_map.stride() + 3);
+        }
+
+        /**
+         * @brief Checks translation of random offsets both ways.
+         */
+        void check_offsets(random_engine& rng) const {
+            for (size_t sample = 0; sample < 64; ++sample) {
+                const size_t byte_offset  = character_start(utf8, random_below(rng, utf8.size() + 1));
+                const size_t utf16_offset = utf16_size_of(std::basic_string_view<char8_t>(utf8).substr(0, byte_offset));
+                UTF_CHECK(offset_map.utf16_offset_of(utf8, byte_offset) == utf16_offset);
+                UTF_CHECK(offset_map.byte_offset_of(utf8, utf16_offset) == byte_offset);
+            }
+        }
+    };
+
+    /**
+     * @brief Types thousands of single characters at a cursor, the pairs around it must not drift apart.
+     */
+    void check_typing(random_engine& rng, const text_mix_e mix) {
+        document text(random_code_points(rng, 4000, text_mix_e::mixed), 64);
+        size_t   cursor = character_start(text.utf8, text.utf8.size() / 2);
+        for (size_t keystroke = 1; keystroke <= 5000; ++keystroke) {
+            const std::basic_string<char8_t> character = to_utf8(std::u32string(1, random_code_point(rng, mix)));
+            text.edit(cursor, 0, character);
+            cursor += character.size();
+            if (keystroke % 500 == 0) {
+                text.check();
+                text.check_offsets(rng);
+            }
+        }
+        // and erases them again with backspace
+        for (size_t keystroke = 1; keystroke <= 5000; ++keystroke) {
+            size_t start = cursor - 1;
+            while ((static_cast<uint8_t>(text.utf8[start]) & 0xC0) == 0x80) {
+                --start;
+            }
+            text.edit(start, cursor - start, {});
+            cursor = start;
+            if (keystroke % 500 == 0) {
+                text.check();
+                text.check_offsets(rng);
+            }
+        }
+    }
+
+    /**
+     * @brief Replaces random ranges of characters by random text of up to a few strides.
+     */
+    void check_random_edits(random_engine& rng) {
+        document text(random_code_points(rng, 2000, text_mix_e::wide), 32);
+        for (size_t edit = 1; edit <= 2000; ++edit) {
+            const size_t byte_offset  = character_start(text.utf8, random_below(rng, text.utf8.size() + 1));
+            const size_t removed_size = character_start(text.utf8, byte_offset + random_below(rng, std::min<size_t>(text.utf8.size() - byte_offset, 100) + 1)) - byte_offset;
+            const size_t length       = random_below(rng, 4) == 0 ? random_below(rng, 32) : random_below(rng, 3);
+            text.edit(byte_offset, removed_size, to_utf8(random_code_points(rng, length, text_mix_e::wide)));
+            if (edit % 100 == 0) {
+                text.check();
+                text.check_offsets(rng);
+            }
+        }
+        text.check();
+    }
+
+    /**
+     * @brief Checks rejected edits leave everything unchanged and edits inside characters are widened.
+     */
+    void check_failures() {
+        document        text(U"ab\u00E9c", 16);
+        utf::utf16_edit utf16_edit;
+        UTF_CHECK(utf::conversion::utf8_edit_to_utf16(text.utf8, text.offset_map, 6, 0, u8"x", utf16_edit) == status_e::undefined_error);
+        UTF_CHECK(utf::conversion::utf8_edit_to_utf16(text.utf8, text.offset_map, 2, 4, u8"x", utf16_edit) == status_e::undefined_error);
+        const std::basic_string<char8_t> invalid(1, static_cast<char8_t>(0xC3));
+        UTF_CHECK(utf::conversion::utf8_edit_to_utf16(text.utf8, text.offset_map, 1, 0, invalid, utf16_edit) != status_e::success);
+        UTF_CHECK(utf16_edit.inserted.empty() && text.offset_map.utf8_size() == text.utf8.size());
+        text.check();
+
+        // replacing the trailing byte of U+00E9 makes it U+00E8
+        text.edit(3, 1, std::basic_string<char8_t>(1, static_cast<char8_t>(0xA8)));
+        UTF_CHECK(text.utf16 == u"ab\u00E8c");
+        text.check();
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(42);
+    check_typing(rng, text_mix_e::ascii);
+    check_typing(rng, text_mix_e::wide);
+    check_random_edits(rng);
+    check_failures();
+    return result();
+}
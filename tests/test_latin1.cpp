@@ -0,0 +1,85 @@
+/**
+ * @file test_latin1.cpp
+ * @brief Checks Latin-1 conversions: containers and raw pointers take the vectorized kernels, other iterators the scalar loop.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_latin1.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    std::string to_latin1(const std::u32string& code_points) {
+        std::string result;
+        for (const char32_t code_point : code_points) {
+            result += static_cast<char>(code_point);
+        }
+        return result;
+    }
+
+    void test_from_latin1(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const text_mix_e mix : {text_mix_e::ascii, text_mix_e::latin1}) {
+                const std::u32string code_points = random_code_points(rng, size, mix);
+                const std::string    latin1      = to_latin1(code_points);
+                const size_t         offset      = size % 3;
+                const std::string    shifted     = std::string(offset, 'x') + latin1;
+                const std::string_view input = std::string_view(shifted).substr(offset);
+
+                check_sinks<char8_t>([&](auto&& sink) { return utf::conversion::latin1_to_utf8(input, sink); }, to_utf8(code_points), offset);
+                check_sinks<char16_t>([&](auto&& sink) { return utf::conversion::latin1_to_utf16(input, sink); }, to_utf16(code_points), offset);
+                check_sinks<char32_t>([&](auto&& sink) { return utf::conversion::latin1_to_utf32(input, sink); }, code_points, offset);
+            }
+        }
+    }
+
+    void test_to_latin1(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const text_mix_e mix : {text_mix_e::ascii, text_mix_e::latin1}) {
+                const std::u32string             code_points = random_code_points(rng, size, mix);
+                const std::string                latin1      = to_latin1(code_points);
+                const std::basic_string<char8_t> utf8        = to_utf8(code_points);
+                const std::u16string             utf16       = to_utf16(code_points);
+                const size_t                     offset      = size % 3;
+
+                check_sinks<char>([&](auto&& sink) { return utf::conversion::utf8_to_latin1(utf8, sink); }, latin1, offset);
+                check_sinks<char>([&](auto&& sink) { return utf::conversion::utf16_to_latin1(utf16, sink); }, latin1, offset);
+                check_sinks<char>([&](auto&& sink) { return utf::conversion::utf32_to_latin1(code_points, sink); }, latin1, offset);
+
+                // a swapped BOM gives the byte order
+                std::u16string swapped_utf16 = u'\uFEFF' + utf16;
+                for (char16_t& code_unit : swapped_utf16) {
+                    code_unit = swapped(code_unit);
+                }
+                std::string converted;
+                UTF_CHECK(utf::conversion::utf16_to_latin1(swapped_utf16, converted) == status_e::success);
+                UTF_CHECK(converted == latin1);
+
+                // one character above U+00FF anywhere fails and clears the container
+                if (size != 0) {
+                    std::u32string wide = code_points;
+                    wide[random_below(rng, size)] = random_below(rng, 2) == 0 ? U'\u0100' : U'\U0001F600';
+                    converted = "previous";
+                    UTF_CHECK(utf::conversion::utf8_to_latin1(to_utf8(wide), converted) == status_e::unrepresentable_character);
+                    UTF_CHECK(converted.empty());
+                    UTF_CHECK(utf::conversion::utf16_to_latin1(to_utf16(wide), converted) == status_e::unrepresentable_character);
+                    UTF_CHECK(utf::conversion::utf32_to_latin1(wide, converted) == status_e::unrepresentable_character);
+                }
+            }
+        }
+        std::string converted;
+        UTF_CHECK(utf::conversion::utf8_to_latin1(std::basic_string<char8_t>(1, static_cast<char8_t>(0xC3)), converted) == status_e::character_cut_off);
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(38);
+    test_from_latin1(rng);
+    test_to_latin1(rng);
+    return result();
+}
@@ -0,0 +1,127 @@
+/**
+ * @file test_maybe.cpp
+ * @brief Checks that zero-copy conversions borrow the input exactly when converting would reproduce it.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_maybe.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    template <typename CharT>
+    status_e canonicalize(const std::basic_string_view<CharT>& sv, utf::maybe_converted<CharT>& result, const bool comply_with_standard = false,
+                          const utf::bom_e bom_policy = utf::bom_e::keep) {
+        if constexpr (sizeof(CharT) == 1) {
+            return utf::conversion::utf8_to_utf8(sv, result, comply_with_standard, bom_policy);
+        }
+        else if constexpr (sizeof(CharT) == 2) {
+            return utf::conversion::utf16_to_utf16(sv, result, comply_with_standard, bom_policy);
+        }
+        else {
+            return utf::conversion::utf32_to_utf32(sv, result, comply_with_standard, bom_policy);
+        }
+    }
+
+    // the result borrows the input and starts @p offset code units into it
+    template <typename CharT>
+    bool points_into(const utf::maybe_converted<CharT>& result, const std::basic_string<CharT>& input, const size_t offset) {
+        return !result.owns_memory() && result.data() == input.data() + offset;
+    }
+
+    template <typename CharT>
+    void test_borrowed(random_engine& rng) {
+        const std::basic_string<CharT> bom = encode<CharT>(U"\uFEFF");
+        for (const size_t size : boundary_sizes) {
+            for (const text_mix_e mix : {text_mix_e::ascii, text_mix_e::mixed, text_mix_e::wide}) {
+                const std::basic_string<CharT> text = encode<CharT>(random_code_points(rng, size, mix));
+                utf::maybe_converted<CharT>    result;
+                UTF_CHECK(canonicalize(std::basic_string_view<CharT>(text), result, true) == status_e::success);
+                UTF_CHECK(points_into(result, text, 0) && result.view() == text);
+
+                // stripping the BOM only narrows the view, adding one copies
+                const std::basic_string<CharT> with_bom = bom + text;
+                UTF_CHECK(canonicalize(std::basic_string_view<CharT>(with_bom), result, true, utf::bom_e::strip) == status_e::success);
+                UTF_CHECK(points_into(result, with_bom, bom.size()) && result.view() == text);
+                UTF_CHECK(canonicalize(std::basic_string_view<CharT>(with_bom), result, true, utf::bom_e::keep) == status_e::success);
+                UTF_CHECK(points_into(result, with_bom, 0));
+                UTF_CHECK(canonicalize(std::basic_string_view<CharT>(text), result, true, utf::bom_e::add) == status_e::success);
+                UTF_CHECK(result.owns_memory() && result.view() == with_bom);
+                UTF_CHECK(std::move(result).to_string() == with_bom);
+            }
+        }
+    }
+
+    template <typename CharT>
+    void test_swapped(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::basic_string<CharT> text = encode<CharT>(U"\uFEFF" + random_code_points(rng, size, text_mix_e::wide));
+            std::basic_string<CharT>       swapped_text;
+            for (const CharT code_unit : text) {
+                swapped_text += swapped(code_unit);
+            }
+            // the result is in host byte order, so a swapped string is always copied
+            utf::maybe_converted<CharT> result;
+            UTF_CHECK(canonicalize(std::basic_string_view<CharT>(swapped_text), result, true) == status_e::success);
+            UTF_CHECK(result.owns_memory() && result.view() == text);
+            UTF_CHECK(canonicalize(std::basic_string_view<CharT>(swapped_text), result, true, utf::bom_e::strip) == status_e::success);
+            UTF_CHECK(result.owns_memory() && result.view() == text.substr(1));
+        }
+    }
+
+    void test_overlong() {
+        // U+0041 in two bytes, after an ASCII prefix long enough to be skipped with vectors
+        for (const size_t prefix_size : {size_t(0), size_t(1), size_t(100)}) {
+            const std::basic_string<char8_t> prefix(prefix_size, static_cast<char8_t>('x'));
+            std::basic_string<char8_t>       overlong = prefix;
+            overlong += static_cast<char8_t>(0xC1);
+            overlong += static_cast<char8_t>(0x81);
+            overlong += to_utf8(U"\u00E9");
+            utf::maybe_converted<char8_t> result;
+            UTF_CHECK(utf::conversion::utf8_to_utf8(std::basic_string_view<char8_t>(overlong), result) == status_e::success);
+            UTF_CHECK(result.owns_memory() && result.view() == prefix + to_utf8(U"A\u00E9"));
+            UTF_CHECK(utf::conversion::utf8_to_utf8(std::basic_string_view<char8_t>(overlong), result, false, utf::bom_e::add) == status_e::success);
+            UTF_CHECK(result.owns_memory() && result.view() == to_utf8(U"\uFEFF") + prefix + to_utf8(U"A\u00E9"));
+            // complying with the standard rejects them instead, and the result is cleared
+            UTF_CHECK(utf::conversion::utf8_to_utf8(std::basic_string_view<char8_t>(overlong), result, true) != status_e::success);
+            UTF_CHECK(!result.owns_memory() && result.empty());
+        }
+    }
+
+    void test_invalid() {
+        utf::maybe_converted<char8_t> utf8_result;
+        const std::basic_string<char8_t> cut_off = to_utf8(U"ab") + static_cast<char8_t>(0xE2);
+        UTF_CHECK(utf::conversion::utf8_to_utf8(std::basic_string_view<char8_t>(cut_off), utf8_result) == status_e::character_cut_off);
+        UTF_CHECK(utf8_result.empty());
+
+        // unpaired surrogates are only rejected when complying with the standard
+        const std::u16string           unpaired = u"abc" + std::u16string(1, char16_t(0xD800)) + u"d";
+        utf::maybe_converted<char16_t> utf16_result;
+        UTF_CHECK(utf::conversion::utf16_to_utf16(std::u16string_view(unpaired), utf16_result) == status_e::success);
+        UTF_CHECK(points_into(utf16_result, unpaired, 0));
+        UTF_CHECK(utf::conversion::utf16_to_utf16(std::u16string_view(unpaired), utf16_result, true) != status_e::success);
+        UTF_CHECK(utf16_result.empty());
+
+        const std::u32string           out_of_range(1, char32_t(0x110000));
+        utf::maybe_converted<char32_t> utf32_result;
+        UTF_CHECK(utf::conversion::utf32_to_utf32(std::u32string_view(out_of_range), utf32_result) != status_e::success);
+        UTF_CHECK(utf32_result.empty());
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(37);
+    test_borrowed<char8_t>(rng);
+    test_borrowed<char16_t>(rng);
+    test_borrowed<char32_t>(rng);
+    test_swapped<char16_t>(rng);
+    test_swapped<char32_t>(rng);
+    test_overlong();
+    test_invalid();
+    return result();
+}
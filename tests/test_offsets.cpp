@@ -0,0 +1,187 @@
+/**
+ * @file test_offsets.cpp
+ * @brief Checks the code point index and the translation of offsets and line/character positions.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_index.hpp"
+#include "utf-utils/utf_offsets.hpp"
+
+using namespace utf_test;
+using utf::position_encoding_e;
+
+namespace {
+    /**
+     * @brief Offsets of every character of a text in each unit, plus the totals at the end.
+     */
+    struct character_offsets {
+        std::vector<size_t> utf8;
+        std::vector<size_t> utf16;
+        std::vector<size_t> utf32;
+
+        explicit character_offsets(const std::u32string& code_points) {
+            size_t utf8_offset  = 0;
+            size_t utf16_offset = 0;
+            for (size_t index = 0; index <= code_points.size(); ++index) {
+                utf8.push_back(utf8_offset);
+                utf16.push_back(utf16_offset);
+                utf32.push_back(index);
+                if (index != code_points.size()) {
+                    utf8_offset  += to_utf8(code_points.substr(index, 1)).size();
+                    utf16_offset += code_points[index] >= 0x10000 ? 2 : 1;
+                }
+            }
+        }
+
+        const std::vector<size_t>& in(const position_encoding_e encoding) const {
+            return encoding == position_encoding_e::utf8 ? utf8 : encoding == position_encoding_e::utf16 ? utf16 : utf32;
+        }
+
+        /**
+         * @brief Index of the character an offset points into, the number of characters past the end.
+         */
+        size_t character_of(const size_t offset, const position_encoding_e encoding) const {
+            const std::vector<size_t>& offsets = in(encoding);
+            if (offset >= offsets.back()) {
+                return offsets.size() - 1;
+            }
+            return static_cast<size_t>(std::upper_bound(offsets.begin(), offsets.end(), offset) - offsets.begin()) - 1;
+        }
+    };
+
+    /**
+     * @brief Step through offsets: every one of short texts, a sample of long ones.
+     */
+    size_t next_step(random_engine& rng, const size_t size) {
+        return size > 300 ? 1 + random_below(rng, 24) : 1;
+    }
+
+    constexpr position_encoding_e all_position_encodings[] = {position_encoding_e::utf8, position_encoding_e::utf16, position_encoding_e::utf32};
+
+    void test_utf8_index(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string             code_points = random_code_points(rng, size, text_mix_e::wide);
+            const std::basic_string<char8_t> text        = to_utf8(code_points);
+            const character_offsets          offsets(code_points);
+            for (const size_t stride : {size_t{0}, size_t{1}, size_t{3}, size_t{16}, utf::utf8_index::default_stride}) {
+                const utf::utf8_index index(text, stride);
+                UTF_CHECK(index.size() == size);
+                for (size_t code_point = 0; code_point <= size + 1; code_point += next_step(rng, size)) {
+                    UTF_CHECK(index.byte_offset_of(code_point) == offsets.utf8[std::min(code_point, size)]);
+                }
+                for (size_t byte = 0; byte <= text.size() + 1; byte += next_step(rng, size)) {
+                    UTF_CHECK(index.code_point_index_of(byte) == offsets.character_of(byte, position_encoding_e::utf8));
+                }
+            }
+        }
+    }
+
+    void test_offset_functions(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string             code_points = random_code_points(rng, size, text_mix_e::wide);
+            const std::basic_string<char8_t> text        = to_utf8(code_points);
+            const character_offsets          offsets(code_points);
+            for (const position_encoding_e from : all_position_encodings) {
+                for (size_t offset = 0; offset <= offsets.in(from).back() + 1; offset += next_step(rng, size)) {
+                    const size_t character = offsets.character_of(offset, from);
+                    UTF_CHECK(utf::byte_offset_from(text, offset, from) == offsets.utf8[character]);
+                    if (from == position_encoding_e::utf8) {
+                        for (const position_encoding_e to : all_position_encodings) {
+                            UTF_CHECK(utf::offset_from_byte(text, offset, to) == offsets.in(to)[character]);
+                        }
+                    }
+                    const position_encoding_e to = all_position_encodings[random_below(rng, 3)];
+                    UTF_CHECK(utf::convert_offset(text, offset, from, to) == offsets.in(to)[character]);
+                }
+            }
+        }
+    }
+
+    void test_line_index(random_engine& rng) {
+        const char32_t* const breaks[] = {U"\n", U"\r\n", U"\r"};
+        for (const size_t size : boundary_sizes) {
+            // characters and line breaks, including empty lines and a break at the end
+            std::u32string              code_points;
+            std::vector<std::u32string> lines(1);
+            for (size_t index = 0; index < size; ++index) {
+                if (random_below(rng, 8) == 0) {
+                    const std::u32string line_break = breaks[random_below(rng, 3)];
+                    // a lone CR followed by LF would be CR LF
+                    if (line_break == U"\r" && random_below(rng, 2) == 0) {
+                        continue;
+                    }
+                    code_points += line_break;
+                    if (line_break == U"\r") {
+                        code_points += U'x';
+                        lines.back() += U'\r';
+                        lines.push_back(U"x");
+                        continue;
+                    }
+                    lines.emplace_back();
+                }
+                else {
+                    const char32_t code_point = random_code_point(rng, text_mix_e::wide);
+                    if (code_point == U'\n' || code_point == U'\r') {
+                        continue;
+                    }
+                    code_points += code_point;
+                    lines.back() += code_point;
+                }
+            }
+            // the lone CR written above belongs to the end of its line
+            for (std::u32string& line : lines) {
+                if (!line.empty() && line.back() == U'\r') {
+                    line.pop_back();
+                }
+            }
+            const std::basic_string<char8_t> text = to_utf8(code_points);
+            const utf::line_index            index(text);
+            UTF_CHECK(index.line_count() == lines.size());
+            if (index.line_count() != lines.size()) {
+                continue;
+            }
+
+            std::vector<size_t> starts;
+            for (size_t line = 0, offset = 0; line < lines.size(); ++line) {
+                starts.push_back(offset);
+                const size_t end = offset + to_utf8(lines[line]).size();
+                offset = end + (line + 1 == lines.size() ? 0 : text[end] == '\r' && end + 1 < text.size() && text[end + 1] == '\n' ? 2 : 1);
+            }
+            for (size_t line = 0; line < lines.size(); ++line) {
+                const character_offsets offsets(lines[line]);
+                UTF_CHECK(index.line_start(line) == starts[line]);
+                UTF_CHECK(index.line(line) == to_utf8(lines[line]));
+                const size_t line_end = line + 1 == lines.size() ? text.size() : starts[line + 1];
+                for (size_t byte = starts[line]; byte < line_end; byte += next_step(rng, size)) {
+                    UTF_CHECK(index.line_of(byte) == line);
+                    const position_encoding_e encoding = all_position_encodings[random_below(rng, 3)];
+                    const utf::text_position  position = index.position_of(byte, encoding);
+                    UTF_CHECK(position.line == line);
+                    UTF_CHECK(position.character == offsets.in(encoding)[offsets.character_of(byte - starts[line], position_encoding_e::utf8)]);
+                }
+                for (const position_encoding_e encoding : all_position_encodings) {
+                    for (size_t character = 0; character < offsets.utf32.size(); character += next_step(rng, size)) {
+                        UTF_CHECK(index.byte_offset_of({line, offsets.in(encoding)[character]}, encoding) == starts[line] + offsets.utf8[character]);
+                    }
+                    // past the end of the line
+                    UTF_CHECK(index.byte_offset_of({line, offsets.in(encoding).back() + 5}, encoding) == starts[line] + offsets.utf8.back());
+                }
+            }
+            UTF_CHECK(index.line_start(lines.size()) == text.size());
+            UTF_CHECK(index.line(lines.size()).empty());
+            UTF_CHECK(index.byte_offset_of({lines.size(), 0}, position_encoding_e::utf16) == text.size());
+        }
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(40);
+    test_utf8_index(rng);
+    test_offset_functions(rng);
+    test_line_index(rng);
+    return result();
+}
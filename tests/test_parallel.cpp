@@ -0,0 +1,118 @@
+/**
+ * @file test_parallel.cpp
+ * @brief Checks that multi-threaded conversion splits at character boundaries and reports the first invalid part.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_parallel.hpp"
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    template <typename CharT>
+    std::basic_string<CharT> swapped_string(const std::basic_string<CharT>& string) {
+        std::basic_string<CharT> result;
+        for (const CharT code_unit : string) {
+            result += swapped(code_unit);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Converts on @p thread_count threads into a string, which is sized by the allocation callback.
+     */
+    template <typename InputCharT, typename OutputCharT>
+    status_e convert(const std::basic_string<InputCharT>& input, const bool input_reverse, const bool output_reverse, const unsigned thread_count,
+                     std::basic_string<OutputCharT>& output, const bool comply_with_standard = false, const utf::bom_e bom_policy = utf::bom_e::keep) {
+        utf::transcode_options options;
+        options.comply_with_standard = comply_with_standard;
+        options.thread_count         = thread_count;
+        options.bom_policy           = bom_policy;
+        output.assign(1, OutputCharT('?'));
+        return utf::transcode_parallel<InputCharT, OutputCharT>(std::basic_string_view<InputCharT>(input), input_reverse, output_reverse, options,
+                                                                [&output](const size_t size) {
+                                                                    output.assign(size, OutputCharT(0));
+                                                                    return output.data();
+                                                                });
+    }
+
+    template <typename InputCharT, typename OutputCharT>
+    void test_split(random_engine& rng) {
+        for (const unsigned thread_count : {2u, 3u, 4u, 0u}) {
+            // wide text, so that most even split points fall inside a character and have to be moved
+            const size_t                         size        = 2 * utf::parallel_min_chunk_size + random_below(rng, 3 * utf::parallel_min_chunk_size);
+            const std::u32string                 code_points = random_code_points(rng, size, text_mix_e::wide);
+            const std::basic_string<InputCharT>  input       = encode<InputCharT>(code_points);
+            const std::basic_string<OutputCharT> expected    = encode<OutputCharT>(code_points);
+
+            std::basic_string<OutputCharT> output;
+            UTF_CHECK((convert<InputCharT, OutputCharT>(input, false, false, thread_count, output)) == status_e::success);
+            UTF_CHECK(output == expected);
+            UTF_CHECK((convert<InputCharT, OutputCharT>(swapped_string(input), true, true, thread_count, output)) == status_e::success);
+            UTF_CHECK(output == swapped_string(expected));
+
+            // the BOM is written in front of the first part only
+            UTF_CHECK((convert<InputCharT, OutputCharT>(input, false, false, thread_count, output, false, utf::bom_e::add)) == status_e::success);
+            UTF_CHECK(output == encode<OutputCharT>(U"\uFEFF") + expected);
+            UTF_CHECK((convert<InputCharT, OutputCharT>(encode<InputCharT>(U"\uFEFF" + code_points), false, false, thread_count, output, false, utf::bom_e::strip)) ==
+                      status_e::success);
+            UTF_CHECK(output == expected);
+        }
+    }
+
+    template <typename CharT>
+    std::basic_string<CharT> invalid_unit() {
+        if constexpr (sizeof(CharT) == 1) {
+            return std::basic_string<CharT>(1, static_cast<CharT>(0xFF));
+        }
+        else if constexpr (sizeof(CharT) == 2) {
+            return std::basic_string<CharT>(1, static_cast<CharT>(0xDC00));
+        }
+        else {
+            return std::basic_string<CharT>(1, static_cast<CharT>(0x110000));
+        }
+    }
+
+    template <typename InputCharT>
+    void test_invalid(random_engine& rng) {
+        const std::basic_string<InputCharT> text = encode<InputCharT>(random_code_points(rng, 4 * utf::parallel_min_chunk_size, text_mix_e::mixed));
+        // in every part, and right at the even split points
+        for (const size_t at : {size_t(0), text.size() / 4, text.size() / 2 - 1, text.size() / 2, text.size() - 1, random_below(rng, text.size())}) {
+            std::basic_string<InputCharT> input = text;
+            input.insert(at, invalid_unit<InputCharT>());
+            // nothing is allocated or written
+            std::basic_string<char32_t> output;
+            UTF_CHECK((convert<InputCharT, char32_t>(input, false, false, 4, output, true)) != status_e::success);
+            UTF_CHECK(output == U"?");
+        }
+    }
+
+    void test_allocation_failure() {
+        const std::basic_string<char8_t> input = to_utf8(std::u32string(2 * utf::parallel_min_chunk_size, U'a'));
+        utf::transcode_options           options;
+        options.thread_count = 2;
+        UTF_CHECK((utf::transcode_parallel<char8_t, char16_t>(std::basic_string_view<char8_t>(input), false, false, options,
+                                                              [](size_t) { return static_cast<char16_t*>(nullptr); })) == status_e::undefined_error);
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(32);
+    test_split<char8_t, char16_t>(rng);
+    test_split<char8_t, char32_t>(rng);
+    test_split<char16_t, char8_t>(rng);
+    test_split<char16_t, char32_t>(rng);
+    test_split<char32_t, char8_t>(rng);
+    test_split<char32_t, char16_t>(rng);
+    test_split<char16_t, char16_t>(rng);
+    test_invalid<char8_t>(rng);
+    test_invalid<char16_t>(rng);
+    test_invalid<char32_t>(rng);
+    test_allocation_failure();
+    return result();
+}
@@ -0,0 +1,135 @@
+/**
+ * @file test_search.cpp
+ * @brief Checks code point search in UTF-8 text and substring search with the needle in another encoding.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_search.hpp"
+
+using namespace utf_test;
+
+namespace {
+    constexpr size_t npos = std::basic_string_view<char8_t>::npos;
+
+    /**
+     * @brief Random text over few characters of every length, so that needles are found often.
+     */
+    std::u32string small_alphabet_text(random_engine& rng, const size_t size) {
+        const char32_t alphabet[] = {U'a', U'b', U'\u00E9', U'\u20AC', U'\U0001F600', U'\U0001F601'};
+        std::u32string result(size, U'a');
+        for (char32_t& code_point : result) {
+            code_point = alphabet[random_below(rng, 6)];
+        }
+        return result;
+    }
+
+    void test_find_code_point(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string             code_points = small_alphabet_text(rng, size);
+            const std::basic_string<char8_t> text        = to_utf8(code_points);
+            for (int round = 0; round < 8; ++round) {
+                const char32_t code_point = round == 0 ? U'z' : random_below(rng, 2) == 0 ? code_points[random_below(rng, size)] : small_alphabet_text(rng, 1)[0];
+                const size_t   start      = random_below(rng, text.size() + 2);
+                const size_t   expected   = start > text.size() ? npos : text.find(to_utf8(std::u32string(1, code_point)), start);
+                UTF_CHECK(utf::find_code_point(text, code_point, start) == expected);
+            }
+            UTF_CHECK(utf::find_code_point(text, 0x110000) == npos);
+        }
+    }
+
+    void test_find_any_of(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string             code_points = random_code_points(rng, size, text_mix_e::mixed);
+            const std::basic_string<char8_t> text        = to_utf8(code_points);
+            for (const size_t count : {size_t{0}, size_t{1}, size_t{3}, size_t{8}, size_t{9}, size_t{20}}) {
+                std::u32string needles = random_code_points(rng, count, text_mix_e::wide);
+                if (count != 0 && size != 0) {
+                    needles[random_below(rng, count)] = code_points[random_below(rng, size)];
+                }
+                if (count > 2) {
+                    needles[0] = 0x110000;
+                }
+                const size_t start    = random_below(rng, text.size() + 1);
+                size_t       expected = npos;
+                for (const char32_t needle : needles) {
+                    if (needle <= 0x10FFFF) {
+                        expected = std::min(expected, text.find(to_utf8(std::u32string(1, needle)), start));
+                    }
+                }
+                UTF_CHECK(utf::find_any_of(text, needles, start) == expected);
+            }
+        }
+    }
+
+    /**
+     * @brief Number of code units a prefix of code points takes in an encoding.
+     */
+    template <typename CharT>
+    size_t units_of(const std::u32string& code_points, const size_t count) {
+        return encode<CharT>(code_points.substr(0, count)).size();
+    }
+
+    template <typename HaystackCharT, typename NeedleCharT>
+    void test_substring_searcher(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string                 code_points = small_alphabet_text(rng, size);
+            const std::basic_string<HaystackCharT> haystack  = encode<HaystackCharT>(code_points);
+            const size_t         needle_size   = 1 + random_below(rng, 4);
+            const size_t         needle_start  = random_below(rng, size + 1);
+            const std::u32string needle_points = random_below(rng, 4) == 0 || needle_start + needle_size > size ? small_alphabet_text(rng, needle_size)
+                                                                                                               : code_points.substr(needle_start, needle_size);
+            const std::basic_string<NeedleCharT> needle = encode<NeedleCharT>(needle_points);
+            const utf::substring_searcher<HaystackCharT, NeedleCharT> searcher(needle);
+            UTF_CHECK(searcher.status() == utf::conversion::status_e::success);
+            UTF_CHECK(searcher.needle() == encode<HaystackCharT>(needle_points));
+
+            // every match in turn, each search starting past the previous match
+            utf::search_position start;
+            size_t               from = 0;
+            for (int match = 0; match < 4; ++match) {
+                const size_t character = code_points.find(needle_points, from);
+                const utf::search_position found = searcher.find(haystack, start);
+                if (character == std::u32string::npos) {
+                    UTF_CHECK(found.haystack_units == npos);
+                    break;
+                }
+                UTF_CHECK(found.haystack_units == units_of<HaystackCharT>(code_points, character));
+                UTF_CHECK(found.needle_units == units_of<NeedleCharT>(code_points, character));
+                start = {found.haystack_units + searcher.needle().size(), found.needle_units + needle.size()};
+                from  = character + needle_points.size();
+            }
+            const utf::search_position first = utf::find(std::basic_string_view<HaystackCharT>(haystack), std::basic_string_view<NeedleCharT>(needle));
+            const size_t               character = code_points.find(needle_points);
+            UTF_CHECK(first.haystack_units == (character == std::u32string::npos ? npos : units_of<HaystackCharT>(code_points, character)));
+        }
+    }
+
+    void test_swapped_haystack() {
+        // the BOM gives the byte order, offsets count it
+        std::u16string haystack = u"\uFEFFxy\U0001F600z";
+        for (char16_t& code_unit : haystack) {
+            code_unit = swapped(code_unit);
+        }
+        const utf::search_position found = utf::find(std::u16string_view(haystack), std::basic_string_view<char8_t>(to_utf8(U"z")));
+        UTF_CHECK(found.haystack_units == 5);
+        UTF_CHECK(found.needle_units == 9);
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(46);
+    test_find_code_point(rng);
+    test_find_any_of(rng);
+    test_substring_searcher<char8_t, char16_t>(rng);
+    test_substring_searcher<char8_t, char32_t>(rng);
+    test_substring_searcher<char16_t, char8_t>(rng);
+    test_substring_searcher<char16_t, char16_t>(rng);
+    test_substring_searcher<char32_t, char8_t>(rng);
+    test_substring_searcher<char32_t, char16_t>(rng);
+    test_swapped_haystack();
+    return result();
+}
@@ -0,0 +1,352 @@
+/**
+ * @file test_simd.cpp
+ * @brief Checks the kernels of utf_simd.hpp against plain loops, on unaligned data and sizes around their block sizes.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_simd.hpp"
+
+using namespace utf_test;
+
+namespace {
+    constexpr size_t misalignments[] = {0, 1, 2, 3, 5, 15};
+
+    /**
+     * @brief Returns bytes which all pass a kernel's test except, sometimes, one or two planted at random positions.
+     */
+    template <typename Passing, typename Planted>
+    std::vector<std::byte> planted_bytes(random_engine& rng, const size_t size, Passing passing, Planted planted) {
+        std::vector<std::byte> bytes(size);
+        for (std::byte& byte : bytes) {
+            byte = passing(rng);
+        }
+        for (size_t plant = random_below(rng, 3); plant != 0 && size != 0; --plant) {
+            bytes[random_below(rng, size)] = planted(rng);
+        }
+        return bytes;
+    }
+
+    std::byte ascii_byte(random_engine& rng) {
+        return static_cast<std::byte>(random_below(rng, 0x80));
+    }
+
+    std::byte any_byte(random_engine& rng) {
+        return static_cast<std::byte>(rng());
+    }
+
+    void test_copy_swapped(random_engine& rng) {
+        for (const size_t count : boundary_sizes) {
+            for (const size_t misalignment : misalignments) {
+                const std::vector<std::byte> source16 = random_bytes(rng, count * 2);
+                const std::vector<std::byte> source32 = random_bytes(rng, count * 4);
+                unaligned_copy               input16(source16, misalignment);
+                unaligned_copy               input32(source32, misalignment);
+                std::vector<std::byte>       destination(count * 4 + 64);
+
+                utf::copy_swapped<char16_t>(destination.data() + misalignment, input16.data(), count);
+                bool equal = true;
+                for (size_t index = 0; index < count * 2; ++index) {
+                    equal = equal && destination[misalignment + index] == source16[index ^ 1];
+                }
+                UTF_CHECK(equal);
+
+                utf::copy_swapped<char32_t>(destination.data() + misalignment, input32.data(), count);
+                equal = true;
+                for (size_t index = 0; index < count * 4; ++index) {
+                    equal = equal && destination[misalignment + index] == source32[index ^ 3];
+                }
+                UTF_CHECK(equal);
+
+                // in place
+                utf::copy_swapped<char32_t>(input32.data(), input32.data(), count);
+                UTF_CHECK(count == 0 || std::memcmp(input32.data(), destination.data() + misalignment, count * 4) == 0);
+                utf::copy_code_units<char16_t>(destination.data(), input16.data(), count, false);
+                UTF_CHECK(count == 0 || std::memcmp(destination.data(), source16.data(), count * 2) == 0);
+            }
+        }
+    }
+
+    void test_prefix_kernels(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const size_t misalignment : misalignments) {
+                // ASCII with planted non-ASCII bytes
+                std::vector<std::byte> bytes = planted_bytes(rng, size, ascii_byte, [](random_engine& r) { return static_cast<std::byte>(0x80 + random_below(r, 0x80)); });
+                unaligned_copy         input(bytes, misalignment);
+                size_t                 expected = 0;
+                while (expected < size && static_cast<uint8_t>(bytes[expected]) < 0x80) {
+                    ++expected;
+                }
+                UTF_CHECK(utf::ascii_prefix_size(input.data(), size) == expected);
+
+                // line breaks planted in text without them
+                bytes = planted_bytes(rng, size, [](random_engine& r) { return static_cast<std::byte>(' ' + random_below(r, 0xE0)); },
+                                      [](random_engine& r) { return static_cast<std::byte>(random_below(r, 2) == 0 ? '\n' : '\r'); });
+                unaligned_copy text(bytes, misalignment);
+                expected = 0;
+                while (expected < size && bytes[expected] != std::byte{'\n'} && bytes[expected] != std::byte{'\r'}) {
+                    ++expected;
+                }
+                UTF_CHECK(utf::find_line_break(text.data(), size) == expected);
+
+                // two copies which differ in planted bytes
+                const std::vector<std::byte> left  = random_bytes(rng, size);
+                std::vector<std::byte>       right = left;
+                if (size != 0 && random_below(rng, 4) != 0) {
+                    right[random_below(rng, size)] ^= std::byte{static_cast<unsigned char>(1 + random_below(rng, 255))};
+                }
+                unaligned_copy left_copy(left, misalignment);
+                unaligned_copy right_copy(right, misalignment + 7);
+                expected = 0;
+                while (expected < size && left[expected] == right[expected]) {
+                    ++expected;
+                }
+                UTF_CHECK(utf::common_prefix_size(left_copy.data(), right_copy.data(), size) == expected);
+            }
+        }
+    }
+
+    void test_surrogate_free_prefix_size(random_engine& rng) {
+        for (const size_t count : boundary_sizes) {
+            for (const size_t misalignment : misalignments) {
+                std::u16string code_units(count, u'\0');
+                for (char16_t& code_unit : code_units) {
+                    code_unit = static_cast<char16_t>(random_below(rng, 0xD800));
+                }
+                for (size_t plant = random_below(rng, 3); plant != 0 && count != 0; --plant) {
+                    code_units[random_below(rng, count)] = static_cast<char16_t>(0xD800 + random_below(rng, 0x800));
+                }
+                size_t expected = 0;
+                while (expected < count && (code_units[expected] < 0xD800 || code_units[expected] > 0xDFFF)) {
+                    ++expected;
+                }
+                unaligned_copy host(to_bytes(code_units), misalignment);
+                unaligned_copy reversed(to_swapped_bytes(code_units), misalignment);
+                UTF_CHECK(utf::surrogate_free_prefix_size(host.data(), count, false) == expected);
+                UTF_CHECK(utf::surrogate_free_prefix_size(reversed.data(), count, true) == expected);
+            }
+        }
+    }
+
+    void test_counting_kernels(random_engine& rng) {
+        std::vector<size_t> sizes(std::begin(boundary_sizes), std::end(boundary_sizes));
+        // byte-sized counters are flushed every 255 or 127 blocks
+        sizes.insert(sizes.end(), {127 * 16, 127 * 16 + 5, 255 * 16, 255 * 16 + 16, 255 * 16 * 2 + 33});
+        for (const size_t size : sizes) {
+            for (const size_t misalignment : misalignments) {
+                const std::vector<std::byte> bytes = random_bytes(rng, size);
+                unaligned_copy               input(bytes, misalignment);
+
+                size_t leading    = 0;
+                size_t four_bytes = 0;
+                size_t zeros[4]   = {};
+                for (size_t index = 0; index < size; ++index) {
+                    const uint8_t byte = static_cast<uint8_t>(bytes[index]);
+                    leading    += (byte & 0xC0) != 0x80 ? 1 : 0;
+                    four_bytes += byte >= 0xF0 ? 1 : 0;
+                    zeros[index % 4] += byte == 0 ? 1 : 0;
+                }
+                UTF_CHECK(utf::count_leading_bytes(input.data(), size) == leading);
+                UTF_CHECK(utf::count_utf16_code_units(input.data(), size) == leading + four_bytes);
+
+                // sparse zeros, like in UTF-16 and UTF-32 text
+                std::vector<std::byte> text = planted_bytes(rng, size, [](random_engine& r) { return random_below(r, 3) == 0 ? std::byte{0} : any_byte(r); }, any_byte);
+                unaligned_copy         text_copy(text, misalignment);
+                size_t                 text_zeros[4] = {};
+                for (size_t index = 0; index < size; ++index) {
+                    text_zeros[index % 4] += text[index] == std::byte{0} ? 1 : 0;
+                }
+                size_t counts[4];
+                utf::count_zero_bytes(input.data(), size, counts);
+                UTF_CHECK(std::equal(counts, counts + 4, zeros));
+                utf::count_zero_bytes(text_copy.data(), size, counts);
+                UTF_CHECK(std::equal(counts, counts + 4, text_zeros));
+            }
+        }
+    }
+
+    void test_skipping_kernels(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const size_t misalignment : misalignments) {
+                const std::vector<std::byte> bytes = random_bytes(rng, size);
+                unaligned_copy               input(bytes, misalignment);
+
+                // offsets of every character and of every UTF-16 code unit, by the kernels' counting rules
+                std::vector<size_t> characters;
+                std::vector<size_t> code_units;
+                for (size_t index = 0; index < size; ++index) {
+                    const uint8_t byte = static_cast<uint8_t>(bytes[index]);
+                    if ((byte & 0xC0) != 0x80) {
+                        characters.push_back(index);
+                        code_units.push_back(index);
+                        if (byte >= 0xF0) {
+                            code_units.push_back(index);
+                        }
+                    }
+                }
+                for (size_t count = 0; count <= characters.size() + 1; count += 1 + random_below(rng, 5)) {
+                    const size_t expected = count < characters.size() ? characters[count] : size;
+                    UTF_CHECK(utf::skip_code_points(input.data(), size, count) == expected);
+                }
+                for (size_t count = 0; count <= code_units.size() + 1; count += 1 + random_below(rng, 5)) {
+                    const size_t expected = count < code_units.size() ? code_units[count] : size;
+                    UTF_CHECK(utf::skip_utf16_code_units(input.data(), size, count) == expected);
+                }
+            }
+        }
+    }
+
+    template <typename CharT>
+    std::basic_string<CharT> ascii_units(random_engine& rng, const size_t count) {
+        std::basic_string<CharT> result(count, CharT(0));
+        for (CharT& code_unit : result) {
+            code_unit = static_cast<CharT>(random_below(rng, 0x80));
+        }
+        return result;
+    }
+
+    template <typename LeftCharT, typename RightCharT>
+    void test_equal_ascii_prefix_size(random_engine& rng) {
+        for (const size_t count : boundary_sizes) {
+            for (const size_t misalignment : misalignments) {
+                std::basic_string<LeftCharT>  left = ascii_units<LeftCharT>(rng, count);
+                std::basic_string<RightCharT> right(count, RightCharT(0));
+                for (size_t index = 0; index < count; ++index) {
+                    right[index] = static_cast<RightCharT>(left[index]);
+                }
+                // plant a difference or a non-ASCII unit on either side, possibly equal on both
+                if (count != 0 && random_below(rng, 4) != 0) {
+                    const size_t index = random_below(rng, count);
+                    switch (random_below(rng, 4)) {
+                        case 0:
+                            left[index] = static_cast<LeftCharT>(0x80 + random_below(rng, 0x7F));
+                            right[index] = static_cast<RightCharT>(left[index]);
+                            break;
+                        case 1:
+                            right[index] = static_cast<RightCharT>(sizeof(RightCharT) == 1 ? 0xC3 : 0x100 + random_below(rng, 0xD000));
+                            break;
+                        case 2:
+                            right[index] = static_cast<RightCharT>((right[index] + 1) & 0x7F);
+                            break;
+                        default:
+                            // same low byte, not ASCII
+                            left[index] = static_cast<LeftCharT>(sizeof(LeftCharT) == 1 ? left[index] : left[index] | 0x100);
+                            break;
+                    }
+                }
+                size_t expected = 0;
+                while (expected < count) {
+                    const auto left_value  = static_cast<std::make_unsigned_t<LeftCharT>>(left[expected]);
+                    const auto right_value = static_cast<std::make_unsigned_t<RightCharT>>(right[expected]);
+                    if (left_value >= 0x80 || left_value != right_value) {
+                        break;
+                    }
+                    ++expected;
+                }
+                unaligned_copy left_copy(to_bytes(left), misalignment);
+                unaligned_copy right_copy(to_bytes(right), misalignment + 3);
+                UTF_CHECK(utf::equal_ascii_prefix_size<LeftCharT, RightCharT>(left_copy.data(), right_copy.data(), count) == expected);
+            }
+        }
+    }
+
+    void test_find_short_needles(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const size_t misalignment : misalignments) {
+                // a small alphabet makes partial matches frequent
+                std::vector<std::byte> bytes(size);
+                for (std::byte& byte : bytes) {
+                    byte = static_cast<std::byte>(0x41 + random_below(rng, 4));
+                }
+                const size_t      count = 1 + random_below(rng, utf::max_short_needles);
+                utf::short_needle needles[utf::max_short_needles];
+                for (size_t needle = 0; needle < count; ++needle) {
+                    needles[needle].size = 1 + random_below(rng, 4);
+                    for (size_t byte = 0; byte < needles[needle].size; ++byte) {
+                        needles[needle].bytes[byte] = static_cast<std::byte>(0x41 + random_below(rng, 5));
+                    }
+                }
+                size_t expected = size;
+                for (size_t offset = 0; offset < size && expected == size; ++offset) {
+                    for (size_t needle = 0; needle < count; ++needle) {
+                        if (needles[needle].size <= size - offset && std::memcmp(bytes.data() + offset, needles[needle].bytes, needles[needle].size) == 0) {
+                            expected = offset;
+                            break;
+                        }
+                    }
+                }
+                unaligned_copy input(bytes, misalignment);
+                UTF_CHECK(utf::find_short_needles(input.data(), size, needles, count) == expected);
+            }
+        }
+    }
+
+    void test_find_code_units(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            for (const size_t misalignment : misalignments) {
+                for (const size_t unit_size : {size_t{1}, size_t{2}, size_t{4}}) {
+                    const size_t           units = size / unit_size;
+                    std::vector<std::byte> bytes(units * unit_size);
+                    for (std::byte& byte : bytes) {
+                        byte = static_cast<std::byte>(random_below(rng, 3));
+                    }
+                    std::vector<std::byte> needle((1 + random_below(rng, 4)) * unit_size);
+                    for (std::byte& byte : needle) {
+                        byte = static_cast<std::byte>(random_below(rng, 3));
+                    }
+                    // sometimes plant the needle at an unaligned offset only
+                    if (bytes.size() > needle.size() && random_below(rng, 2) == 0) {
+                        const size_t offset = random_below(rng, bytes.size() - needle.size());
+                        std::memcpy(bytes.data() + offset, needle.data(), needle.size());
+                    }
+                    size_t expected = bytes.size();
+                    for (size_t offset = 0; offset + needle.size() <= bytes.size(); offset += unit_size) {
+                        if (std::memcmp(bytes.data() + offset, needle.data(), needle.size()) == 0) {
+                            expected = offset;
+                            break;
+                        }
+                    }
+                    unaligned_copy input(bytes, misalignment);
+                    UTF_CHECK(utf::find_code_units(input.data(), bytes.size(), needle.data(), needle.size(), unit_size) == expected);
+                }
+            }
+        }
+    }
+
+    void test_bit_helpers(random_engine& rng) {
+        for (int round = 0; round < 1000; ++round) {
+            const uint64_t bits     = rng() | 1ull << random_below(rng, 64);
+            unsigned       set      = 0;
+            unsigned       trailing = 64;
+            for (unsigned bit = 0; bit < 64; ++bit) {
+                if ((bits >> bit & 1) != 0) {
+                    set     += bit < 32 ? 1 : 0;
+                    trailing = std::min(trailing, bit);
+                }
+            }
+            UTF_CHECK(utf::bit_count(static_cast<uint32_t>(bits)) == set);
+            UTF_CHECK(utf::trailing_zero_count(bits) == trailing);
+        }
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(33);
+    test_copy_swapped(rng);
+    test_prefix_kernels(rng);
+    test_surrogate_free_prefix_size(rng);
+    test_counting_kernels(rng);
+    test_skipping_kernels(rng);
+    test_equal_ascii_prefix_size<char8_t, char8_t>(rng);
+    test_equal_ascii_prefix_size<char8_t, char16_t>(rng);
+    test_equal_ascii_prefix_size<char16_t, char32_t>(rng);
+    test_equal_ascii_prefix_size<char32_t, char8_t>(rng);
+    test_equal_ascii_prefix_size<char32_t, char32_t>(rng);
+    test_find_short_needles(rng);
+    test_find_code_units(rng);
+    test_bit_helpers(rng);
+    return result();
+}
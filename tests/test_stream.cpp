@@ -0,0 +1,177 @@
+/**
+ * @file test_stream.cpp
+ * @brief Checks chunked and stepwise conversion against a single conversion of the whole input.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_stream.hpp"
+
+#include <cstdint>
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    struct converted {
+        status_e               status = status_e::success;
+        std::vector<std::byte> bytes;
+
+        bool operator==(const converted& other) const {
+            return status == other.status && bytes == other.bytes;
+        }
+    };
+
+    converted convert_whole(const std::vector<std::byte>& input, const utf::encoding_e from, const utf::encoding_e to, const utf::transcode_options& options) {
+        converted result;
+        result.status = utf::conversion::transcode_bytes(input.data(), input.size(), from, result.bytes, to, options.comply_with_standard, options.bom_policy);
+        return result;
+    }
+
+    /**
+     * @brief Feeds the input in random chunks, from memory which isn't aligned for the code unit type.
+     */
+    converted convert_chunked(random_engine& rng, const std::vector<std::byte>& input, const utf::encoding_e from, const utf::encoding_e to,
+                              const utf::transcode_options& options) {
+        unaligned_copy         copy(input, 1);
+        utf::stream_converter  converter(from, to, options);
+        converted              result;
+        std::vector<std::byte> chunk_output;
+        for (size_t offset = 0; offset < input.size();) {
+            const size_t chunk_size = std::min(input.size() - offset, random_below(rng, 4) == 0 ? random_below(rng, 300) : random_below(rng, 9));
+            result.status = converter.convert(copy.data() + offset, chunk_size, chunk_output);
+            if (result.status != status_e::success) {
+                UTF_CHECK(chunk_output.empty());
+                converter.reset();
+                result.bytes.clear();
+                return result;
+            }
+            result.bytes.insert(result.bytes.end(), chunk_output.begin(), chunk_output.end());
+            offset += chunk_size;
+        }
+        result.status = converter.finish(chunk_output);
+        if (result.status != status_e::success) {
+            UTF_CHECK(chunk_output.empty());
+            result.bytes.clear();
+            return result;
+        }
+        result.bytes.insert(result.bytes.end(), chunk_output.begin(), chunk_output.end());
+        return result;
+    }
+
+    /**
+     * @brief Runs a job with random budgets, taking the output now and then.
+     */
+    converted convert_stepwise(random_engine& rng, const std::vector<std::byte>& input, const utf::encoding_e from, const utf::encoding_e to,
+                               const utf::transcode_options& options) {
+        utf::conversion_job job(input.data(), input.size(), from, to, options);
+        converted           result;
+        size_t              steps = 0;
+        while (!job.done()) {
+            result.status = job.step(random_below(rng, 40));
+            UTF_CHECK(job.processed() <= job.size());
+            if (random_below(rng, 3) == 0) {
+                const std::vector<std::byte> taken = job.take_output();
+                result.bytes.insert(result.bytes.end(), taken.begin(), taken.end());
+            }
+            UTF_CHECK(++steps <= input.size() + 2);
+        }
+        UTF_CHECK(job.step(1) == result.status);
+        if (result.status != status_e::success) {
+            UTF_CHECK(job.output().empty());
+            result.bytes.clear();
+            return result;
+        }
+        UTF_CHECK(job.processed() == input.size());
+        result.bytes.insert(result.bytes.end(), job.output().begin(), job.output().end());
+        return result;
+    }
+
+    void check_same_as_whole(random_engine& rng, const std::vector<std::byte>& input, const utf::encoding_e from, const utf::encoding_e to,
+                             const utf::transcode_options& options) {
+        const converted expected = convert_whole(input, from, to, options);
+        UTF_CHECK(convert_chunked(rng, input, from, to, options) == expected);
+        UTF_CHECK(convert_stepwise(rng, input, from, to, options) == expected);
+    }
+
+    /**
+     * @brief Random text in every pair of encodings, also with a BOM, cut short, or ending with a lone high surrogate.
+     */
+    void check_encodings(random_engine& rng) {
+        for (const utf::encoding_e from : all_encodings) {
+            for (const utf::encoding_e to : all_encodings) {
+                for (const size_t size : {0, 1, 5, 200, 1500}) {
+                    std::u32string code_points = random_code_points(rng, size, text_mix_e::wide);
+                    if (random_below(rng, 2) == 0) {
+                        code_points.insert(code_points.begin(), U'\uFEFF');
+                    }
+                    std::vector<std::byte> input = to_encoding(code_points, from);
+                    utf::transcode_options options;
+                    options.comply_with_standard = random_below(rng, 2) == 0;
+                    options.bom_policy           = static_cast<utf::bom_e>(random_below(rng, 3));
+
+                    check_same_as_whole(rng, input, from, to, options);
+                    // a cut character or code unit
+                    if (!input.empty()) {
+                        check_same_as_whole(rng, std::vector<std::byte>(input.begin(), input.end() - 1), from, to, options);
+                    }
+                    // a lone high surrogate at the end
+                    if (from != utf::encoding_e::utf8 && from != utf::encoding_e::utf32 && from != utf::encoding_e::utf32_le && from != utf::encoding_e::utf32_be) {
+                        std::vector<std::byte> surrogate = to_encoding(U"\U0001F600", from);
+                        surrogate.resize(surrogate.size() / 2);
+                        input.insert(input.end(), surrogate.begin(), surrogate.end());
+                        options.comply_with_standard = false;
+                        check_same_as_whole(rng, input, from, to, options);
+                        options.comply_with_standard = true;
+                        check_same_as_whole(rng, input, from, to, options);
+                    }
+                }
+            }
+        }
+    }
+
+    void check_lone_surrogate() {
+        const std::u16string   text  = u"ab";
+        std::vector<std::byte> input = to_bytes(text + static_cast<char16_t>(0xD800));
+        const converted        whole = convert_whole(input, utf::encoding_e::utf16, utf::encoding_e::utf8, {});
+        UTF_CHECK(whole.status == status_e::success && whole.bytes.size() == 5);
+
+        utf::conversion_job job(input.data(), input.size(), utf::encoding_e::utf16, utf::encoding_e::utf8);
+        while (!job.done()) {
+            job.step(1);
+        }
+        UTF_CHECK(job.step(1) == status_e::success && job.output() == whole.bytes);
+    }
+
+    void check_budgets() {
+        // a budget which would overflow once turned into bytes still converts the rest in one step
+        const std::vector<std::byte> input = to_bytes(std::u16string(u"budget"));
+        utf::conversion_job          job(input.data(), input.size(), utf::encoding_e::utf16, utf::encoding_e::utf8);
+        UTF_CHECK(job.step(SIZE_MAX / 2 + 1) == status_e::success && job.done());
+        UTF_CHECK(job.output() == to_bytes(std::string("budget")));
+
+        std::vector<std::byte> wide = to_bytes(std::u32string(U"ab"));
+        wide.resize(wide.size() + 2);
+        utf::conversion_job huge(wide.data(), wide.size(), utf::encoding_e::utf32, utf::encoding_e::utf8);
+        UTF_CHECK(huge.step(SIZE_MAX) == status_e::character_cut_off && huge.done());
+
+        // a zero budget still makes progress, a trailing partial code unit goes with the last whole one
+        const std::vector<std::byte> odd(input.begin(), input.end() - 1);
+        utf::conversion_job          slow(odd.data(), odd.size(), utf::encoding_e::utf16, utf::encoding_e::utf8);
+        for (size_t step = 0; step < 4; ++step) {
+            UTF_CHECK(slow.step(0) == status_e::success && slow.processed() == 2 * (step + 1));
+        }
+        UTF_CHECK(slow.step(1) == status_e::character_cut_off && slow.done() && slow.output().empty());
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(50);
+    check_encodings(rng);
+    check_lone_surrogate();
+    check_budgets();
+    return result();
+}
@@ -0,0 +1,293 @@
+/**
+ * @file test_transcode.cpp
+ * @brief Checks the conversions which record something on the way (line starts, hashes) and decoding of the last characters.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_decode.hpp"
+#include "utf-utils/utf_hash.hpp"
+#include "utf-utils/utf_lines.hpp"
+
+#include <iterator>
+
+using namespace utf_test;
+using utf::conversion::status_e;
+
+namespace {
+    template <typename CharT>
+    size_t unit_count(const char32_t code_point) {
+        return encode<CharT>(std::u32string(1, code_point)).size();
+    }
+
+    /**
+     * @brief Calls the conversion recording line starts for the pair of code unit types.
+     */
+    template <typename InputCharT, typename OutputCharT, typename Sink>
+    status_e convert_lines(const std::basic_string_view<InputCharT>& input, Sink&& sink, utf::line_starts& lines, const utf::line_breaks_e line_breaks,
+                           const bool comply_with_standard, const utf::bom_e bom_policy) {
+        using namespace utf::conversion;
+        if constexpr (sizeof(InputCharT) == 1) {
+            if constexpr (sizeof(OutputCharT) == 2) {
+                return utf8_to_utf16(input, std::forward<Sink>(sink), lines, line_breaks, comply_with_standard, bom_policy);
+            }
+            else {
+                return utf8_to_utf32(input, std::forward<Sink>(sink), lines, line_breaks, comply_with_standard, bom_policy);
+            }
+        }
+        else if constexpr (sizeof(InputCharT) == 2) {
+            if constexpr (sizeof(OutputCharT) == 1) {
+                return utf16_to_utf8(input, std::forward<Sink>(sink), lines, line_breaks, comply_with_standard, bom_policy);
+            }
+            else {
+                return utf16_to_utf32(input, std::forward<Sink>(sink), lines, line_breaks, comply_with_standard, bom_policy);
+            }
+        }
+        else {
+            if constexpr (sizeof(OutputCharT) == 1) {
+                return utf32_to_utf8(input, std::forward<Sink>(sink), lines, line_breaks, comply_with_standard, bom_policy);
+            }
+            else {
+                return utf32_to_utf16(input, std::forward<Sink>(sink), lines, line_breaks, comply_with_standard, bom_policy);
+            }
+        }
+    }
+
+    /**
+     * @brief Calls the hashing conversion for the pair of code unit types.
+     */
+    template <typename InputCharT, typename OutputCharT, typename Sink, typename Hasher>
+    status_e convert_hashed(const std::basic_string_view<InputCharT>& input, Sink&& sink, Hasher& hasher, const bool comply_with_standard,
+                            const utf::bom_e bom_policy) {
+        using namespace utf::conversion;
+        if constexpr (sizeof(InputCharT) == 1) {
+            if constexpr (sizeof(OutputCharT) == 2) {
+                return utf8_to_utf16(input, std::forward<Sink>(sink), hasher, comply_with_standard, bom_policy);
+            }
+            else {
+                return utf8_to_utf32(input, std::forward<Sink>(sink), hasher, comply_with_standard, bom_policy);
+            }
+        }
+        else if constexpr (sizeof(InputCharT) == 2) {
+            if constexpr (sizeof(OutputCharT) == 1) {
+                return utf16_to_utf8(input, std::forward<Sink>(sink), hasher, comply_with_standard, bom_policy);
+            }
+            else {
+                return utf16_to_utf32(input, std::forward<Sink>(sink), hasher, comply_with_standard, bom_policy);
+            }
+        }
+        else {
+            if constexpr (sizeof(OutputCharT) == 1) {
+                return utf32_to_utf8(input, std::forward<Sink>(sink), hasher, comply_with_standard, bom_policy);
+            }
+            else {
+                return utf32_to_utf16(input, std::forward<Sink>(sink), hasher, comply_with_standard, bom_policy);
+            }
+        }
+    }
+
+    /**
+     * @brief Random lines joined by random line breaks, with the expected line starts in code points.
+     */
+    std::u32string random_lines(random_engine& rng, const size_t line_count, std::vector<size_t>& ascii_starts, std::vector<size_t>& unicode_starts) {
+        static constexpr const char32_t* breaks[] = {U"\n", U"\r\n", U"\r", U"\u2028", U"\u2029"};
+        std::u32string code_points;
+        ascii_starts.assign(1, 0);
+        unicode_starts.assign(1, 0);
+        for (size_t line = 0; line < line_count; ++line) {
+            for (const char32_t code_point : random_code_points(rng, random_below(rng, 40), text_mix_e::wide)) {
+                const bool is_break = code_point == U'\n' || code_point == U'\r' || code_point == U'\u2028' || code_point == U'\u2029';
+                code_points += is_break ? U' ' : code_point;
+            }
+            // CR and LF of two lines would make a single break
+            if (!code_points.empty() && code_points.back() == U'\r') {
+                code_points += U'x';
+            }
+            const std::u32string line_break = breaks[random_below(rng, 5)];
+            code_points += line_break;
+            if (line_break.size() != 1 || line_break[0] < 0x80) {
+                ascii_starts.push_back(code_points.size());
+            }
+            unicode_starts.push_back(code_points.size());
+        }
+        return code_points;
+    }
+
+    /**
+     * @brief Translates code point offsets into code unit offsets, shifted by a BOM; the first line starts at @c 0 anyway.
+     */
+    template <typename CharT>
+    std::vector<size_t> unit_offsets(const std::u32string& code_points, const std::vector<size_t>& starts, const size_t bom_units) {
+        std::vector<size_t> result;
+        for (const size_t start : starts) {
+            result.push_back(result.empty() ? 0 : bom_units + encode<CharT>(code_points.substr(0, start)).size());
+        }
+        return result;
+    }
+
+    template <typename InputCharT, typename OutputCharT>
+    void check_lines(random_engine& rng) {
+        for (const size_t line_count : {0, 1, 3, 100}) {
+            std::vector<size_t>  ascii_starts;
+            std::vector<size_t>  unicode_starts;
+            const std::u32string code_points = random_lines(rng, line_count, ascii_starts, unicode_starts);
+            const std::u32string with_bom    = U"\uFEFF" + code_points;
+
+            const std::basic_string<InputCharT> plain = encode<InputCharT>(code_points);
+            const std::basic_string<InputCharT> bom   = encode<InputCharT>(with_bom);
+            const size_t                        input_bom  = unit_count<InputCharT>(U'\uFEFF');
+            const size_t                        output_bom = unit_count<OutputCharT>(U'\uFEFF');
+
+            struct variant {
+                const std::basic_string<InputCharT>* input;
+                utf::bom_e                           bom_policy;
+                size_t                               input_bom;
+                size_t                               output_bom;
+            };
+            const variant variants[] = {{&plain, utf::bom_e::keep, 0, 0},
+                                        {&bom, utf::bom_e::keep, input_bom, output_bom},
+                                        {&bom, utf::bom_e::strip, input_bom, 0},
+                                        {&plain, utf::bom_e::add, 0, output_bom}};
+            for (const variant& current : variants) {
+                for (const utf::line_breaks_e line_breaks : {utf::line_breaks_e::ascii, utf::line_breaks_e::unicode}) {
+                    const std::vector<size_t>&          starts   = line_breaks == utf::line_breaks_e::ascii ? ascii_starts : unicode_starts;
+                    const std::basic_string<OutputCharT> expected = (current.output_bom != 0 ? encode<OutputCharT>(U"\uFEFF") : std::basic_string<OutputCharT>()) +
+                                                                    encode<OutputCharT>(code_points);
+                    const std::basic_string_view<InputCharT> input(*current.input);
+
+                    // container
+                    utf::line_starts               lines;
+                    std::basic_string<OutputCharT> output;
+                    UTF_CHECK(convert_lines<InputCharT, OutputCharT>(input, output, lines, line_breaks, false, current.bom_policy) == status_e::success);
+                    UTF_CHECK(output == expected);
+                    UTF_CHECK(lines.input == unit_offsets<InputCharT>(code_points, starts, current.input_bom));
+                    UTF_CHECK(lines.output == unit_offsets<OutputCharT>(code_points, starts, current.output_bom));
+
+                    // raw pointer, nothing written past the converted string
+                    std::vector<OutputCharT> buffer(expected.size() + 1, static_cast<OutputCharT>(0x55));
+                    utf::line_starts         pointer_lines;
+                    UTF_CHECK(convert_lines<InputCharT, OutputCharT>(input, buffer.data(), pointer_lines, line_breaks, false, current.bom_policy) == status_e::success);
+                    UTF_CHECK(std::basic_string<OutputCharT>(buffer.data(), expected.size()) == expected && buffer.back() == 0x55);
+                    UTF_CHECK(pointer_lines.input == lines.input && pointer_lines.output == lines.output);
+
+                    // output iterator
+                    std::basic_string<OutputCharT> appended;
+                    utf::line_starts               iterator_lines;
+                    UTF_CHECK(convert_lines<InputCharT, OutputCharT>(input, std::back_inserter(appended), iterator_lines, line_breaks, false, current.bom_policy) ==
+                              status_e::success);
+                    UTF_CHECK(appended == expected && iterator_lines.output == lines.output);
+                }
+            }
+        }
+
+        // failures clear the lines along with a container
+        if constexpr (sizeof(InputCharT) != 2) {
+            std::basic_string<InputCharT> invalid = encode<InputCharT>(U"a\nb");
+            invalid += static_cast<InputCharT>(sizeof(InputCharT) == 1 ? 0xFF : 0x110000);
+            utf::line_starts               lines;
+            std::basic_string<OutputCharT> output = encode<OutputCharT>(U"old");
+            UTF_CHECK(convert_lines<InputCharT, OutputCharT>(std::basic_string_view<InputCharT>(invalid), output, lines, utf::line_breaks_e::ascii, false,
+                                                             utf::bom_e::keep) != status_e::success);
+            UTF_CHECK(output.empty() && lines.input.empty() && lines.output.empty());
+        }
+    }
+
+    /**
+     * @brief Hasher which records every block it's fed.
+     */
+    template <typename CharT>
+    struct recording_hasher {
+        std::basic_string<CharT> fed;
+        size_t                   calls = 0;
+
+        void operator()(const CharT* data, const size_t size) {
+            fed.append(data, size);
+            ++calls;
+        }
+    };
+
+    template <typename InputCharT, typename OutputCharT>
+    void check_hashed(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string                code_points = random_code_points(rng, size, text_mix_e::wide);
+            const std::basic_string<InputCharT> input       = encode<InputCharT>(code_points);
+            for (const utf::bom_e bom_policy : {utf::bom_e::keep, utf::bom_e::add}) {
+                const std::basic_string<OutputCharT> expected =
+                    (bom_policy == utf::bom_e::add ? encode<OutputCharT>(U"\uFEFF") : std::basic_string<OutputCharT>()) + encode<OutputCharT>(code_points);
+
+                recording_hasher<OutputCharT>  hasher;
+                std::basic_string<OutputCharT> output;
+                UTF_CHECK(convert_hashed<InputCharT, OutputCharT>(std::basic_string_view<InputCharT>(input), output, hasher, false, bom_policy) == status_e::success);
+                UTF_CHECK(output == expected && hasher.fed == expected);
+
+                std::vector<OutputCharT>      buffer(expected.size() + 1, static_cast<OutputCharT>(0x55));
+                recording_hasher<OutputCharT> pointer_hasher;
+                UTF_CHECK(convert_hashed<InputCharT, OutputCharT>(std::basic_string_view<InputCharT>(input), buffer.data(), pointer_hasher, false, bom_policy) ==
+                          status_e::success);
+                UTF_CHECK(std::basic_string<OutputCharT>(buffer.data(), expected.size()) == expected && buffer.back() == 0x55 && pointer_hasher.fed == expected);
+
+                // the hash doesn't depend on the sink
+                utf::fnv1a_64                  container_hash;
+                utf::fnv1a_64                  iterator_hash;
+                std::basic_string<OutputCharT> appended;
+                UTF_CHECK(convert_hashed<InputCharT, OutputCharT>(std::basic_string_view<InputCharT>(input), output, container_hash, false, bom_policy) == status_e::success);
+                UTF_CHECK(convert_hashed<InputCharT, OutputCharT>(std::basic_string_view<InputCharT>(input), std::back_inserter(appended), iterator_hash, false,
+                                                                  bom_policy) == status_e::success);
+                UTF_CHECK(appended == expected && container_hash.value == iterator_hash.value);
+            }
+        }
+
+        // invalid input isn't hashed
+        std::basic_string<InputCharT> invalid = encode<InputCharT>(U"ab");
+        invalid += static_cast<InputCharT>(sizeof(InputCharT) == 1 ? 0xFF : sizeof(InputCharT) == 2 ? 0xDC00 : 0x110000);
+        recording_hasher<OutputCharT>  hasher;
+        std::basic_string<OutputCharT> output = encode<OutputCharT>(U"old");
+        UTF_CHECK(convert_hashed<InputCharT, OutputCharT>(std::basic_string_view<InputCharT>(invalid), output, hasher, true, utf::bom_e::keep) != status_e::success);
+        UTF_CHECK(output.empty() && hasher.calls == 0);
+    }
+
+    template <typename CharT>
+    void check_decode_last_n(random_engine& rng) {
+        for (const size_t size : {0, 1, 2, 5, 64, 1000}) {
+            const std::u32string           code_points = random_code_points(rng, size, text_mix_e::wide);
+            const std::basic_string<CharT> text        = encode<CharT>(code_points);
+            const std::basic_string_view<CharT> sv(text);
+            for (const size_t count : {size_t(0), size_t(1), size_t(3), size / 2, size, size + 5}) {
+                const std::u32string expected = code_points.substr(code_points.size() - std::min(count, code_points.size()));
+
+                std::u32string container = U"old";
+                UTF_CHECK(utf::decode_last_n(sv, count, container) == expected.size() && container == expected);
+
+                std::vector<char32_t> buffer(expected.size() + 1, U'\x55');
+                UTF_CHECK(utf::decode_last_n(sv, count, buffer.data()) == expected.size());
+                UTF_CHECK(std::u32string(buffer.data(), expected.size()) == expected && buffer.back() == U'\x55');
+
+                std::u32string appended;
+                UTF_CHECK(utf::decode_last_n(sv, count, std::back_inserter(appended)) == expected.size() && appended == expected);
+            }
+        }
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(43);
+    check_lines<char8_t, char16_t>(rng);
+    check_lines<char8_t, char32_t>(rng);
+    check_lines<char16_t, char8_t>(rng);
+    check_lines<char16_t, char32_t>(rng);
+    check_lines<char32_t, char8_t>(rng);
+    check_lines<char32_t, char16_t>(rng);
+    check_hashed<char8_t, char16_t>(rng);
+    check_hashed<char8_t, char32_t>(rng);
+    check_hashed<char16_t, char8_t>(rng);
+    check_hashed<char16_t, char32_t>(rng);
+    check_hashed<char32_t, char8_t>(rng);
+    check_hashed<char32_t, char16_t>(rng);
+    check_decode_last_n<char8_t>(rng);
+    check_decode_last_n<char16_t>(rng);
+    check_decode_last_n<char32_t>(rng);
+    return result();
+}
@@ -0,0 +1,108 @@
+/**
+ * @file test_truncate.cpp
+ * @brief Checks truncation at every size and code point cap against the character boundaries of the text.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_truncate.hpp"
+
+using namespace utf_test;
+
+namespace {
+    /**
+     * @brief Longest prefix of whole characters within both limits, counted character by character.
+     */
+    template <typename CharT>
+    size_t expected_size(const std::u32string& code_points, const size_t max_units, const size_t max_code_points) {
+        size_t size = 0;
+        for (size_t index = 0; index < code_points.size() && index < max_code_points; ++index) {
+            const size_t units = encode<CharT>(code_points.substr(index, 1)).size();
+            if (size + units > max_units) {
+                break;
+            }
+            size += units;
+        }
+        return size;
+    }
+
+    template <typename CharT>
+    std::basic_string_view<CharT> truncate(const std::basic_string<CharT>& text, const size_t max_units, const size_t max_code_points) {
+        if constexpr (sizeof(CharT) == 1) {
+            return utf::truncate_utf8(std::basic_string_view<CharT>(text), max_units, max_code_points);
+        }
+        else {
+            return utf::truncate_utf16(std::basic_string_view<CharT>(text), max_units, max_code_points);
+        }
+    }
+
+    /**
+     * @brief Cuts at every size, inside characters of every length and surrogate pairs too, with and without a code point cap.
+     */
+    template <typename CharT>
+    void test_truncate(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string           code_points = random_code_points(rng, size, random_below(rng, 2) == 0 ? text_mix_e::mixed : text_mix_e::wide);
+            const std::basic_string<CharT> text        = encode<CharT>(code_points);
+            for (size_t max_units = 0; max_units <= text.size() + 1; max_units += size > 300 ? 1 + random_below(rng, 24) : 1) {
+                const size_t max_code_points = random_below(rng, 3) == 0 ? std::basic_string_view<CharT>::npos : random_below(rng, size + 2);
+                const std::basic_string_view<CharT> kept = truncate(text, max_units, max_code_points);
+                UTF_CHECK(kept.data() == text.data());
+                UTF_CHECK(kept.size() == expected_size<CharT>(code_points, max_units, max_code_points));
+            }
+        }
+    }
+
+    void test_cuts() {
+        // cuts inside two, three and four byte sequences move back to their leading byte
+        const std::basic_string<char8_t> utf8 = to_utf8(U"a\u00E9\u20AC\U0001F600");
+        const size_t expected[] = {0, 1, 1, 3, 3, 3, 6, 6, 6, 6, 10, 10};
+        for (size_t max_bytes = 0; max_bytes < 12; ++max_bytes) {
+            UTF_CHECK(utf::truncate_utf8(utf8, max_bytes).size() == expected[max_bytes]);
+        }
+        UTF_CHECK(utf::truncate_utf8(utf8, 100, 2).size() == 3);
+        UTF_CHECK(utf::truncate_utf8(utf8, 5, 3).size() == 3);
+
+        // a surrogate pair isn't split, an unpaired surrogate is a character of its own
+        const std::u16string utf16 = std::u16string(u"a\U0001F600") + static_cast<char16_t>(0xDC00) + u"b";
+        UTF_CHECK(utf::truncate_utf16(utf16, 2).size() == 1);
+        UTF_CHECK(utf::truncate_utf16(utf16, 3).size() == 3);
+        UTF_CHECK(utf::truncate_utf16(utf16, 100, 2).size() == 3);
+        UTF_CHECK(utf::truncate_utf16(utf16, 100, 3).size() == 4);
+
+        // a BOM gives the byte order and counts like a character
+        std::u16string swapped_text = u"\uFEFFx\U0001F600y";
+        for (char16_t& code_unit : swapped_text) {
+            code_unit = swapped(code_unit);
+        }
+        UTF_CHECK(utf::truncate_utf16(swapped_text, 3).size() == 2);
+        UTF_CHECK(utf::truncate_utf16(swapped_text, 100, 3).size() == 4);
+        const std::basic_string<char8_t> utf8_bom = to_utf8(U"\uFEFF\u00E9");
+        UTF_CHECK(utf::truncate_utf8(utf8_bom, 4).size() == 3);
+        UTF_CHECK(utf::truncate_utf8(utf8_bom, 5, 1).size() == 3);
+    }
+
+    void test_columns() {
+        const std::vector<std::basic_string<char8_t>> utf8_column = {to_utf8(U"short"), to_utf8(U"\u00E9\u00E9\u00E9"), {}};
+        std::vector<std::basic_string_view<char8_t>>  utf8_kept;
+        utf::truncate_utf8(utf8_column.begin(), utf8_column.end(), std::back_inserter(utf8_kept), 5, 4);
+        UTF_CHECK(utf8_kept.size() == 3 && utf8_kept[0] == to_utf8(U"shor") && utf8_kept[1] == to_utf8(U"\u00E9\u00E9") && utf8_kept[2].empty());
+
+        const std::vector<std::u16string>      utf16_column = {u"ab\U0001F600", u"abcdef"};
+        std::vector<std::u16string_view>       utf16_kept(2);
+        UTF_CHECK(utf::truncate_utf16(utf16_column.begin(), utf16_column.end(), utf16_kept.begin(), 3) == utf16_kept.end());
+        UTF_CHECK(utf16_kept[0] == u"ab" && utf16_kept[1] == u"abc");
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(48);
+    test_truncate<char8_t>(rng);
+    test_truncate<char16_t>(rng);
+    test_cuts();
+    test_columns();
+    return result();
+}
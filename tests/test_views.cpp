@@ -0,0 +1,115 @@
+/**
+ * @file test_views.cpp
+ * @brief Checks the lazy transcoding views in both directions and inside ranges pipelines.
+ */
+
+#include "test_common.hpp"
+
+#include "utf-utils/utf_views.hpp"
+
+#include <forward_list>
+
+using namespace utf_test;
+
+namespace {
+    template <typename Range>
+    std::u32string collect32(Range&& range) {
+        std::u32string result;
+        for (const char32_t code_point : range) {
+            result += code_point;
+        }
+        return result;
+    }
+
+    template <typename CharT, typename Range>
+    std::basic_string<CharT> collect(Range&& range) {
+        std::basic_string<CharT> result;
+        for (const CharT code_unit : range) {
+            result += code_unit;
+        }
+        return result;
+    }
+
+    std::u32string reversed(std::u32string code_points) {
+        std::reverse(code_points.begin(), code_points.end());
+        return code_points;
+    }
+
+    template <typename CharT>
+    void test_decode(random_engine& rng) {
+        for (const size_t size : boundary_sizes) {
+            const std::u32string           code_points = random_code_points(rng, size, text_mix_e::wide);
+            const std::basic_string<CharT> text        = encode<CharT>(code_points);
+
+            auto decoded = text | utf::views::as_utf32;
+            static_assert(std::ranges::bidirectional_range<decltype(decoded)>);
+            static_assert(std::ranges::common_range<decltype(decoded)>);
+            UTF_CHECK(collect32(decoded) == code_points);
+            UTF_CHECK(collect32(decoded | std::views::reverse) == reversed(code_points));
+
+            // only the characters taken are decoded
+            const size_t count = random_below(rng, size + 2);
+            UTF_CHECK(collect32(decoded | std::views::take(count)) == code_points.substr(0, count));
+
+            // every encoding to every other one
+            UTF_CHECK(collect<char8_t>(text | utf::views::as_utf8) == to_utf8(code_points));
+            UTF_CHECK(collect<char16_t>(text | utf::views::as_utf16) == to_utf16(code_points));
+            UTF_CHECK(collect<char16_t>(text | utf::views::as_utf16 | std::views::reverse) == collect<char16_t>(to_utf16(code_points) | std::views::reverse));
+            UTF_CHECK(collect<char8_t>(text | utf::views::as_utf8 | std::views::reverse) == collect<char8_t>(to_utf8(code_points) | std::views::reverse));
+        }
+    }
+
+    void test_typed_adaptors() {
+        const std::basic_string<char8_t> utf8  = to_utf8(U"a\u00E9\U0001F600");
+        const std::u16string             utf16 = u"a\u00E9\U0001F600";
+        const std::u32string             utf32 = U"a\u00E9\U0001F600";
+        UTF_CHECK(collect32(utf8 | utf::views::decode_utf8) == utf32);
+        UTF_CHECK(collect32(utf16 | utf::views::decode_utf16) == utf32);
+        UTF_CHECK(collect32(utf32 | utf::views::decode_utf32) == utf32);
+        UTF_CHECK(collect<char8_t>(utf32 | utf::views::encode_utf8) == utf8);
+        UTF_CHECK(collect<char16_t>(utf32 | utf::views::encode_utf16) == utf16);
+        UTF_CHECK(collect<char32_t>(utf32 | utf::views::encode_utf32) == utf32);
+        static_assert(!std::invocable<decltype(utf::views::decode_utf16), const std::basic_string<char8_t>&>);
+
+        // encoding follows the underlying range: forward only over a forward list
+        const std::forward_list<char32_t> list(utf32.begin(), utf32.end());
+        auto                              encoded = list | utf::views::encode_utf16;
+        static_assert(std::ranges::forward_range<decltype(encoded)> && !std::ranges::bidirectional_range<decltype(encoded)>);
+        UTF_CHECK(collect<char16_t>(encoded) == utf16);
+        static_assert(std::ranges::bidirectional_range<decltype(utf32 | utf::views::encode_utf8)>);
+    }
+
+    void test_invalid_and_swapped() {
+        // every code unit which can't be decoded is U+FFFD, in both directions
+        std::basic_string<char8_t> utf8 = to_utf8(U"a\u00E9");
+        utf8.insert(utf8.begin() + 1, static_cast<char8_t>(0x80));
+        utf8 += static_cast<char8_t>(0xE2);
+        const std::u32string expected = U"a\uFFFD\u00E9\uFFFD";
+        UTF_CHECK(collect32(utf8 | utf::views::as_utf32) == expected);
+        UTF_CHECK(collect32(utf8 | utf::views::as_utf32 | std::views::reverse) == reversed(expected));
+
+        // code points which can't be encoded become U+FFFD too
+        const std::u32string out_of_range = {U'a', 0x110000};
+        UTF_CHECK(collect<char16_t>(out_of_range | utf::views::encode_utf16) == u"a\uFFFD");
+
+        // a swapped BOM gives the byte order
+        std::u16string swapped_text = u"\uFEFFx\U0001F600";
+        for (char16_t& code_unit : swapped_text) {
+            code_unit = swapped(code_unit);
+        }
+        UTF_CHECK(collect32(swapped_text | utf::views::as_utf32) == U"\uFEFFx\U0001F600");
+    }
+} // namespace
+
+int main() {
+    if (const int code = unsupported_cpu()) {
+        return code;
+    }
+    random_engine rng(27);
+    test_decode<char8_t>(rng);
+    test_decode<char16_t>(rng);
+    test_decode<char32_t>(rng);
+    test_typed_adaptors();
+    test_invalid_and_swapped();
+    return result();
+}
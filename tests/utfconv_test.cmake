@@ -0,0 +1,82 @@
+# Runs utfconv the way batch jobs do and checks its output files and exit codes.
+# cmake -DUTFCONV=<path to utfconv> -DWORK_DIR=<scratch directory> -P utfconv_test.cmake
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+
+# utfconv_run(<expected exit code> [INPUT_FILE <file>] [OUTPUT_FILE <file>] ARGS <arguments>...)
+function(utfconv_run expected)
+    cmake_parse_arguments(PARSE_ARGV 1 RUN "" "INPUT_FILE;OUTPUT_FILE" "ARGS")
+    set(redirections)
+    if (RUN_INPUT_FILE)
+        list(APPEND redirections INPUT_FILE ${RUN_INPUT_FILE})
+    endif()
+    if (RUN_OUTPUT_FILE)
+        list(APPEND redirections OUTPUT_FILE ${RUN_OUTPUT_FILE})
+    else()
+        list(APPEND redirections OUTPUT_QUIET)
+    endif()
+    execute_process(COMMAND ${UTFCONV} ${RUN_ARGS} ${redirections} ERROR_VARIABLE error RESULT_VARIABLE code)
+    if (NOT code EQUAL expected)
+        message(SEND_ERROR "utfconv ${RUN_ARGS}: exit code ${code} instead of ${expected}: ${error}")
+    endif()
+endfunction()
+
+function(utfconv_check_same_files first second)
+    file(SHA256 ${first} first_hash)
+    file(SHA256 ${second} second_hash)
+    if (NOT first_hash STREQUAL second_hash)
+        message(SEND_ERROR "${first} and ${second} differ")
+    endif()
+endfunction()
+
+# every part of four threads is larger than parallel_min_chunk_size code units, even in UTF-32
+string(REPEAT "aé€😀\n" 60000 text)
+set(original ${WORK_DIR}/original.txt)
+file(WRITE ${original} "${text}")
+
+# file to file through memory mappings, in both byte orders
+utfconv_run(0 ARGS -f UTF-8 -t UTF-16LE -j 4 -o ${WORK_DIR}/utf16le.txt ${original})
+utfconv_run(0 ARGS -f UTF-16LE -t UTF-32BE -j 4 -o ${WORK_DIR}/utf32be.txt ${WORK_DIR}/utf16le.txt)
+utfconv_run(0 ARGS --from=utf32be --to=utf8 --threads=4 -o ${WORK_DIR}/round_trip.txt ${WORK_DIR}/utf32be.txt)
+utfconv_check_same_files(${original} ${WORK_DIR}/round_trip.txt)
+
+# pipes are streamed through a buffer which cuts characters
+utfconv_run(0 INPUT_FILE ${original} OUTPUT_FILE ${WORK_DIR}/streamed.txt ARGS -f UTF-8 -t UTF-16BE -b 17 -j 4)
+utfconv_run(0 INPUT_FILE ${WORK_DIR}/streamed.txt OUTPUT_FILE ${WORK_DIR}/round_trip.txt ARGS -f UTF-16BE -t UTF-8 -b 1K)
+utfconv_check_same_files(${original} ${WORK_DIR}/round_trip.txt)
+
+# a BOM added by one conversion is stripped by the next
+utfconv_run(0 ARGS -f UTF-8 -t UTF-16 --bom add -o ${WORK_DIR}/bom.txt ${original})
+utfconv_run(0 ARGS -f UTF-16 -t UTF-8 --bom strip -j 4 -o ${WORK_DIR}/round_trip.txt ${WORK_DIR}/bom.txt)
+utfconv_check_same_files(${original} ${WORK_DIR}/round_trip.txt)
+
+# invalid input: the target file isn't touched, a streamed one is removed
+set(previous_file ${WORK_DIR}/previous.txt)
+file(WRITE ${previous_file} "previous")
+file(WRITE ${WORK_DIR}/odd.txt "abc")
+file(WRITE ${WORK_DIR}/too_large.txt "abcd")
+file(WRITE ${WORK_DIR}/output.txt "previous")
+utfconv_run(1 ARGS -f UTF-16LE -t UTF-8 -o ${WORK_DIR}/output.txt ${WORK_DIR}/odd.txt)
+utfconv_run(1 ARGS -f UTF-32LE -t UTF-8 -j 4 -o ${WORK_DIR}/output.txt ${WORK_DIR}/too_large.txt)
+utfconv_check_same_files(${previous_file} ${WORK_DIR}/output.txt)
+utfconv_run(1 INPUT_FILE ${WORK_DIR}/too_large.txt ARGS -f UTF-32LE -t UTF-8 -o ${WORK_DIR}/streamed_output.txt)
+if (EXISTS ${WORK_DIR}/streamed_output.txt)
+    message(SEND_ERROR "the output of a failed streamed conversion wasn't removed")
+endif()
+utfconv_run(1 ARGS -f UTF-8 -t UTF-16 -o ${WORK_DIR}/output.txt ${WORK_DIR}/missing.txt)
+
+# converting a file into itself is refused before it's truncated
+utfconv_run(1 ARGS -f UTF-8 -t UTF-16 -o ${previous_file} ${previous_file})
+utfconv_run(1 ARGS -f UTF-8 -t UTF-16 -o ${WORK_DIR}/./previous.txt ${previous_file})
+file(READ ${previous_file} previous_content)
+if (NOT previous_content STREQUAL "previous")
+    message(SEND_ERROR "converting a file into itself changed it")
+endif()
+
+# usage errors
+utfconv_run(0 ARGS --help)
+utfconv_run(2 ARGS -f UTF-8 ${original})
+utfconv_run(2 ARGS -f UTF-7 -t UTF-8 ${original})
+utfconv_run(2 ARGS -f UTF-8 -t UTF-16 -j many ${original})
+utfconv_run(2 ARGS -f UTF-8 -t UTF-16 ${original} ${previous_file})
@@ -0,0 +1,305 @@
+/**
+ * @file utfconv.cpp
+ * @brief Command-line tool converting between Unicode encodings.
+ * @details
+ * Files are converted through memory mappings, pipes are streamed through a buffer. Both paths use the two-pass kernels
+ * and split large inputs between threads if asked to.
+ */
+
+#include <utf-utils/utf_file.hpp>
+#include <utf-utils/utf_stream.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#   include <fcntl.h>
+#   include <io.h>
+#endif
+
+namespace {
+    struct arguments {
+        utf::encoding_e         from        = utf::encoding_e::utf8;
+        utf::encoding_e         to          = utf::encoding_e::utf8;
+        bool                    has_from    = false;
+        bool                    has_to      = false;
+        size_t                  buffer_size = 1 << 20;
+        utf::transcode_options  options;
+        std::string             input       = "-";
+        std::string             output      = "-";
+    };
+
+    void print_usage(std::FILE* stream) {
+        std::fprintf(stream, "usage: utfconv -f <encoding> -t <encoding> [options] [input]\n"
+                             "Converts the input file (standard input if omitted or '-') between Unicode encodings.\n"
+                             "\n"
+                             "options:\n"
+                             "  -f, --from <encoding>     source encoding\n"
+                             "  -t, --to <encoding>       target encoding\n"
+                             "  -o, --output <file>       write to the file instead of standard output\n"
+                             "  -s, --strict              reject surrogates and other non-standard sequences\n"
+                             "      --bom keep|strip|add  what to do with the byte order mark (default: keep)\n"
+                             "  -j, --threads <count>     threads for large inputs, 0 for all hardware threads (default: 1)\n"
+                             "  -b, --buffer-size <size>  bytes read at once from a pipe, K and M suffixes allowed (default: 1M)\n"
+                             "  -h, --help                print this message\n"
+                             "\n"
+                             "encodings: UTF-8, UTF-16LE, UTF-16BE, UTF-32LE, UTF-32BE,\n"
+                             "           UTF-16 and UTF-32 (byte order of the BOM, host byte order without one)\n");
+    }
+
+    bool parse_encoding(const std::string_view name, utf::encoding_e& encoding) {
+        // case-insensitive, dashes and underscores are optional
+        std::string normalized;
+        for (const char ch : name) {
+            if (ch != '-' && ch != '_') {
+                normalized += (ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - 'a' + 'A') : ch;
+            }
+        }
+        const std::pair<std::string_view, utf::encoding_e> encodings[] = {
+            {"UTF8",    utf::encoding_e::utf8},
+            {"UTF16",   utf::encoding_e::utf16},
+            {"UTF16LE", utf::encoding_e::utf16_le},
+            {"UTF16BE", utf::encoding_e::utf16_be},
+            {"UTF32",   utf::encoding_e::utf32},
+            {"UTF32LE", utf::encoding_e::utf32_le},
+            {"UTF32BE", utf::encoding_e::utf32_be}
+        };
+        for (const auto& [encoding_name, value] : encodings) {
+            if (normalized == encoding_name) {
+                encoding = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parse_size(const std::string_view text, size_t& size) {
+        if (text.empty()) {
+            return false;
+        }
+        size_t multiplier = 1;
+        std::string_view digits = text;
+        if (digits.back() == 'K' || digits.back() == 'k') {
+            multiplier = 1 << 10;
+            digits.remove_suffix(1);
+        } else if (digits.back() == 'M' || digits.back() == 'm') {
+            multiplier = 1 << 20;
+            digits.remove_suffix(1);
+        }
+        if (digits.empty()) {
+            return false;
+        }
+        size_t value = 0;
+        for (const char ch : digits) {
+            if (ch < '0' || ch > '9' || value > (SIZE_MAX - 9) / 10) {
+                return false;
+            }
+            value = value * 10 + static_cast<size_t>(ch - '0');
+        }
+        if (value > SIZE_MAX / multiplier) {
+            return false;
+        }
+        size = value * multiplier;
+        return true;
+    }
+
+    bool parse_arguments(const int argc, char** argv, arguments& result) {
+        bool has_input = false;
+        for (int index = 1; index < argc; ++index) {
+            std::string_view argument = argv[index];
+            std::string_view value;
+            bool             has_value = false;
+            // --option=value
+            if (argument.size() > 2 && argument.substr(0, 2) == "--" && argument.find('=') != std::string_view::npos) {
+                value     = argument.substr(argument.find('=') + 1);
+                argument  = argument.substr(0, argument.find('='));
+                has_value = true;
+            }
+            auto take_value = [&]() {
+                if (!has_value && index + 1 < argc) {
+                    value     = argv[++index];
+                    has_value = true;
+                }
+                return has_value;
+            };
+
+            if (argument == "-h" || argument == "--help") {
+                print_usage(stdout);
+                std::exit(0);
+            } else if (argument == "-f" || argument == "--from") {
+                if (!take_value() || !parse_encoding(value, result.from)) {
+                    return false;
+                }
+                result.has_from = true;
+            } else if (argument == "-t" || argument == "--to") {
+                if (!take_value() || !parse_encoding(value, result.to)) {
+                    return false;
+                }
+                result.has_to = true;
+            } else if (argument == "-o" || argument == "--output") {
+                if (!take_value()) {
+                    return false;
+                }
+                result.output = std::string(value);
+            } else if (argument == "-s" || argument == "--strict") {
+                result.options.comply_with_standard = true;
+            } else if (argument == "--bom") {
+                if (!take_value()) {
+                    return false;
+                }
+                if (value == "keep") {
+                    result.options.bom_policy = utf::bom_e::keep;
+                } else if (value == "strip") {
+                    result.options.bom_policy = utf::bom_e::strip;
+                } else if (value == "add") {
+                    result.options.bom_policy = utf::bom_e::add;
+                } else {
+                    return false;
+                }
+            } else if (argument == "-j" || argument == "--threads") {
+                size_t thread_count = 0;
+                if (!take_value() || !parse_size(value, thread_count) || thread_count > 1024) {
+                    return false;
+                }
+                result.options.thread_count = static_cast<unsigned>(thread_count);
+            } else if (argument == "-b" || argument == "--buffer-size") {
+                if (!take_value() || !parse_size(value, result.buffer_size) || result.buffer_size < 16) {
+                    return false;
+                }
+            } else if (argument.size() > 1 && argument[0] == '-') {
+                return false;
+            } else if (!has_input) {
+                result.input = std::string(argument);
+                has_input    = true;
+            } else {
+                return false;
+            }
+        }
+        return result.has_from && result.has_to;
+    }
+
+    const char* describe(const utf::conversion::status_e status) {
+        switch (status) {
+            case utf::conversion::status_e::unrepresentable_character:
+                return "character can't be represented in the target encoding";
+            case utf::conversion::status_e::trailing_without_leading:
+                return "trailing code unit without a leading one";
+            case utf::conversion::status_e::character_cut_off:
+                return "character is cut off";
+            case utf::conversion::status_e::non_standard_encoding:
+                return "encoding is not standard-compliant";
+            case utf::conversion::status_e::undefined_error:
+                return "invalid input";
+            case utf::conversion::status_e::success:
+                return "success";
+        }
+        return "unknown error";
+    }
+
+    /**
+     * @brief Streams the input through a buffer, used for pipes.
+     * @return Exit code.
+     */
+    int convert_stream(const arguments& args, std::FILE* input, std::FILE* output) {
+        utf::stream_converter  converter(args.from, args.to, args.options);
+        std::vector<std::byte> buffer(args.buffer_size);
+        std::vector<std::byte> converted;
+        auto write = [&]() {
+            if (!converted.empty() && std::fwrite(converted.data(), 1, converted.size(), output) != converted.size()) {
+                std::fprintf(stderr, "utfconv: %s: %s\n", args.output.c_str(), std::strerror(errno));
+                return false;
+            }
+            return true;
+        };
+
+        for (;;) {
+            const size_t read = std::fread(buffer.data(), 1, buffer.size(), input);
+            if (read == 0) {
+                break;
+            }
+            const utf::conversion::status_e status = converter.convert(buffer.data(), read, converted);
+            if (status != utf::conversion::status_e::success) {
+                std::fprintf(stderr, "utfconv: %s: %s\n", args.input.c_str(), describe(status));
+                return 1;
+            }
+            if (!write()) {
+                return 1;
+            }
+        }
+        if (std::ferror(input)) {
+            std::fprintf(stderr, "utfconv: %s: %s\n", args.input.c_str(), std::strerror(errno));
+            return 1;
+        }
+        const utf::conversion::status_e status = converter.finish(converted);
+        if (status != utf::conversion::status_e::success) {
+            std::fprintf(stderr, "utfconv: %s: %s\n", args.input.c_str(), describe(status));
+            return 1;
+        }
+        if (!write() || std::fflush(output) != 0) {
+            std::fprintf(stderr, "utfconv: %s: %s\n", args.output.c_str(), std::strerror(errno));
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    arguments args;
+    if (!parse_arguments(argc, argv, args)) {
+        print_usage(stderr);
+        return 2;
+    }
+    const bool input_is_file  = args.input != "-";
+    const bool output_is_file = args.output != "-";
+
+    // the output is truncated while the input is still being read
+    std::error_code not_found;
+    if (input_is_file && output_is_file && std::filesystem::equivalent(args.input, args.output, not_found)) {
+        std::fprintf(stderr, "utfconv: input and output are the same file\n");
+        return 1;
+    }
+
+    if (input_is_file && output_is_file) {
+        std::error_code                 error;
+        const utf::conversion::status_e status = utf::convert_file(args.input, args.from, args.output, args.to, error, args.options);
+        if (error) {
+            std::fprintf(stderr, "utfconv: %s\n", error.message().c_str());
+            return 1;
+        }
+        if (status != utf::conversion::status_e::success) {
+            std::fprintf(stderr, "utfconv: %s: %s\n", args.input.c_str(), describe(status));
+            return 1;
+        }
+        return 0;
+    }
+
+#if defined(_WIN32)
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    std::FILE* input = input_is_file ? std::fopen(args.input.c_str(), "rb") : stdin;
+    if (input == nullptr) {
+        std::fprintf(stderr, "utfconv: %s: %s\n", args.input.c_str(), std::strerror(errno));
+        return 1;
+    }
+    std::FILE* output = output_is_file ? std::fopen(args.output.c_str(), "wb") : stdout;
+    if (output == nullptr) {
+        std::fprintf(stderr, "utfconv: %s: %s\n", args.output.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    const int exit_code = convert_stream(args, input, output);
+    if (input_is_file) {
+        std::fclose(input);
+    }
+    if (output_is_file && (std::fclose(output) != 0 || exit_code != 0)) {
+        std::remove(args.output.c_str());
+        return 1;
+    }
+    return exit_code;
+}